@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "model/book.h"
+
+namespace bench {
+
+// Синтетические строки таблицы books: часть полей NULL, часть отзывов длинные
+inline std::vector<BookRow> makeBooks(std::size_t count) {
+    std::vector<BookRow> books;
+    books.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        BookRow book;
+        book.id = static_cast<int>(i + 1);
+        book.title = "Book title number " + std::to_string(i);
+        book.author = "Author " + std::to_string(i % 500);
+        if (i % 4 != 0) {
+            book.year = 1900 + static_cast<int>(i % 120);
+        }
+        book.status = (i % 3 == 0) ? "read" : "planned";
+        if (i % 2 == 0) {
+            book.rating = 1 + static_cast<int>(i % 5);
+        }
+        book.review = (i % 5 == 0) ? std::string(120, 'r') : "";
+        book.created_at = "2024-05-17 12:34:56.123456";
+        book.updated_at = "2024-05-18 08:00:00.654321";
+        books.push_back(std::move(book));
+    }
+    return books;
+}
+
+} // namespace bench
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Сравнение двух прогонов bookshelf_bench (JSON Google Benchmark).
+
+Пример:
+    ./bookshelf_bench --benchmark_out=base.json --benchmark_out_format=json
+    ./bookshelf_bench --benchmark_out=new.json --benchmark_out_format=json
+    python3 compare.py base.json new.json --threshold 5
+
+Если прогоны запущены с --benchmark_repetitions, сравниваются медианы.
+Код возврата 1, если хотя бы один бенчмарк замедлился больше порога.
+"""
+
+import argparse
+import json
+import sys
+
+UNIT_TO_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    with open(path, encoding="utf-8") as f:
+        data = json.load(f)
+
+    iterations = {}
+    medians = {}
+    for entry in data.get("benchmarks", []):
+        if entry.get("error_occurred"):
+            continue
+        value = entry[metric] * UNIT_TO_NS[entry.get("time_unit", "ns")]
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[entry["run_name"]] = value
+        else:
+            # Без повторов - одна запись на бенчмарк
+            iterations.setdefault(entry.get("run_name", entry["name"]), value)
+    return medians or iterations
+
+
+def format_ns(value):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if value >= scale:
+            return f"{value / scale:.2f} {unit}"
+    return f"{value:.1f} ns"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="JSON базового прогона")
+    parser.add_argument("contender", help="JSON нового прогона")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="допустимое замедление в процентах (по умолчанию 5)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="cpu_time",
+                        help="какое время сравнивать (по умолчанию cpu_time)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.metric)
+    contender = load(args.contender, args.metric)
+
+    regressions = []
+    width = max((len(name) for name in baseline.keys() | contender.keys()), default=10)
+    print(f"{'benchmark':<{width}}  {'baseline':>12}  {'contender':>12}  {'change':>8}")
+    for name in sorted(baseline.keys() | contender.keys()):
+        if name not in contender:
+            print(f"{name:<{width}}  {format_ns(baseline[name]):>12}  {'-':>12}  {'removed':>8}")
+            continue
+        if name not in baseline:
+            print(f"{name:<{width}}  {'-':>12}  {format_ns(contender[name]):>12}  {'new':>8}")
+            continue
+
+        old, new = baseline[name], contender[name]
+        change = (new - old) / old * 100.0 if old > 0 else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressions.append(name)
+        print(f"{name:<{width}}  {format_ns(old):>12}  {format_ns(new):>12}  {change:+7.1f}%{mark}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than {args.threshold:g}%:", file=sys.stderr)
+        for name in regressions:
+            print(f"  {name}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
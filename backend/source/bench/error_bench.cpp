@@ -0,0 +1,46 @@
+// Тела ответов с ошибкой и сборка строки подключения к БД
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "application_builder.h"
+#include "error_handler.h"
+
+using error_handler::ErrorHandler;
+
+namespace {
+
+void BM_CreateErrorResponse(benchmark::State& state) {
+    const std::string message = "Book not found";
+    const std::string details = "Book with id 123456 does not exist";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ErrorHandler::createErrorResponse(404, "not_found", message, details));
+    }
+}
+BENCHMARK(BM_CreateErrorResponse);
+
+// Сообщение исключения с символами, требующими экранирования
+void BM_CreateErrorResponseEscaped(benchmark::State& state) {
+    const std::string message = "Database query failed";
+    const std::string details = "ERROR:  syntax error at or near \"FROM\"\nLINE 1: SELECT\t* FROM \\books";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ErrorHandler::createErrorResponse(500, "database_error", message, details));
+    }
+}
+BENCHMARK(BM_CreateErrorResponseEscaped);
+
+void BM_ConnectionString(benchmark::State& state) {
+    AppConfig config;
+    config.db_host = "db.internal.example";
+    config.db_port = "5432";
+    config.db_name = "bookshelf";
+    config.db_user = "bookshelf_service";
+    config.db_password = "s3cr3t-passw0rd";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(config.get_connection_string());
+    }
+}
+BENCHMARK(BM_ConnectionString);
+
+} // namespace
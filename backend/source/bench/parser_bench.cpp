@@ -0,0 +1,62 @@
+// Разбор тела POST/PUT в BookInput (SAX, строки в арене запроса)
+// и для сравнения - полный DOM-разбор nlohmann::json::parse
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "memory/request_arena.h"
+#include "serializer/book_input_parser.h"
+
+using serializer::BookInputParser;
+
+namespace {
+
+const std::string kCreateBody =
+    R"({"title":"The Pragmatic Programmer","author":"Andrew Hunt, David Thomas",)"
+    R"("year":1999,"status":"reading","rating":5,)"
+    R"("review":"Practical advice that still holds up. «Don't repeat yourself»."})";
+
+const std::string kUpdateBody = R"({"status":"read","rating":4,"review":null})";
+
+void parseBody(benchmark::State& state, const std::string& body, BookInputParser::Mode mode) {
+    auto& arena = memory::RequestArena::current();
+    for (auto _ : state) {
+        {
+            BookInput input(arena.resource());
+            auto error = BookInputParser::parse(body, mode, input);
+            benchmark::DoNotOptimize(error);
+            benchmark::DoNotOptimize(input.present);
+        }
+        arena.reset();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(body.size()));
+}
+
+void BM_ParseCreate(benchmark::State& state) {
+    parseBody(state, kCreateBody, BookInputParser::Mode::CREATE);
+}
+BENCHMARK(BM_ParseCreate);
+
+void BM_ParseUpdate(benchmark::State& state) {
+    parseBody(state, kUpdateBody, BookInputParser::Mode::UPDATE);
+}
+BENCHMARK(BM_ParseUpdate);
+
+// Ошибка валидации: разбор должен прерываться на первом неверном поле
+void BM_ParseCreateInvalid(benchmark::State& state) {
+    parseBody(state, R"({"title":"T","author":"A","year":"not a number","rating":5})",
+              BookInputParser::Mode::CREATE);
+}
+BENCHMARK(BM_ParseCreateInvalid);
+
+void BM_ParseCreateDom(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nlohmann::json::parse(kCreateBody));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(kCreateBody.size()));
+}
+BENCHMARK(BM_ParseCreateDom);
+
+} // namespace
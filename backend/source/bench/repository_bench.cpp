@@ -0,0 +1,118 @@
+// Чтение и запись во встроенных хранилищах (в памяти и с журналом на диске)
+// и чтение через разделяемый кэш книг
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "repository/cached_book_repository.h"
+#include "repository/log_book_repository.h"
+#include "repository/memory_book_repository.h"
+
+namespace {
+
+constexpr int kBooks = 10000;
+
+BookInput makeInput(int i) {
+    BookInput input;
+    input.present = BookInput::TITLE | BookInput::AUTHOR | BookInput::YEAR | BookInput::RATING;
+    input.title = "Book title number " + std::to_string(i);
+    input.author = "Author " + std::to_string(i % 500);
+    input.year = 1900 + i % 120;
+    input.rating = 1 + i % 5;
+    return input;
+}
+
+void fill(BookRepository& repository) {
+    for (int i = 0; i < kBooks; ++i) {
+        repository.createBook(makeInput(i));
+    }
+}
+
+// Журнал бенчмарка: уникальный файл во временном каталоге, удаляется по
+// завершении. Объявляется до хранилища, чтобы пережить его
+class TempLog {
+public:
+    TempLog() {
+        static int counter = 0;
+        path_ = (std::filesystem::temp_directory_path() /
+                 ("bookshelf_bench_" + std::to_string(::getpid()) + "_" + std::to_string(++counter) + ".log"))
+                    .string();
+        remove();
+    }
+    ~TempLog() { remove(); }
+
+    LogBookRepository::Settings settings(storage::FsyncPolicy fsync) const {
+        LogBookRepository::Settings settings;
+        settings.path = path_;
+        settings.fsync = fsync;
+        return settings;
+    }
+
+    TempLog(const TempLog&) = delete;
+    TempLog& operator=(const TempLog&) = delete;
+
+private:
+    void remove() const {
+        std::remove(path_.c_str());
+        std::remove((path_ + ".compact").c_str());
+    }
+
+    std::string path_;
+};
+
+void getById(benchmark::State& state, BookRepository& repository) {
+    int id = 0;
+    for (auto _ : state) {
+        auto book = repository.getBookById(1 + id++ % kBooks);
+        benchmark::DoNotOptimize(book);
+    }
+}
+
+void BM_MemoryGetById(benchmark::State& state) {
+    InMemoryBookRepository repository;
+    fill(repository);
+    getById(state, repository);
+}
+BENCHMARK(BM_MemoryGetById);
+
+void BM_LogGetById(benchmark::State& state) {
+    TempLog log;
+    LogBookRepository repository(log.settings(storage::FsyncPolicy::NEVER));
+    fill(repository);
+    getById(state, repository);
+}
+BENCHMARK(BM_LogGetById);
+
+// Все книги в кэше: чтение без обращения к хранилищу
+void BM_SharedCacheGetById(benchmark::State& state) {
+    cache::SharedBookCache::Settings settings;
+    settings.shm_name = "/bookshelf_bench_cache";
+    cache::SharedBookCache::unlink(settings.shm_name);
+    auto inner = std::make_shared<InMemoryBookRepository>();
+    CachedBookRepository repository(inner, std::make_shared<cache::SharedBookCache>(settings));
+    fill(repository);
+    for (int id = 1; id <= kBooks; ++id) {
+        repository.getBookById(id);
+    }
+    getById(state, repository);
+    cache::SharedBookCache::unlink(settings.shm_name);
+}
+BENCHMARK(BM_SharedCacheGetById);
+
+void BM_LogCreate(benchmark::State& state, storage::FsyncPolicy fsync) {
+    TempLog log;
+    LogBookRepository repository(log.settings(fsync));
+    const BookInput input = makeInput(1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(repository.createBook(input));
+    }
+}
+BENCHMARK_CAPTURE(BM_LogCreate, fsync_never, storage::FsyncPolicy::NEVER);
+BENCHMARK_CAPTURE(BM_LogCreate, fsync_always, storage::FsyncPolicy::ALWAYS);
+
+} // namespace
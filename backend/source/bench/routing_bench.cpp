@@ -0,0 +1,78 @@
+// Диспетчеризация запроса роутером Crow: поиск правила по URL и методу,
+// разбор параметров пути и вызов обработчика. Таблица маршрутов повторяет
+// BookController и служебные эндпоинты, обработчики пустые - меряется только роутер
+
+#include <iterator>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "bookshelf_app.h"
+
+namespace {
+
+BookshelfApp& routedApp() {
+    static BookshelfApp* app = [] {
+        auto* created = new BookshelfApp();
+        created->loglevel(crow::LogLevel::Warning);
+        auto& app = *created;
+
+        CROW_ROUTE(app, "/health")([] { return crow::response(200); });
+        CROW_ROUTE(app, "/metrics")([] { return crow::response(200); });
+        CROW_ROUTE(app, "/debug/profile")([](const crow::request&) { return crow::response(200); });
+        CROW_ROUTE(app, "/debug/heap")([](const crow::request&) { return crow::response(200); });
+
+        CROW_ROUTE(app, "/api/books").methods("GET"_method)
+        ([](const crow::request&) { return crow::response(200); });
+        CROW_ROUTE(app, "/api/books/<int>").methods("GET"_method)
+        ([](const crow::request&, int id) { return crow::response(id > 0 ? 200 : 404); });
+        CROW_ROUTE(app, "/api/books").methods("POST"_method)
+        ([](const crow::request&) { return crow::response(201); });
+        CROW_ROUTE(app, "/api/books/<int>").methods("PUT"_method)
+        ([](const crow::request&, int id) { return crow::response(id > 0 ? 200 : 404); });
+        CROW_ROUTE(app, "/api/books/<int>").methods("DELETE"_method)
+        ([](int id) { return crow::response(id > 0 ? 204 : 404); });
+        CROW_ROUTE(app, "/api/stats").methods("GET"_method)
+        ([](const crow::request&) { return crow::response(200); });
+
+        app.validate();
+        return created;
+    }();
+    return *app;
+}
+
+struct RouteCase {
+    crow::HTTPMethod method;
+    const char* url;
+};
+
+const RouteCase kCases[] = {
+    {crow::HTTPMethod::Get, "/api/books"},
+    {crow::HTTPMethod::Get, "/api/books/123456"},
+    {crow::HTTPMethod::Post, "/api/books"},
+    {crow::HTTPMethod::Put, "/api/books/42"},
+    {crow::HTTPMethod::Delete, "/api/books/42"},
+    {crow::HTTPMethod::Get, "/api/stats"},
+    {crow::HTTPMethod::Get, "/health"},
+    {crow::HTTPMethod::Get, "/api/unknown/path"},   // 404
+    {crow::HTTPMethod::Patch, "/api/books/42"},     // 405
+};
+
+void BM_RouteDispatch(benchmark::State& state) {
+    auto& app = routedApp();
+    const RouteCase& route = kCases[state.range(0)];
+    state.SetLabel(std::string(crow::method_name(route.method)) + " " + route.url);
+
+    crow::request req;
+    req.method = route.method;
+    req.url = route.url;
+    req.raw_url = route.url;
+    for (auto _ : state) {
+        crow::response res;
+        app.handle_full(req, res);
+        benchmark::DoNotOptimize(res.code);
+    }
+}
+BENCHMARK(BM_RouteDispatch)->ArgName("case")->DenseRange(0, std::size(kCases) - 1);
+
+} // namespace
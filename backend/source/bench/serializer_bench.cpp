@@ -0,0 +1,88 @@
+// Кодирование книг: одна книга (замена прежнего rowToJson) и большие списки
+// в JSON / MessagePack / CBOR, плюс прежний путь через DOM nlohmann::json + dump()
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "bench/bench_data.h"
+#include "serializer/book_serializer.h"
+
+using json = nlohmann::json;
+using serializer::BookSerializer;
+using serializer::ResponseFormat;
+
+namespace {
+
+json bookToDom(const BookRow& book) {
+    json j;
+    j["id"] = book.id;
+    j["title"] = book.title;
+    j["author"] = book.author;
+    j["year"] = book.year ? json(*book.year) : json(nullptr);
+    j["status"] = book.status;
+    j["rating"] = book.rating ? json(*book.rating) : json(nullptr);
+    j["review"] = book.review;
+    j["created_at"] = book.created_at;
+    j["updated_at"] = book.updated_at;
+    return j;
+}
+
+void BM_SerializeBook(benchmark::State& state, ResponseFormat format) {
+    const auto books = bench::makeBooks(1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BookSerializer::serializeBook(books[0], format));
+    }
+}
+BENCHMARK_CAPTURE(BM_SerializeBook, json, ResponseFormat::JSON);
+BENCHMARK_CAPTURE(BM_SerializeBook, msgpack, ResponseFormat::MSGPACK);
+BENCHMARK_CAPTURE(BM_SerializeBook, cbor, ResponseFormat::CBOR);
+
+void BM_SerializeBookDom(benchmark::State& state) {
+    const auto books = bench::makeBooks(1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bookToDom(books[0]).dump());
+    }
+}
+BENCHMARK(BM_SerializeBookDom);
+
+void BM_SerializeBooks(benchmark::State& state, ResponseFormat format) {
+    const auto books = bench::makeBooks(static_cast<std::size_t>(state.range(0)));
+    std::size_t bytes = 0;
+    for (auto _ : state) {
+        std::string out = BookSerializer::serializeBooks(books, format);
+        bytes = out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(bytes));
+}
+BENCHMARK_CAPTURE(BM_SerializeBooks, json, ResponseFormat::JSON)->ArgName("books")->Arg(100)->Arg(10000);
+BENCHMARK_CAPTURE(BM_SerializeBooks, msgpack, ResponseFormat::MSGPACK)->ArgName("books")->Arg(100)->Arg(10000);
+BENCHMARK_CAPTURE(BM_SerializeBooks, cbor, ResponseFormat::CBOR)->ArgName("books")->Arg(100)->Arg(10000);
+
+void BM_DumpBooksDom(benchmark::State& state) {
+    const auto books = bench::makeBooks(static_cast<std::size_t>(state.range(0)));
+    std::size_t bytes = 0;
+    for (auto _ : state) {
+        json list = json::array();
+        for (const auto& book : books) {
+            list.push_back(bookToDom(book));
+        }
+        std::string out = list.dump();
+        bytes = out.size();
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(bytes));
+}
+BENCHMARK(BM_DumpBooksDom)->ArgName("books")->Arg(100)->Arg(10000);
+
+void BM_NegotiateFormat(benchmark::State& state) {
+    const std::string accept = "text/html, application/cbor;q=0.8, application/msgpack;q=0.9, */*;q=0.1";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BookSerializer::negotiateFormat(accept));
+    }
+}
+BENCHMARK(BM_NegotiateFormat);
+
+} // namespace
@@ -1,14 +1,129 @@
 #include <nlohmann/json.hpp>
 #include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_set>
 
 #include "application_builder.h"
 #include "controller/book_controller.h"    
+#include "controller/change_feed_controller.h"
+#include "controller/shelf_socket_controller.h"
 #include "service/book_service.h"          
+#include "repository/postgres_book_repository.h"
+#include "repository/memory_book_repository.h"
+#include "repository/log_book_repository.h"
+#include "repository/cached_book_repository.h"
+#include "repository/notifying_book_repository.h"
+#include "cache/shared_book_cache.h"
+#include "cache/cache_snapshot.h"
+#include "feed/change_feed.h"
+#include "feed/pg_listener.h"
+#include "feed/shelf_hub.h"
+#include "logger/logger.h"
+#include "db/connection_pool.h"
+#include "db/query_log.h"
+#include "capture/traffic_capture.h"
+#include "server/readiness.h"
+#include "server/server_tuning.h"
+#include "server/worker_group.h"
+#include "debug/admin_guard.h"
+#include "debug/cpu_profiler.h"
+#include "debug/heap_profiler.h"
+#include "error_handler.h"
+#include "metrics/metrics.h"
 
 using json = nlohmann::json;
 // using json = nlohmann::json_abi_v3_11_2::json;
 
+namespace {
+
+// Сколько id проверяется одним запросом при поиске удаленных книг
+constexpr std::size_t kExistenceBatch = 10000;
+
+// Загрузка снимка в пустой кэш и догоняющее чтение книг, измененных после него.
+// window_s: книги снимка заполнены не раньше его времени минус ttl кэша, плюс запас
+void restoreCacheSnapshot(const std::string& path, unsigned window_s, PostgresBookRepository& database,
+                          CachedBookRepository& cached, cache::SharedBookCache& shared) {
+    cache::SnapshotReader snapshot(path);
+    if (!snapshot.valid()) {
+        LOG_INFO("No usable cache snapshot", {{"path", path}});
+        return;
+    }
+    const auto current = database.generation();
+    if (snapshot.info().generation != current.marker) {
+        LOG_WARN("Cache snapshot belongs to another database, ignored", {
+            {"path", path},
+            {"snapshot_generation", snapshot.info().generation},
+            {"database_generation", current.marker}
+        });
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::unordered_set<int> loaded;
+    loaded.reserve(snapshot.info().books);
+    snapshot.forEach([&](const BookRow& book) {
+        shared.fill(shared.fillTicket(book.id), book);
+        loaded.insert(book.id);
+    });
+
+    // Запрос идет после заполнения: он видит и изменения, прошедшие через сервис во время загрузки
+    std::size_t refreshed = 0;
+    for (int id : database.changedSince(snapshot.info().db_time, window_s)) {
+        if (loaded.count(id) != 0) {
+            shared.invalidate(id);
+            cached.getBookById(id);
+            ++refreshed;
+        }
+    }
+
+    // Удаление не оставляет updated_at: проверяем, какие книги снимка еще есть в базе
+    std::size_t removed = 0;
+    std::vector<int> batch;
+    batch.reserve(std::min(loaded.size(), kExistenceBatch));
+    auto checkBatch = [&] {
+        const auto existing = database.existingIds(batch);
+        const std::unordered_set<int> present(existing.begin(), existing.end());
+        for (int id : batch) {
+            if (present.count(id) == 0) {
+                shared.invalidate(id);
+                ++removed;
+            }
+        }
+        batch.clear();
+    };
+    for (int id : loaded) {
+        batch.push_back(id);
+        if (batch.size() == kExistenceBatch) {
+            checkBatch();
+        }
+    }
+    if (!batch.empty()) {
+        checkBatch();
+    }
+
+    LOG_INFO("Cache snapshot restored", {
+        {"path", path},
+        {"books", loaded.size()},
+        {"refreshed", refreshed},
+        {"removed", removed},
+        {"snapshot_db_time", snapshot.info().db_time},
+        {"duration_ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()}
+    });
+}
+
+// Метрика, снимаемая с объекта при каждом запросе /metrics. Ссылка слабая:
+// после остановки объекта значение - ноль
+template <typename T, typename Getter>
+auto sampleOf(std::weak_ptr<T> weak, Getter getter) {
+    return [weak = std::move(weak), getter]() -> double {
+        auto locked = weak.lock();
+        return locked ? static_cast<double>(getter(*locked)) : 0.0;
+    };
+}
+
+} // namespace
+
 ApplicationBuilder::ApplicationBuilder() {
      // Получаем абсолютный путь к config.json относительно исполняемого файла
     std::filesystem::path exe_path = std::filesystem::current_path();
@@ -30,54 +145,232 @@ AppComponents ApplicationBuilder::buildApplication(bool init_database) {
     // 1. Загрузка конфигурации
     if (custom_config_.has_value()) {
         config_ = custom_config_.value();
-        std::cout << "Prepare: Using custom configuration." << std::endl;
+        LOG_INFO("Prepare: Using custom configuration");
     } else {
-        std::cout << "Prepare: Loading configuration from: " << config_path_ << std::endl;
+        LOG_INFO("Prepare: Loading configuration", {{"path", config_path_}});
         config_ = loadConfigFromFile(config_path_);
     }
 
+    logger::Logger::instance().setLevel(logger::levelFromString(config_.log_level));
+    logger::Logger::instance().setRateLimit(config_.log_rate_limit);
+    metrics::setSqlTimingDetail(config_.server_timing_sql_detail);
+
+    if (config_.heap_profile_enabled) {
+        debug::HeapProfiler::enable(config_.heap_profile_sample_interval);
+        LOG_INFO("Heap profiling enabled", {{"sample_interval_bytes", config_.heap_profile_sample_interval}});
+    }
+
+    server::ServerTuning::Settings server_settings;
+    server_settings.workers = config_.server_workers;
+    server_settings.pin_cpus = config_.server_pin_cpus;
+    server_settings.tcp_nodelay = config_.server_tcp_nodelay;
+    server_settings.backlog = config_.server_backlog;
+    server_settings.keepalive_timeout_s = config_.server_keepalive_timeout_s;
+    server_settings.max_body_bytes = config_.server_max_body_bytes;
+    server_settings.listen_tcp = config_.server_listen_tcp;
+    server_settings.unix_socket_path = config_.server_unix_socket_path;
+    server_settings.unix_socket_mode = static_cast<unsigned>(
+        std::strtoul(config_.server_unix_socket_mode.c_str(), nullptr, 8));
+    server_settings.unix_socket_remove_stale = config_.server_unix_socket_remove_stale;
+    server_settings.unix_socket_backlog = config_.server_unix_socket_backlog;
+    server::ServerTuning::instance().configure(std::move(server_settings));
+
+    capture::TrafficCapture::Settings capture_settings;
+    capture_settings.enabled = config_.capture_enabled;
+    // В режиме --workers N у каждого обработчика свой файл: capture.bin.0, capture.bin.1...
+    capture_settings.path = server::ServerTuning::instance().processPath(config_.capture_path);
+    capture_settings.sample_rate = config_.capture_sample_rate;
+    capture_settings.max_body_bytes = config_.capture_max_body_bytes;
+    capture::TrafficCapture::instance().configure(std::move(capture_settings));
+
+    const bool in_memory = config_.storage_backend == "memory";
+    const bool embedded = config_.storage_backend == "log";
+    if (!in_memory && !embedded && config_.storage_backend != "postgres") {
+        throw std::runtime_error("Unknown storage backend: " + config_.storage_backend);
+    }
+
+    // У каждого процесса свое хранилище в памяти или журнал: общий кэш смешал бы их данные
+    if (config_.cache_enabled && (in_memory || embedded)) {
+        LOG_WARN("Shared book cache is used only with PostgreSQL storage",
+                 {{"backend", config_.storage_backend}});
+    }
+
     // 2. Инициализация БД (если требуется)
-    if (init_database) {
-        std::cout << "Database initialization requested..." << std::endl;
+    if (init_database && (in_memory || embedded)) {
+        LOG_WARN("Database initialization skipped: storage is not PostgreSQL",
+                 {{"backend", config_.storage_backend}});
+    } else if (init_database) {
+        LOG_INFO("Database initialization requested");
         if (initializeDatabase(config_)) {
-            std::cout << "Database initialized successfully!" << std::endl;
+            LOG_INFO("Database initialized successfully");
         } else {
             throw std::runtime_error("Database initialization failed.");
         }
     }
 
-    // 3. Создание экземпляра приложения Crow
-    auto app = std::make_unique<crow::SimpleApp>();
+    // 3. Создание экземпляров приложения Crow: один слушает TCP, другой Unix-сокет
+    if (!config_.server_listen_tcp && config_.server_unix_socket_path.empty()) {
+        throw std::runtime_error("No listeners: enable server.listen_tcp or set server.unix_socket.path");
+    }
+    auto app = config_.server_listen_tcp ? createApp() : nullptr;
+    auto local_app = config_.server_unix_socket_path.empty() ? nullptr : createApp();
+
+    // Лента изменений: общая для всех подписчиков процесса
+    std::shared_ptr<feed::ChangeFeed> change_feed;
+    std::shared_ptr<feed::PgListener> change_listener;
+    if (config_.feed_enabled) {
+        feed::ChangeFeed::Settings feed_settings;
+        feed_settings.history = config_.feed_history;
+        feed_settings.coalesce = std::chrono::milliseconds(config_.feed_coalesce_ms);
+        feed_settings.hold = std::chrono::seconds(std::max(config_.feed_hold_s, 1u));
+        feed_settings.max_batch = config_.feed_max_batch;
+        feed_settings.max_subscribers = config_.feed_max_subscribers;
+        feed_settings.retry = std::chrono::milliseconds(config_.feed_retry_ms);
+        change_feed = std::make_shared<feed::ChangeFeed>(std::move(feed_settings));
+        registerFeedMetrics(change_feed);
+    }
 
-    // 4. Установка соединения с БД (уже к инициализированной базе)
-    auto connection = establishDbConnection(config_);
-    if (!connection) {
-        throw std::runtime_error("Failed to establish database connection during application build.");
+    // 4. Хранилище книг
+    std::shared_ptr<db::ConnectionPool> db_pool;
+    std::shared_ptr<BookRepository> repository;
+    if (in_memory) {
+        LOG_WARN("Using in-memory storage: data is not persisted");
+        repository = std::make_shared<InMemoryBookRepository>();
+    } else if (embedded) {
+        LogBookRepository::Settings log_settings;
+        log_settings.path = config_.storage_log_path;
+        log_settings.fsync = storage::fsyncPolicyFromString(config_.storage_log_fsync);
+        log_settings.fsync_interval = std::chrono::milliseconds(config_.storage_log_fsync_interval_ms);
+        log_settings.compact_interval = std::chrono::seconds(config_.storage_log_compact_interval_s);
+        log_settings.compact_min_bytes = config_.storage_log_compact_min_bytes;
+        LOG_INFO("Using embedded storage", {
+            {"path", log_settings.path},
+            {"fsync", config_.storage_log_fsync}
+        });
+        repository = std::make_shared<LogBookRepository>(std::move(log_settings));
+    } else {
+        db::QueryLog::Settings slow_query;
+        slow_query.threshold = std::chrono::milliseconds(config_.slow_query_threshold_ms);
+        slow_query.explain = config_.slow_query_explain;
+        slow_query.explain_first_n = config_.slow_query_explain_first_n;
+        slow_query.connection_string = config_.get_connection_string();
+        db::QueryLog::instance().configure(std::move(slow_query));
+
+        // Каждое новое соединение пула сразу готовит операторы хранилища
+        db_pool = std::make_shared<db::ConnectionPool>(
+            config_.get_connection_string(),
+            config_.db_pool_size,
+            std::chrono::milliseconds(config_.db_acquire_timeout_ms),
+            &PostgresBookRepository::prepareStatements
+        );
+
+        // Первое соединение (уже к инициализированной базе) открывается сразу и остается
+        // в пуле; остальные до min_connections - при прогреве, до готовности к трафику
+        try {
+            db_pool->warmUp(1);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(std::string("Failed to establish database connection during application build: ") + e.what());
+        }
+        server::Readiness::instance().addStep("db_pool", [pool = db_pool, count = config_.db_min_connections] {
+            pool->warmUp(count);
+        });
+        registerPoolMetrics(db_pool);
+        repository = withCache(std::make_shared<PostgresBookRepository>(db_pool, config_.search_language));
+
+        if (change_feed) {
+            // Изменения приходят от триггера: их видят все процессы, в том числе чужие записи в базу
+            change_listener = std::make_shared<feed::PgListener>(config_.get_connection_string(), change_feed);
+            server::Readiness::instance().addStep("change_feed", [pool = db_pool, listener = change_listener] {
+                try {
+                    auto connection = pool->acquire();
+                    feed::PgListener::installTrigger(*connection);
+                } catch (const std::exception& e) {
+                    LOG_WARN("Change feed trigger not installed, feed gets only external notifications",
+                             {{"error", e.what()}});
+                }
+                listener->start();
+            });
+        }
+    }
+    // Память и журнал - свои у каждого процесса: об изменениях сообщает само хранилище
+    if (change_feed && (in_memory || embedded)) {
+        repository = std::make_shared<NotifyingBookRepository>(repository, change_feed);
     }
 
-    auto book_service = std::make_shared<BookService>(config_);
+    auto book_service = std::make_shared<BookService>(repository);
     auto controller = std::make_shared<BookController>(book_service);
+    auto feed_controller = change_feed ? std::make_shared<ChangeFeedController>(change_feed) : nullptr;
+
+    std::shared_ptr<feed::ShelfHub> shelf_hub;
+    std::shared_ptr<ShelfSocketController> socket_controller;
+    if (config_.websocket_enabled && !change_feed) {
+        LOG_WARN("WebSocket subscriptions need the change feed: set feed.enabled to use them");
+    } else if (config_.websocket_enabled) {
+        feed::ShelfHub::Settings hub_settings;
+        hub_settings.tick = std::chrono::milliseconds(std::max(config_.websocket_tick_ms, 1u));
+        hub_settings.max_connections = config_.websocket_max_connections;
+        hub_settings.max_subscriptions = config_.websocket_max_subscriptions;
+        shelf_hub = std::make_shared<feed::ShelfHub>(std::move(hub_settings), book_service);
+        change_feed->addListener([weak = std::weak_ptr<feed::ShelfHub>(shelf_hub)](
+                                     const std::vector<feed::ChangeFeed::Change>& changes, bool reset) {
+            if (auto hub = weak.lock()) {
+                hub->onChanges(changes, reset);
+            }
+        });
+        socket_controller = std::make_shared<ShelfSocketController>(shelf_hub, config_.websocket_max_message_bytes);
+        registerShelfHubMetrics(shelf_hub);
+    }
 
-    controller->setupRoutes(*app);
     // 5. Регистрация всех маршрутов
-    registerRoutes(*app);
+    for (BookshelfApp* target : {app.get(), local_app.get()}) {
+        if (target != nullptr) {
+            controller->setupRoutes(*target);
+            if (feed_controller) {
+                feed_controller->setupRoutes(*target);
+            }
+            if (socket_controller) {
+                socket_controller->setupRoutes(*target);
+            }
+            registerRoutes(*target);
+        }
+    }
+
+    auto& registry = metrics::Registry::instance();
+    registry.addSample("bookshelf_ready", "1 when warm-up has finished and the process accepts traffic.",
+                       metrics::Registry::SampleType::GAUGE,
+                       [] { return server::Readiness::instance().ready() ? 1.0 : 0.0; });
+    registry.addSample("bookshelf_warmup_seconds", "Duration of the startup warm-up.",
+                       metrics::Registry::SampleType::GAUGE,
+                       [] { return server::Readiness::instance().warmUpSeconds(); });
+
+    // Prefork: снимок метрик процесса для /metrics соседних обработчиков
+    server::WorkerGroup::instance().startPublishing(
+        [] { return metrics::Registry::instance().renderPrometheus(); },
+        std::chrono::seconds(1));
+
+    LOG_INFO("Application built successfully", {{"port", config_.server_port}});
+    return {std::move(app), std::move(local_app), controller, db_pool,
+            std::move(change_feed), std::move(change_listener), std::move(shelf_hub), std::move(cache_snapshot_)};
+}
 
-    std::cout << "Application built successfully. Server will run on port " << config_.server_port << "." << std::endl;
-    return {std::move(app), controller};
+std::unique_ptr<BookshelfApp> ApplicationBuilder::createApp() const {
+    auto app = std::make_unique<BookshelfApp>();
+    server::ServerTuning::instance().applyTo(*app);
+    return app;
 }
 
 bool ApplicationBuilder::initializeDatabase(const AppConfig& config) const {
     try {
-        std::cout << "Step 1: Connecting to PostgreSQL server..." << std::endl;
+        LOG_INFO("Step 1: Connecting to PostgreSQL server");
         
         // Подключаемся к стандартной БД postgres для создания новой БД
         auto connection = establishDbConnection(config, "postgres");
         if (!connection || !connection->is_open()) {
-            std::cerr << "Can't connect to PostgreSQL server" << std::endl;
+            LOG_ERROR("Can't connect to PostgreSQL server");
             return false;
         }
 
-        std::cout << "Connected to PostgreSQL server successfully!" << std::endl;
+        LOG_INFO("Connected to PostgreSQL server successfully");
         
         // Проверяем, существует ли уже база данных bookshelf
         bool db_exists = false;
@@ -94,34 +387,34 @@ bool ApplicationBuilder::initializeDatabase(const AppConfig& config) const {
         }
 
         if (!db_exists) {
-            std::cout << "Step 2: Creating database '" << config.db_name << "'..." << std::endl;
+            LOG_INFO("Step 2: Creating database", {{"dbname", config.db_name}});
             connection->prepare("create_db", "CREATE DATABASE bookshelf");
             pqxx::nontransaction ntx(*connection);
             ntx.exec("CREATE DATABASE bookshelf");
             // pqxx::work create_txn(*connection);
             // create_txn.exec_params("CREATE DATABASE " + config.db_name);
             // create_txn.commit();
-            std::cout << "Database '" << config.db_name << "' created successfully!" << std::endl;
+            LOG_INFO("Database created successfully", {{"dbname", config.db_name}});
         } else {
-            std::cout << "Database '" << config.db_name << "' already exists." << std::endl;
+            LOG_INFO("Database already exists", {{"dbname", config.db_name}});
         }
 
         connection->disconnect();
 
         // Теперь подключаемся к созданной/существующей базе данных для создания таблиц
-        std::cout << "Step 3: Connecting to database '" << config.db_name << "'..." << std::endl;
+        LOG_INFO("Step 3: Connecting to database", {{"dbname", config.db_name}});
         auto connection_to_bookshelf = establishDbConnection(config);
         if (!connection_to_bookshelf || !connection_to_bookshelf->is_open()) {
-            std::cerr << "Can't connect to database '" << config.db_name << "'" << std::endl;
+            LOG_ERROR("Can't connect to database", {{"dbname", config.db_name}});
             return false;
         }
 
-        std::cout << "Step 4: Creating tables..." << std::endl;
+        LOG_INFO("Step 4: Creating tables");
         pqxx::work txn_bookshelf(*connection_to_bookshelf);
         
          // SQL для создания таблицы books
         const char* create_table_sql = R"(
-            CREATE TABLE books (
+            CREATE TABLE IF NOT EXISTS books (
                 id SERIAL PRIMARY KEY,
                 title VARCHAR(255) NOT NULL,
                 author VARCHAR(255) NOT NULL,
@@ -139,14 +432,26 @@ bool ApplicationBuilder::initializeDatabase(const AppConfig& config) const {
         // Создаем индексы (IF NOT EXISTS для идемпотентности)
         txn_bookshelf.exec("CREATE INDEX IF NOT EXISTS idx_books_author ON books(author)");
         txn_bookshelf.exec("CREATE INDEX IF NOT EXISTS idx_books_title ON books(title)");
+
+        // Документ для полнотекстового поиска: вес A - название, B - автор, C - отзыв.
+        // Добавление столбца к заполненной таблице переписывает ее целиком
+        const std::string language = txn_bookshelf.quote(config.search_language);
+        const auto weighted = [&language](const char* column, char weight) {
+            return std::string("setweight(to_tsvector(") + language + "::regconfig, coalesce(" + column +
+                   ", '')), '" + weight + "')";
+        };
+        txn_bookshelf.exec("ALTER TABLE books ADD COLUMN IF NOT EXISTS search tsvector GENERATED ALWAYS AS (" +
+                           weighted("title", 'A') + " || " + weighted("author", 'B') + " || " +
+                           weighted("review", 'C') + ") STORED");
+        txn_bookshelf.exec("CREATE INDEX IF NOT EXISTS idx_books_search ON books USING GIN (search)");
         
         txn_bookshelf.commit();
-        std::cout << "Table 'books' created/verified successfully!" << std::endl;
+        LOG_INFO("Table 'books' created/verified successfully");
         
         return true;
         
     } catch (const std::exception &e) {
-        std::cerr << "Database initialization error: " << e.what() << std::endl;
+        LOG_ERROR("Database initialization error", {{"error", e.what()}});
         return false;
     }
 }
@@ -172,11 +477,93 @@ AppConfig ApplicationBuilder::loadConfigFromFile(const std::string& config_path)
     config.db_user = db_cfg.value("user", "postgres");
     config.db_password = db_cfg.value("password", "");
     config.server_port = config_json.value("server_port", 8080);
+    config.db_pool_size = db_cfg.value("pool_size", 8u);
+    config.db_min_connections = db_cfg.value("min_connections", 4u);
+    config.db_acquire_timeout_ms = db_cfg.value("acquire_timeout_ms", 1000u);
+
+    const auto server_cfg = config_json.value("server", json::object());
+    config.server_workers = server_cfg.value("workers", 0u);
+    config.server_pin_cpus = server_cfg.value("pin_cpus", std::vector<int>{});
+    config.server_tcp_nodelay = server_cfg.value("tcp_nodelay", true);
+    config.server_backlog = server_cfg.value("backlog", 0);
+    config.server_keepalive_timeout_s = server_cfg.value("keepalive_timeout_s", 5u);
+    config.server_max_body_bytes = server_cfg.value("max_body_bytes", 1024u * 1024u);
+    config.server_listen_tcp = server_cfg.value("listen_tcp", true);
+    const auto unix_cfg = server_cfg.value("unix_socket", json::object());
+    config.server_unix_socket_path = unix_cfg.value("path", "");
+    config.server_unix_socket_mode = unix_cfg.value("mode", "0660");
+    config.server_unix_socket_remove_stale = unix_cfg.value("remove_stale", true);
+    config.server_unix_socket_backlog = unix_cfg.value("backlog", 0);
+
+    const auto storage_cfg = config_json.value("storage", json::object());
+    config.storage_backend = storage_cfg.value("backend", "postgres");
+    const auto log_cfg = storage_cfg.value("log", json::object());
+    config.storage_log_path = log_cfg.value("path", "bookshelf.log");
+    config.storage_log_fsync = log_cfg.value("fsync", "interval");
+    config.storage_log_fsync_interval_ms = log_cfg.value("fsync_interval_ms", 100u);
+    config.storage_log_compact_interval_s = log_cfg.value("compact_interval_s", 60u);
+    config.storage_log_compact_min_bytes = log_cfg.value("compact_min_bytes", 4u * 1024u * 1024u);
+
+    const auto cache_cfg = config_json.value("cache", json::object());
+    config.cache_enabled = cache_cfg.value("enabled", false);
+    config.cache_shm_name = cache_cfg.value("shm_name", "/bookshelf_books");
+    config.cache_entries = cache_cfg.value("entries", 16384u);
+    config.cache_entry_bytes = cache_cfg.value("entry_bytes", 1024u);
+    config.cache_ttl_s = cache_cfg.value("ttl_s", 30u);
+    config.cache_preload = cache_cfg.value("preload", 0u);
+    const auto snapshot_cfg = cache_cfg.value("snapshot", json::object());
+    config.cache_snapshot_path = snapshot_cfg.value("path", "");
+    config.cache_snapshot_interval_s = snapshot_cfg.value("interval_s", 300u);
+    config.cache_snapshot_catchup_margin_s = snapshot_cfg.value("catchup_margin_s", 60u);
+
+    const auto feed_cfg = config_json.value("feed", json::object());
+    config.feed_enabled = feed_cfg.value("enabled", true);
+    config.feed_history = feed_cfg.value("history", 4096u);
+    config.feed_coalesce_ms = feed_cfg.value("coalesce_ms", 100u);
+    config.feed_hold_s = feed_cfg.value("hold_s", 25u);
+    config.feed_max_batch = feed_cfg.value("max_batch", 256u);
+    config.feed_max_subscribers = feed_cfg.value("max_subscribers", 10000u);
+    config.feed_retry_ms = feed_cfg.value("retry_ms", 1000u);
+
+    const auto websocket_cfg = config_json.value("websocket", json::object());
+    config.websocket_enabled = websocket_cfg.value("enabled", true);
+    config.websocket_tick_ms = websocket_cfg.value("tick_ms", 50u);
+    config.websocket_max_connections = websocket_cfg.value("max_connections", 10000u);
+    config.websocket_max_subscriptions = websocket_cfg.value("max_subscriptions", 1000u);
+    config.websocket_max_message_bytes = websocket_cfg.value("max_message_bytes", 16u * 1024u);
+
+    const auto search_cfg = config_json.value("search", json::object());
+    config.search_language = search_cfg.value("language", "simple");
+
+    const auto logging_cfg = config_json.value("logging", json::object());
+    config.log_level = logging_cfg.value("level", "info");
+    config.log_rate_limit = logging_cfg.value("rate_limit_per_second", 100u);
+
+    const auto timing_cfg = config_json.value("server_timing", json::object());
+    config.server_timing_sql_detail = timing_cfg.value("sql_detail", false);
+
+    const auto slow_query_cfg = config_json.value("slow_query", json::object());
+    config.slow_query_threshold_ms = slow_query_cfg.value("threshold_ms", 100u);
+    config.slow_query_explain = slow_query_cfg.value("explain", false);
+    config.slow_query_explain_first_n = slow_query_cfg.value("explain_first_n", 3u);
+
+    const auto admin_cfg = config_json.value("admin", json::object());
+    config.admin_token = admin_cfg.value("token", "");
+
+    const auto heap_cfg = config_json.value("heap_profile", json::object());
+    config.heap_profile_enabled = heap_cfg.value("enabled", false);
+    config.heap_profile_sample_interval = heap_cfg.value("sample_interval_bytes", 512u * 1024u);
+
+    const auto capture_cfg = config_json.value("capture", json::object());
+    config.capture_enabled = capture_cfg.value("enabled", false);
+    config.capture_path = capture_cfg.value("path", "capture.bin");
+    config.capture_sample_rate = capture_cfg.value("sample_rate", 0.01);
+    config.capture_max_body_bytes = capture_cfg.value("max_body_bytes", 64u * 1024u);
 
     // Для отладки
     // std::cout << "DEBUG: Connection string: " << config.get_connection_string() << std::endl;
 
-    std::cerr << "Loading configuration successfully!" << std::endl;
+    LOG_INFO("Loading configuration successfully");
 
     return config;
 }
@@ -191,20 +578,20 @@ std::shared_ptr<pqxx::connection> ApplicationBuilder::establishDbConnection(cons
         auto connection = std::make_shared<pqxx::connection>(conn_string);
         if (connection->is_open()) {
             // Для отладки
-            std::cout << "DEBUG: Successfully connected to database: " << dbname << std::endl;
+            LOG_DEBUG("Successfully connected to database", {{"dbname", dbname}});
 
             return connection;
         } else {
-            std::cerr << "Database connection is closed." << std::endl;
+            LOG_ERROR("Database connection is closed");
             return nullptr;
         }
     } catch (const std::exception& e) {
-        std::cerr << "Database connection failed: " << e.what() << std::endl;
+        LOG_ERROR("Database connection failed", {{"error", e.what()}});
         return nullptr;
     }
 }
 
-void ApplicationBuilder::registerRoutes(crow::SimpleApp& app) const {
+void ApplicationBuilder::registerRoutes(BookshelfApp& app) const {
     // Создаем фабрику соединений
     // auto connection_factory = [config = config_]() {
     //     return std::make_unique<pqxx::connection>(config.get_connection_string());
@@ -216,8 +603,219 @@ void ApplicationBuilder::registerRoutes(crow::SimpleApp& app) const {
     
     // Можно добавить health-check endpoint
     CROW_ROUTE(app, "/health")([](){
+        metrics::setRoute(metrics::RouteId::HEALTH);
         return crow::response(200, "OK");
     });
+
+    // Готовность к трафику: 503, пока идет прогрев (пул соединений, кэш)
+    CROW_ROUTE(app, "/ready")([](){
+        metrics::setRoute(metrics::RouteId::READY);
+        auto& readiness = server::Readiness::instance();
+        if (readiness.ready()) {
+            return crow::response(200, "READY");
+        }
+        crow::response resp(503, "WARMING UP " + readiness.pendingStep());
+        resp.set_header("Retry-After", "1");
+        return resp;
+    });
+
+    // Метрики в формате Prometheus; в prefork-режиме - сумма по всем обработчикам
+    CROW_ROUTE(app, "/metrics")([](){
+        metrics::setRoute(metrics::RouteId::METRICS);
+        crow::response resp(200, server::WorkerGroup::instance().aggregate(
+            metrics::Registry::instance().renderPrometheus()));
+        resp.set_header("Content-Type", "text/plain; version=0.0.4");
+        return resp;
+    });
+
+    registerDebugRoutes(app);
+}
+
+void ApplicationBuilder::registerDebugRoutes(BookshelfApp& app) const {
+    const std::string admin_token = config_.admin_token;
+
+    // GET /debug/profile?seconds=N&hz=F - профиль CPU в формате folded stacks
+    CROW_ROUTE(app, "/debug/profile")([admin_token](const crow::request& req) {
+        metrics::setRoute(metrics::RouteId::DEBUG);
+        if (auto denied = debug::checkAdminAccess(req, admin_token)) {
+            return std::move(*denied);
+        }
+
+        const char* seconds_param = req.url_params.get("seconds");
+        const char* hz_param = req.url_params.get("hz");
+        const int seconds = seconds_param != nullptr ? std::atoi(seconds_param) : 10;
+        const int hz = hz_param != nullptr ? std::atoi(hz_param) : 99;
+
+        auto profile = debug::CpuProfiler::instance().profile(std::chrono::seconds(seconds), hz);
+        if (!profile) {
+            return error_handler::ErrorHandler::conflict("Profiling already in progress");
+        }
+
+        crow::response resp(200, std::move(*profile));
+        resp.set_header("Content-Type", "text/plain; charset=utf-8");
+        return resp;
+    });
+
+    // GET /debug/heap?top=N - живые байты по местам выделения и выделения по маршрутам
+    CROW_ROUTE(app, "/debug/heap")([admin_token](const crow::request& req) {
+        metrics::setRoute(metrics::RouteId::DEBUG);
+        if (auto denied = debug::checkAdminAccess(req, admin_token)) {
+            return std::move(*denied);
+        }
+
+        const char* top_param = req.url_params.get("top");
+        const int top = top_param != nullptr ? std::atoi(top_param) : 50;
+
+        crow::response resp(200, debug::HeapProfiler::reportJson(
+            metrics::Registry::instance().routeAllocations(),
+            static_cast<std::size_t>(std::max(top, 1))
+        ));
+        resp.set_header("Content-Type", "application/json");
+        return resp;
+    });
+}
+
+void ApplicationBuilder::registerPoolMetrics(const std::shared_ptr<db::ConnectionPool>& pool) const {
+    using metrics::Registry;
+    auto& registry = Registry::instance();
+    std::weak_ptr<db::ConnectionPool> weak = pool;
+
+    registry.addSample("bookshelf_db_pool_size", "Maximum number of database connections.",
+                       Registry::SampleType::GAUGE,
+                       sampleOf(weak, [](const db::ConnectionPool& p) { return p.size(); }));
+    registry.addSample("bookshelf_db_pool_open", "Database connections currently open.",
+                       Registry::SampleType::GAUGE,
+                       sampleOf(weak, [](const db::ConnectionPool& p) { return p.opened(); }));
+    registry.addSample("bookshelf_db_pool_in_use", "Database connections currently leased.",
+                       Registry::SampleType::GAUGE,
+                       sampleOf(weak, [](const db::ConnectionPool& p) { return p.inUse(); }));
+    registry.addSample("bookshelf_db_pool_waiting", "Requests waiting for a database connection.",
+                       Registry::SampleType::GAUGE,
+                       sampleOf(weak, [](const db::ConnectionPool& p) { return p.waiting(); }));
+    registry.addSample("bookshelf_db_pool_acquire_wait_seconds_total",
+                       "Total time spent waiting for a database connection.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const db::ConnectionPool& p) { return p.acquireWaitNs() / 1e9; }));
+    registry.addSample("bookshelf_db_pool_acquire_timeouts_total",
+                       "Connection requests that timed out.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const db::ConnectionPool& p) { return p.acquireTimeouts(); }));
+}
+
+std::shared_ptr<BookRepository> ApplicationBuilder::withCache(std::shared_ptr<PostgresBookRepository> repository) {
+    if (!config_.cache_enabled) {
+        return repository;
+    }
+
+    cache::SharedBookCache::Settings settings;
+    settings.shm_name = config_.cache_shm_name;
+    settings.entries = config_.cache_entries;
+    settings.entry_bytes = config_.cache_entry_bytes;
+    settings.ttl = std::chrono::seconds(config_.cache_ttl_s);
+
+    // Кэш - ускорение, а не условие работы: без него сервис продолжает работать
+    try {
+        auto shared_cache = std::make_shared<cache::SharedBookCache>(std::move(settings));
+        LOG_INFO("Shared book cache attached", {
+            {"shm_name", config_.cache_shm_name},
+            {"entries", shared_cache->capacity()},
+            {"ttl_s", config_.cache_ttl_s}
+        });
+        registerCacheMetrics(shared_cache);
+        auto cached = std::make_shared<CachedBookRepository>(repository, shared_cache);
+        if (!config_.cache_snapshot_path.empty()) {
+            // Пишет снимки один процесс: единственный или первый обработчик prefork
+            if (server::WorkerGroup::instance().index() <= 0) {
+                cache::SnapshotWriter::Settings snapshot_settings;
+                snapshot_settings.path = config_.cache_snapshot_path;
+                snapshot_settings.interval = std::chrono::seconds(std::max(config_.cache_snapshot_interval_s, 1u));
+                cache_snapshot_ = std::make_shared<cache::SnapshotWriter>(
+                    std::move(snapshot_settings), shared_cache, [repository] {
+                        auto generation = repository->generation();
+                        return cache::SnapshotWriter::Marker{std::move(generation.marker), std::move(generation.db_time)};
+                    });
+            }
+            // Загружает снимок процесс, создавший сегмент: иначе кэш уже прогрет
+            server::Readiness::instance().addStep("cache_snapshot",
+                [repository, cached, shared_cache, writer = cache_snapshot_, path = config_.cache_snapshot_path,
+                 window_s = config_.cache_ttl_s + config_.cache_snapshot_catchup_margin_s] {
+                    if (shared_cache->created()) {
+                        restoreCacheSnapshot(path, window_s, *repository, *cached, *shared_cache);
+                    }
+                    if (writer) {
+                        writer->start();
+                    }
+                });
+        }
+        if (config_.cache_preload > 0) {
+            server::Readiness::instance().addStep("cache_preload", [cached, limit = config_.cache_preload] {
+                const std::size_t loaded = cached->preload(limit);
+                LOG_INFO("Shared book cache preloaded", {{"books", loaded}});
+            });
+        }
+        return cached;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Shared book cache disabled", {{"error", e.what()}});
+        return repository;
+    }
+}
+
+void ApplicationBuilder::registerCacheMetrics(const std::shared_ptr<cache::SharedBookCache>& cache) const {
+    using metrics::Registry;
+    auto& registry = Registry::instance();
+    std::weak_ptr<cache::SharedBookCache> weak = cache;
+
+    registry.addSample("bookshelf_cache_hits_total", "Book reads served from the shared cache.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const cache::SharedBookCache& c) { return c.hits(); }));
+    registry.addSample("bookshelf_cache_misses_total", "Book reads that went to the database.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const cache::SharedBookCache& c) { return c.misses(); }));
+    registry.addSample("bookshelf_cache_fills_total", "Books written to the shared cache.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const cache::SharedBookCache& c) { return c.fills(); }));
+    registry.addSample("bookshelf_cache_skipped_fills_total",
+                       "Cache fills skipped: entry too large, busy or invalidated meanwhile.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const cache::SharedBookCache& c) { return c.skippedFills(); }));
+    registry.addSample("bookshelf_cache_invalidations_total", "Books removed from the cache after a change.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const cache::SharedBookCache& c) { return c.invalidations(); }));
+}
+
+void ApplicationBuilder::registerFeedMetrics(const std::shared_ptr<feed::ChangeFeed>& feed) const {
+    using metrics::Registry;
+    auto& registry = Registry::instance();
+    std::weak_ptr<feed::ChangeFeed> weak = feed;
+
+    registry.addSample("bookshelf_feed_subscribers", "Change feed requests waiting for events.",
+                       Registry::SampleType::GAUGE,
+                       sampleOf(weak, [](const feed::ChangeFeed& f) { return f.subscribers(); }));
+    registry.addSample("bookshelf_feed_events_total", "Book changes published to the change feed.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const feed::ChangeFeed& f) { return f.events(); }));
+    registry.addSample("bookshelf_feed_resets_total", "Change feed responses telling the client to reload.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const feed::ChangeFeed& f) { return f.resets(); }));
+    registry.addSample("bookshelf_feed_rejected_total", "Change feed requests rejected: too many subscribers.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const feed::ChangeFeed& f) { return f.rejected(); }));
+}
+
+void ApplicationBuilder::registerShelfHubMetrics(const std::shared_ptr<feed::ShelfHub>& hub) const {
+    using metrics::Registry;
+    auto& registry = Registry::instance();
+    std::weak_ptr<feed::ShelfHub> weak = hub;
+
+    registry.addSample("bookshelf_ws_connections", "Open WebSocket subscription connections.",
+                       Registry::SampleType::GAUGE,
+                       sampleOf(weak, [](const feed::ShelfHub& h) { return h.connections(); }));
+    registry.addSample("bookshelf_ws_frames_total", "WebSocket frames sent, one per connection per tick.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const feed::ShelfHub& h) { return h.frames(); }));
+    registry.addSample("bookshelf_ws_messages_total", "Subscription messages batched into WebSocket frames.",
+                       Registry::SampleType::COUNTER,
+                       sampleOf(weak, [](const feed::ShelfHub& h) { return h.messages(); }));
 }
 
 AppConfig ApplicationBuilder::getConfig() const {
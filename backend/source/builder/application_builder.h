@@ -5,16 +5,35 @@
 #include <memory>
 #include <string>
 #include <optional>
+#include <vector>
+
+#include "builder/bookshelf_app.h"
+
+namespace db { class ConnectionPool; }
+namespace cache { class SharedBookCache; class SnapshotWriter; }
+namespace feed { class ChangeFeed; class PgListener; class ShelfHub; }
 
 class BookController;
+class ChangeFeedController;
+class ShelfSocketController;
 class BookService;
+class BookRepository;
+class PostgresBookRepository;
 class AppConfig;
 
 // namespace nlohmann { class json; }
 
 struct AppComponents {
-    std::unique_ptr<crow::SimpleApp> app;
+    std::unique_ptr<BookshelfApp> app;          // TCP; нет, если server.listen_tcp = false
+    std::unique_ptr<BookshelfApp> local_app;    // Unix domain socket; нет без server.unix_socket.path
     std::shared_ptr<BookController> controller;
+    std::shared_ptr<db::ConnectionPool> db_pool;
+    // Лента изменений и ее LISTEN-соединение (только postgres); нет при feed.enabled = false
+    std::shared_ptr<feed::ChangeFeed> change_feed;
+    std::shared_ptr<feed::PgListener> change_listener;
+    std::shared_ptr<feed::ShelfHub> shelf_hub;      // подписки WebSocket поверх ленты
+    // Останавливается первым (последний снимок), пока пул еще открыт
+    std::shared_ptr<cache::SnapshotWriter> cache_snapshot;
 };
 
 struct AppConfig {
@@ -24,6 +43,93 @@ struct AppConfig {
     std::string db_user;
     std::string db_password;
     int server_port;
+
+    // HTTP-сервер: потоки-обработчики (0 - по числу ядер), привязка к ядрам,
+    // параметры сокета, таймаут keep-alive и предельный размер тела запроса
+    unsigned server_workers = 0;
+    std::vector<int> server_pin_cpus;
+    bool server_tcp_nodelay = true;
+    int server_backlog = 0;
+    unsigned server_keepalive_timeout_s = 5;
+    unsigned server_max_body_bytes = 1024 * 1024;
+
+    // Unix domain socket для локального обратного прокси (отдельно или вместе с TCP)
+    bool server_listen_tcp = true;
+    std::string server_unix_socket_path;
+    std::string server_unix_socket_mode = "0660";   // восьмеричные права файла сокета
+    bool server_unix_socket_remove_stale = true;
+    int server_unix_socket_backlog = 0;
+
+    // Хранилище книг: "postgres", "memory" (без БД, для нагрузочных тестов)
+    // или "log" (встроенное, журнал на диске)
+    std::string storage_backend = "postgres";
+    std::string storage_log_path = "bookshelf.log";
+    std::string storage_log_fsync = "interval";   // always / interval / never
+    unsigned storage_log_fsync_interval_ms = 100;
+    unsigned storage_log_compact_interval_s = 60;
+    unsigned storage_log_compact_min_bytes = 4 * 1024 * 1024;
+
+    // Кэш книг по id в разделяемой памяти, общий для процессов хоста (только для postgres)
+    bool cache_enabled = false;
+    std::string cache_shm_name = "/bookshelf_books";
+    unsigned cache_entries = 16384;
+    unsigned cache_entry_bytes = 1024;
+    unsigned cache_ttl_s = 30;
+    unsigned cache_preload = 0;                     // книг, загружаемых в кэш при прогреве
+    // Снимок кэша в файле для прогрева после перезапуска хоста; пустой путь - выключен
+    std::string cache_snapshot_path;
+    unsigned cache_snapshot_interval_s = 300;
+    unsigned cache_snapshot_catchup_margin_s = 60;  // запас на транзакции, начатые до снимка
+
+    // Лента изменений GET /api/books/changes (Server-Sent Events)
+    bool feed_enabled = true;
+    unsigned feed_history = 4096;                   // событий в кольце для Last-Event-ID
+    unsigned feed_coalesce_ms = 100;                // окно слияния изменений одной книги
+    unsigned feed_hold_s = 25;                      // сколько запрос ждет событий
+    unsigned feed_max_batch = 256;                  // событий в одном ответе
+    unsigned feed_max_subscribers = 10000;
+    unsigned feed_retry_ms = 1000;                  // поле retry для EventSource
+
+    // Подписки WebSocket /api/books/ws (работают поверх ленты изменений)
+    bool websocket_enabled = true;
+    unsigned websocket_tick_ms = 50;                // сообщения соединения за тик - один кадр
+    unsigned websocket_max_connections = 10000;
+    unsigned websocket_max_subscriptions = 1000;    // id и статусов на соединение
+    unsigned websocket_max_message_bytes = 16 * 1024;
+
+    // Полнотекстовый поиск /api/books/search: конфигурация text search PostgreSQL.
+    // Смена языка требует пересоздать столбец books.search
+    std::string search_language = "simple";
+
+    // Пул соединений с БД
+    unsigned db_pool_size = 8;
+    unsigned db_min_connections = 4;                // открываются при прогреве, до /ready
+    unsigned db_acquire_timeout_ms = 1000;
+
+    // Отладка: время каждого SQL-запроса в заголовке Server-Timing
+    bool server_timing_sql_detail = false;
+
+    // Журнал медленных запросов
+    unsigned slow_query_threshold_ms = 100;
+    bool slow_query_explain = false;
+    unsigned slow_query_explain_first_n = 3;
+
+    // Токен для /debug/* (заголовок X-Admin-Token); пустой - эндпоинты отключены
+    std::string admin_token;
+
+    // Сэмплирующий профилировщик кучи (/debug/heap)
+    bool heap_profile_enabled = false;
+    unsigned heap_profile_sample_interval = 512 * 1024;
+
+    // Запись выборки запросов для bookshelf_replay
+    bool capture_enabled = false;
+    std::string capture_path = "capture.bin";
+    double capture_sample_rate = 0.01;
+    unsigned capture_max_body_bytes = 64 * 1024;
+
+    // Логирование: минимальный уровень и лимит записей в секунду на место вызова
+    std::string log_level = "info";
+    unsigned log_rate_limit = 100;
     
     // Добавляем метод для получения строки подключения
     std::string get_connection_string(const std::string& dbname = "") const {
@@ -54,7 +160,14 @@ private:
     // Вспомогательные методы
     AppConfig loadConfigFromFile(const std::string& config_path) const;
     std::shared_ptr<pqxx::connection> establishDbConnection(const AppConfig& config, const std::string& dbname = "") const;
-    void registerRoutes(crow::SimpleApp& app) const;
+    std::unique_ptr<BookshelfApp> createApp() const;
+    void registerRoutes(BookshelfApp& app) const;
+    void registerDebugRoutes(BookshelfApp& app) const;
+    void registerPoolMetrics(const std::shared_ptr<db::ConnectionPool>& pool) const;
+    void registerCacheMetrics(const std::shared_ptr<cache::SharedBookCache>& cache) const;
+    void registerFeedMetrics(const std::shared_ptr<feed::ChangeFeed>& feed) const;
+    void registerShelfHubMetrics(const std::shared_ptr<feed::ShelfHub>& hub) const;
+    std::shared_ptr<BookRepository> withCache(std::shared_ptr<PostgresBookRepository> repository);
     
     // Новая функция инициализации БД
     bool initializeDatabase(const AppConfig& config) const;
@@ -63,4 +176,5 @@ private:
     std::string config_path_;
     std::optional<AppConfig> custom_config_;
     AppConfig config_; // Добавляем поле для хранения конфига
+    std::shared_ptr<cache::SnapshotWriter> cache_snapshot_;
 };
\ No newline at end of file
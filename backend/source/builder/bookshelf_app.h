@@ -0,0 +1,14 @@
+#pragma once
+
+#include <crow.h>
+
+#include "metrics/metrics_middleware.h"
+#include "metrics/server_timing.h"
+#include "capture/capture_middleware.h"
+#include "server/limits_middleware.h"
+
+// Тип приложения Crow со всеми middleware сервиса.
+// MetricsMiddleware идет первым: он сбрасывает состояние запроса потока.
+// LimitsMiddleware - до записи трафика, чтобы отклоненные запросы не попадали в нее
+using BookshelfApp = crow::App<metrics::MetricsMiddleware, metrics::ServerTimingMiddleware,
+                               server::LimitsMiddleware, capture::CaptureMiddleware>;
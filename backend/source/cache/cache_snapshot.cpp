@@ -0,0 +1,227 @@
+#include "cache/cache_snapshot.h"
+#include "storage/book_codec.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cache {
+
+namespace {
+
+constexpr char kMagic[8] = {'B', 'K', 'S', 'N', 'A', 'P', '0', '1'};
+constexpr std::uint32_t kVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t body_crc;
+    std::uint64_t books;
+    std::uint64_t body_bytes;
+    std::int64_t written_unix_ms;
+};
+
+std::int64_t unixMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void syncDirectory(const std::string& path) {
+    const auto slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : path.substr(0, std::max<std::size_t>(slash, 1));
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+} // namespace
+
+std::size_t writeSnapshot(const std::string& path, const SharedBookCache& cache,
+                          const std::string& generation, const std::string& db_time) {
+    std::string body;
+    storage::putString(body, generation);
+    storage::putString(body, db_time);
+    const std::size_t books = cache.forEach([&body](int, const char* data, std::size_t size) {
+        storage::put(body, static_cast<std::uint32_t>(size));
+        body.append(data, size);
+    });
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.body_crc = storage::crc32(body.data(), body.size());
+    header.books = books;
+    header.body_bytes = body.size();
+    header.written_unix_ms = unixMs();
+
+    const std::string tmp_path = path + ".tmp";
+    std::FILE* file = std::fopen(tmp_path.c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("Failed to create " + tmp_path + ": " + std::strerror(errno));
+    }
+    const bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                         std::fwrite(body.data(), 1, body.size(), file) == body.size() &&
+                         std::fflush(file) == 0 && ::fsync(fileno(file)) == 0;
+    std::fclose(file);
+    if (!written || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("Failed to write cache snapshot " + path + ": " + std::strerror(errno));
+    }
+    syncDirectory(path);
+    return books;
+}
+
+SnapshotReader::SnapshotReader(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno != ENOENT) {
+            LOG_WARN("Cannot open cache snapshot", {{"path", path}, {"error", std::strerror(errno)}});
+        }
+        return;
+    }
+    struct stat st{};
+    const bool sized = fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(FileHeader);
+    void* memory = sized ? mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0)
+                         : MAP_FAILED;
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        LOG_WARN("Cache snapshot ignored: cannot map file", {{"path", path}});
+        return;
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    madvise(memory, size, MADV_SEQUENTIAL);
+
+    FileHeader header;
+    std::memcpy(&header, memory, sizeof(header));
+    const char* body = static_cast<const char*>(memory) + sizeof(header);
+    const char* reason = nullptr;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+        reason = "unknown format";
+    } else if (header.body_bytes != size - sizeof(header)) {
+        reason = "truncated";
+    } else if (storage::crc32(body, header.body_bytes) != header.body_crc) {
+        reason = "checksum mismatch";
+    }
+
+    storage::Reader reader(body, reason == nullptr ? header.body_bytes : 0);
+    std::string generation;
+    std::string db_time;
+    if (reason == nullptr) {
+        generation = reader.getString();
+        db_time = reader.getString();
+        if (generation.empty() || db_time.empty()) {
+            reason = "missing generation";
+        }
+    }
+    if (reason != nullptr) {
+        LOG_WARN("Cache snapshot ignored", {{"path", path}, {"reason", reason}});
+        munmap(memory, size);
+        return;
+    }
+
+    memory_ = memory;
+    size_ = size;
+    end_ = body + header.body_bytes;
+    // Строки заголовка тела: [длина u32][байты]
+    records_ = body + 2 * sizeof(std::uint32_t) + generation.size() + db_time.size();
+    info_.generation = std::move(generation);
+    info_.db_time = std::move(db_time);
+    info_.books = header.books;
+    info_.written_unix_ms = header.written_unix_ms;
+}
+
+SnapshotReader::~SnapshotReader() {
+    if (memory_ != nullptr) {
+        munmap(memory_, size_);
+    }
+}
+
+std::size_t SnapshotReader::forEach(const std::function<void(const BookRow&)>& visit) const {
+    std::size_t count = 0;
+    const char* pos = records_;
+    BookRow book;
+    while (pos != nullptr && static_cast<std::size_t>(end_ - pos) >= sizeof(std::uint32_t)) {
+        std::uint32_t length;
+        std::memcpy(&length, pos, sizeof(length));
+        pos += sizeof(length);
+        if (length > static_cast<std::size_t>(end_ - pos)) {
+            break;
+        }
+        storage::Reader reader(pos, length);
+        pos += length;
+        if (storage::decodeBook(reader, book)) {
+            visit(book);
+            ++count;
+        }
+    }
+    return count;
+}
+
+SnapshotWriter::SnapshotWriter(Settings settings, std::shared_ptr<SharedBookCache> cache, MarkerFn marker)
+    : settings_(std::move(settings)), cache_(std::move(cache)), marker_(std::move(marker)) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    stop();
+}
+
+void SnapshotWriter::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    worker_ = std::thread([this] { loop(); });
+}
+
+void SnapshotWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    stop_requested_.notify_one();
+    worker_.join();
+    // Плановый перезапуск: следующий процесс стартует с самого свежего снимка
+    writeNow();
+}
+
+void SnapshotWriter::loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_requested_.wait_for(lock, settings_.interval, [this] { return !running_; })) {
+        lock.unlock();
+        writeNow();
+        lock.lock();
+    }
+}
+
+bool SnapshotWriter::writeNow() {
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        // Время БД берется до обхода: книги снимка не старше его минус ttl кэша
+        const Marker marker = marker_();
+        const std::size_t books = writeSnapshot(settings_.path, *cache_, marker.generation, marker.db_time);
+        LOG_INFO("Cache snapshot written", {
+            {"path", settings_.path},
+            {"books", books},
+            {"duration_ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()}
+        });
+        return true;
+    } catch (const std::exception& e) {
+        LOG_WARN("Cache snapshot failed", {{"path", settings_.path}, {"error", e.what()}});
+        return false;
+    }
+}
+
+} // namespace cache
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "cache/shared_book_cache.h"
+#include "model/book.h"
+
+namespace cache {
+
+// Снимок кэша книг в файле: разделяемая память переживает перезапуск процесса,
+// но не хоста или контейнера. Файл: заголовок (magic "BKSNAP01", версия, число
+// книг, размер и crc32 тела), тело - [поколение БД][время БД][записи], запись -
+// [длина u32][книга в формате storage::encodeBook]. Читается через mmap;
+// новый снимок пишется рядом и подменяет старый через rename
+struct SnapshotInfo {
+    std::string generation;     // отметка базы: снимок другой базы не загружается
+    std::string db_time;        // время БД перед обходом кэша
+    std::uint64_t books = 0;
+    std::int64_t written_unix_ms = 0;
+};
+
+// Записывает непросроченные книги кэша; возвращает их число
+std::size_t writeSnapshot(const std::string& path, const SharedBookCache& cache,
+                          const std::string& generation, const std::string& db_time);
+
+// Отображенный в память и проверенный файл снимка
+class SnapshotReader {
+public:
+    // Файла нет, он поврежден или другой версии - valid() == false
+    explicit SnapshotReader(const std::string& path);
+    ~SnapshotReader();
+
+    bool valid() const { return memory_ != nullptr; }
+    const SnapshotInfo& info() const { return info_; }
+
+    // Возвращает число прочитанных книг
+    std::size_t forEach(const std::function<void(const BookRow&)>& visit) const;
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+private:
+    void* memory_ = nullptr;
+    std::size_t size_ = 0;
+    const char* records_ = nullptr;
+    const char* end_ = nullptr;
+    SnapshotInfo info_;
+};
+
+// Периодическая запись снимка в фоне и последний снимок при остановке
+class SnapshotWriter {
+public:
+    struct Settings {
+        std::string path;
+        std::chrono::seconds interval{300};
+    };
+
+    // Поколение и время БД на момент снимка
+    struct Marker {
+        std::string generation;
+        std::string db_time;
+    };
+    using MarkerFn = std::function<Marker()>;
+
+    SnapshotWriter(Settings settings, std::shared_ptr<SharedBookCache> cache, MarkerFn marker);
+    ~SnapshotWriter();
+
+    // После восстановления из снимка: раньше можно затереть его пустым кэшем
+    void start();
+    void stop();
+
+    bool writeNow();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+private:
+    void loop();
+
+    Settings settings_;
+    std::shared_ptr<SharedBookCache> cache_;
+    MarkerFn marker_;
+
+    std::mutex mutex_;
+    std::condition_variable stop_requested_;
+    bool running_ = false;
+    std::thread worker_;
+};
+
+} // namespace cache
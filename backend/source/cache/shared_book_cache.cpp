@@ -0,0 +1,360 @@
+#include "cache/shared_book_cache.h"
+#include "storage/book_codec.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cache {
+
+namespace {
+
+constexpr std::uint64_t kMagic = 0x3143484341434b42ull;   // "BKCACHE1"
+constexpr std::uint32_t kLayoutVersion = 1;
+constexpr int kReadAttempts = 4;
+// Сколько invalidate ждет писателя, занявшего ячейку
+constexpr auto kInvalidateWait = std::chrono::milliseconds(50);
+// Запись ячейки - копия до entry_bytes: писатель, держащий ячейку дольше,
+// остановлен (SIGSTOP, отладчик) или его pid занят другим процессом
+constexpr std::uint32_t kStaleLockMs = 5000;
+// Сколько подключающийся процесс ждет, пока создатель подготовит сегмент
+constexpr auto kAttachWait = std::chrono::seconds(1);
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free &&
+              std::atomic<std::uint64_t>::is_always_lock_free,
+              "shared memory atomics must be lock-free");
+
+std::runtime_error systemError(const std::string& what, const std::string& name) {
+    return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+}
+
+std::int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Владелец ячейки: pid в старших 32 битах, младшие 32 бита времени захвата
+std::uint64_t ownerToken() {
+    return (static_cast<std::uint64_t>(getpid()) << 32) | static_cast<std::uint32_t>(nowMs());
+}
+
+bool abandoned(std::uint64_t owner) {
+    const auto locked_ms = static_cast<std::uint32_t>(owner);
+    if (static_cast<std::uint32_t>(nowMs()) - locked_ms > kStaleLockMs) {
+        return true;
+    }
+    return kill(static_cast<pid_t>(owner >> 32), 0) != 0 && errno == ESRCH;
+}
+
+std::size_t roundUpPowerOfTwo(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+struct SharedBookCache::Header {
+    std::atomic<std::uint64_t> magic;       // пишется последним: сегмент готов
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t entries;
+    std::uint64_t entry_bytes;
+    char padding[32];
+};
+
+// За заголовком ячейки идут данные книги (storage::encodeBook)
+struct SharedBookCache::Entry {
+    std::atomic<std::uint32_t> sequence;        // нечетный - ячейку пишут
+    std::atomic<std::uint32_t> invalidations;
+    std::atomic<std::int32_t> id;               // 0 - пусто
+    std::atomic<std::uint32_t> length;
+    std::atomic<std::int64_t> filled_ms;        // steady_clock, общий для процессов хоста
+    std::atomic<std::uint64_t> owner;           // ownerToken писателя; 0 - свободна
+
+    char* data() { return reinterpret_cast<char*>(this) + kEntryHeaderBytes; }
+};
+
+SharedBookCache::SharedBookCache(Settings settings)
+    : settings_(std::move(settings)) {
+    static_assert(sizeof(Header) == 64, "cache header layout");
+    static_assert(sizeof(Entry) == kEntryHeaderBytes, "cache entry header layout");
+
+    entries_ = roundUpPowerOfTwo(std::max<std::size_t>(settings_.entries, 1));
+    // Ячейки по границе строки кэша процессора
+    entry_bytes_ = (std::max<std::size_t>(settings_.entry_bytes, 128) + 63) / 64 * 64;
+    ttl_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(settings_.ttl).count();
+    memory_bytes_ = sizeof(Header) + entries_ * entry_bytes_;
+
+    const std::string& name = settings_.shm_name;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    const bool created = fd >= 0;
+    created_ = created;
+    if (created) {
+        // ftruncate заполняет сегмент нулями: пустые ячейки с четной версией
+        if (ftruncate(fd, static_cast<off_t>(memory_bytes_)) != 0) {
+            const auto error = systemError("Failed to size shared cache", name);
+            close(fd);
+            shm_unlink(name.c_str());
+            throw error;
+        }
+    } else {
+        if (errno != EEXIST) {
+            throw systemError("Failed to create shared cache", name);
+        }
+        fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            throw systemError("Failed to open shared cache", name);
+        }
+        // Создатель мог еще не задать размер
+        struct stat st{};
+        const auto deadline = std::chrono::steady_clock::now() + kAttachWait;
+        while (fstat(fd, &st) == 0 && st.st_size == 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (static_cast<std::size_t>(st.st_size) != memory_bytes_) {
+            close(fd);
+            throw std::runtime_error("Shared cache " + name + " has a different size: remove it or change cache.shm_name");
+        }
+    }
+
+    void* memory = mmap(nullptr, memory_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        throw systemError("Failed to map shared cache", name);
+    }
+    memory_ = memory;
+    entries_base_ = static_cast<char*>(memory_) + sizeof(Header);
+
+    auto* header = static_cast<Header*>(memory_);
+    if (created) {
+        header->version = kLayoutVersion;
+        header->entries = entries_;
+        header->entry_bytes = entry_bytes_;
+        header->magic.store(kMagic, std::memory_order_release);
+        return;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + kAttachWait;
+    while (header->magic.load(std::memory_order_acquire) != kMagic) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            munmap(memory_, memory_bytes_);
+            throw std::runtime_error("Shared cache " + name + " is not initialized: remove it");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (header->version != kLayoutVersion || header->entries != entries_ || header->entry_bytes != entry_bytes_) {
+        munmap(memory_, memory_bytes_);
+        throw std::runtime_error("Shared cache " + name + " has a different layout: remove it or change cache.shm_name");
+    }
+}
+
+SharedBookCache::~SharedBookCache() {
+    if (memory_ != nullptr) {
+        munmap(memory_, memory_bytes_);
+    }
+}
+
+void SharedBookCache::unlink(const std::string& shm_name) {
+    shm_unlink(shm_name.c_str());
+}
+
+SharedBookCache::Entry& SharedBookCache::entry(int id) const {
+    // id выдаются подряд (SERIAL): младшие биты раскладывают их по ячейкам без коллизий
+    const std::size_t index = static_cast<std::uint32_t>(id) & (entries_ - 1);
+    return *reinterpret_cast<Entry*>(entries_base_ + index * entry_bytes_);
+}
+
+std::optional<BookRow> SharedBookCache::get(int id) {
+    thread_local std::string buffer;
+    Entry& e = entry(id);
+
+    for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+        const std::uint32_t sequence = e.sequence.load(std::memory_order_acquire);
+        if (sequence & 1u) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (e.id.load(std::memory_order_relaxed) != id) {
+            break;
+        }
+        const std::uint32_t length = e.length.load(std::memory_order_relaxed);
+        const std::int64_t filled_ms = e.filled_ms.load(std::memory_order_relaxed);
+        if (length > dataCapacity()) {
+            break;
+        }
+        buffer.resize(length);
+        std::memcpy(buffer.data(), e.data(), length);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+
+        if (nowMs() - filled_ms > ttl_ms_) {
+            break;
+        }
+        BookRow book;
+        storage::Reader reader(buffer.data(), buffer.size());
+        if (!storage::decodeBook(reader, book) || book.id != id) {
+            break;
+        }
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return book;
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+std::size_t SharedBookCache::forEach(const EntryVisitor& visit) const {
+    std::string buffer;
+    std::size_t visited = 0;
+    const std::int64_t now = nowMs();
+    for (std::size_t index = 0; index < entries_; ++index) {
+        Entry& e = *reinterpret_cast<Entry*>(entries_base_ + index * entry_bytes_);
+        for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+            const std::uint32_t sequence = e.sequence.load(std::memory_order_acquire);
+            if (sequence & 1u) {
+                continue;
+            }
+            const std::int32_t id = e.id.load(std::memory_order_relaxed);
+            const std::uint32_t length = e.length.load(std::memory_order_relaxed);
+            const std::int64_t filled_ms = e.filled_ms.load(std::memory_order_relaxed);
+            if (id == 0 || length > dataCapacity() || now - filled_ms > ttl_ms_) {
+                break;
+            }
+            buffer.assign(e.data(), length);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (e.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+            visit(id, buffer.data(), buffer.size());
+            ++visited;
+            break;
+        }
+    }
+    return visited;
+}
+
+SharedBookCache::Ticket SharedBookCache::fillTicket(int id) {
+    Ticket ticket;
+    ticket.id = id;
+    ticket.invalidations = entry(id).invalidations.load();
+    ticket.valid = true;
+    return ticket;
+}
+
+std::uint64_t SharedBookCache::lock(Entry& e) {
+    std::uint64_t owner = e.owner.load();
+    if (owner != 0 && !abandoned(owner)) {
+        return 0;
+    }
+    const std::uint64_t token = ownerToken();
+    if (!e.owner.compare_exchange_strong(owner, token)) {
+        return 0;
+    }
+    // Прежний владелец умер или завис посреди записи: номер уже нечетный,
+    // данные могут быть недописаны - ячейка очищается
+    const std::uint32_t sequence = e.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1u) == 0) {
+        e.sequence.store(sequence + 1, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    if (owner != 0) {
+        e.id.store(0, std::memory_order_relaxed);
+    }
+    return token;
+}
+
+bool SharedBookCache::unlock(Entry& e, std::uint64_t owner) {
+    if (e.owner.load() != owner) {
+        return false;
+    }
+    e.sequence.store(e.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    e.owner.compare_exchange_strong(owner, 0);
+    return true;
+}
+
+void SharedBookCache::clear(Entry& e, int id) {
+    // Живой писатель сам увидит новую инвалидацию (проверка до и после
+    // публикации в fill); ждем его, чтобы книга не читалась и в этом окне
+    const auto deadline = std::chrono::steady_clock::now() + kInvalidateWait;
+    for (;;) {
+        const std::uint64_t owner = lock(e);
+        if (owner != 0) {
+            if (e.id.load(std::memory_order_relaxed) == id) {
+                e.id.store(0, std::memory_order_relaxed);
+            }
+            unlock(e, owner);
+            return;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void SharedBookCache::fill(const Ticket& ticket, const BookRow& book) {
+    if (!ticket.valid || book.id != ticket.id) {
+        return;
+    }
+    thread_local std::string buffer;
+    buffer.clear();
+    storage::encodeBook(buffer, book);
+    if (buffer.size() > dataCapacity()) {
+        skipped_fills_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Ячейку пишет другой процесс - заполнение необязательно, пропускаем
+    Entry& e = entry(ticket.id);
+    const std::uint64_t owner = lock(e);
+    if (owner == 0) {
+        skipped_fills_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::memcpy(e.data(), buffer.data(), buffer.size());
+    e.length.store(static_cast<std::uint32_t>(buffer.size()), std::memory_order_relaxed);
+    e.filled_ms.store(nowMs(), std::memory_order_relaxed);
+
+    // Книгу изменили после билета: данные устарели, ячейку оставляем пустой.
+    // Парная проверка в invalidate: счетчик увеличивается до захвата ячейки
+    const bool stale = e.invalidations.load() != ticket.invalidations;
+    if (e.owner.load() == owner) {
+        e.id.store(stale ? 0 : ticket.id, std::memory_order_relaxed);
+    }
+    if (!unlock(e, owner) || stale) {
+        skipped_fills_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // invalidate, не дождавшаяся медленного писателя, полагается на эту
+    // проверку: изменение после первой проверки убирает уже опубликованную книгу
+    if (e.invalidations.load() != ticket.invalidations) {
+        clear(e, ticket.id);
+        skipped_fills_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    fills_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SharedBookCache::invalidate(int id) {
+    invalidations_.fetch_add(1, std::memory_order_relaxed);
+    Entry& e = entry(id);
+    e.invalidations.fetch_add(1);
+    clear(e, id);
+}
+
+} // namespace cache
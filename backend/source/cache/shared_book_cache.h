@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "model/book.h"
+
+namespace cache {
+
+// Кэш книг по id в именованной разделяемой памяти (shm_open): его читают и
+// заполняют все процессы bookshelf_api на хосте, а перезапущенный процесс
+// подключается к уже прогретому сегменту.
+//
+// Таблица прямого отображения: id -> ячейка фиксированного размера, коллизия
+// вытесняет прежнюю книгу. Ячейка защищена seqlock: читатель копирует данные
+// без блокировок и повторяет попытку, если номер версии изменился. Писатель
+// захватывает ячейку, записывая в нее свой pid и время захвата, и на время
+// записи делает номер нечетным. Ячейку процесса, умершего посреди записи,
+// или писателя, держащего ее дольше 5 с, забирает следующий писатель
+// (процессы должны видеть pid друг друга: одно пространство имен pid).
+//
+// Заполнение не должно вернуть в кэш данные, прочитанные до изменения книги:
+// перед чтением из БД берется билет (fillTicket), invalidate увеличивает
+// счетчик инвалидаций ячейки, и fill с устаревшим билетом ничего не пишет.
+// Изменения в обход сервиса (другие хосты, ручные правки) ограничены ttl
+class SharedBookCache {
+public:
+    struct Settings {
+        std::string shm_name = "/bookshelf_books";
+        std::size_t entries = 16384;        // округляется вверх до степени двойки
+        std::size_t entry_bytes = 1024;     // книги крупнее не кэшируются
+        std::chrono::seconds ttl{30};
+    };
+
+    struct Ticket {
+        int id = 0;
+        std::uint32_t invalidations = 0;
+        bool valid = false;
+    };
+
+    // Подключается к сегменту или создает его. Сегмент с другой геометрией
+    // (другие entries/entry_bytes) не используется: исключение
+    explicit SharedBookCache(Settings settings);
+    ~SharedBookCache();
+
+    std::optional<BookRow> get(int id);
+
+    Ticket fillTicket(int id);
+    void fill(const Ticket& ticket, const BookRow& book);
+
+    // Вызывается после фиксации изменения книги в хранилище
+    void invalidate(int id);
+
+    // Удаление сегмента: следующий запуск начнет с пустого кэша
+    static void unlink(const std::string& shm_name);
+
+    // Сегмент создан этим процессом, т.е. пуст; иначе он уже прогрет соседями
+    bool created() const { return created_; }
+
+    // Обход непросроченных книг (для снимка): данные в формате storage::encodeBook.
+    // Ячейки, которые пишутся во время обхода, пропускаются
+    using EntryVisitor = std::function<void(int id, const char* data, std::size_t size)>;
+    std::size_t forEach(const EntryVisitor& visit) const;
+
+    std::size_t capacity() const { return entries_; }
+    std::uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    std::uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+    std::uint64_t fills() const { return fills_.load(std::memory_order_relaxed); }
+    std::uint64_t skippedFills() const { return skipped_fills_.load(std::memory_order_relaxed); }
+    std::uint64_t invalidations() const { return invalidations_.load(std::memory_order_relaxed); }
+
+    SharedBookCache(const SharedBookCache&) = delete;
+    SharedBookCache& operator=(const SharedBookCache&) = delete;
+
+private:
+    struct Header;
+    struct Entry;
+
+    Entry& entry(int id) const;
+    // Захват ячейки писателем: 0 - ячейку держит другой живой писатель
+    static std::uint64_t lock(Entry& e);
+    // false - ячейку забрали как зависшую, записанное не публикуется
+    static bool unlock(Entry& e, std::uint64_t owner);
+    // Очистка ячейки, если в ней книга id; ждет живого писателя до kInvalidateWait
+    static void clear(Entry& e, int id);
+    std::size_t dataCapacity() const { return entry_bytes_ - kEntryHeaderBytes; }
+
+    static constexpr std::size_t kEntryHeaderBytes = 32;
+
+    Settings settings_;
+    bool created_ = false;
+    std::size_t entries_ = 0;
+    std::size_t entry_bytes_ = 0;
+    std::int64_t ttl_ms_ = 0;
+    void* memory_ = nullptr;
+    std::size_t memory_bytes_ = 0;
+    char* entries_base_ = nullptr;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> fills_{0};
+    std::atomic<std::uint64_t> skipped_fills_{0};
+    std::atomic<std::uint64_t> invalidations_{0};
+};
+
+} // namespace cache
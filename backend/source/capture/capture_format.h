@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Формат файла записи трафика. Общий для сервера (CaptureMiddleware) и
+// bookshelf_replay, поэтому только заголовок и без зависимостей от Crow.
+// Файл: "BKSHCAP1", затем записи [длина u32][данные], числа в порядке байт платформы
+namespace capture {
+
+constexpr char kFileMagic[8] = {'B', 'K', 'S', 'H', 'C', 'A', 'P', '1'};
+
+struct CaptureRecord {
+    std::uint64_t offset_us = 0;        // начало запроса от начала записи
+    std::uint16_t status = 0;
+    std::uint32_t duration_us = 0;      // время обработки на сервере
+    std::uint64_t response_bytes = 0;
+    std::uint64_t response_hash = 0;    // bodyHash(тело ответа)
+    std::string method;
+    std::string target;                 // путь с query string
+    std::string accept;                 // заголовок Accept: от него зависит формат ответа
+    std::string body;
+};
+
+// FNV-1a 64
+inline std::uint64_t bodyHash(std::string_view data) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+namespace detail {
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void putString(std::string& out, const std::string& value) {
+    put(out, static_cast<std::uint32_t>(value.size()));
+    out.append(value);
+}
+
+template <typename T>
+bool get(std::string_view& in, T& value) {
+    if (in.size() < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, in.data(), sizeof(T));
+    in.remove_prefix(sizeof(T));
+    return true;
+}
+
+inline bool getString(std::string_view& in, std::string& value) {
+    std::uint32_t size = 0;
+    if (!get(in, size) || in.size() < size) {
+        return false;
+    }
+    value.assign(in.data(), size);
+    in.remove_prefix(size);
+    return true;
+}
+
+} // namespace detail
+
+// Дописывает запись вместе с префиксом длины
+inline void encodeRecord(std::string& out, const CaptureRecord& record) {
+    const std::size_t length_pos = out.size();
+    detail::put(out, std::uint32_t{0});
+    detail::put(out, record.offset_us);
+    detail::put(out, record.status);
+    detail::put(out, record.duration_us);
+    detail::put(out, record.response_bytes);
+    detail::put(out, record.response_hash);
+    detail::putString(out, record.method);
+    detail::putString(out, record.target);
+    detail::putString(out, record.accept);
+    detail::putString(out, record.body);
+    const auto length = static_cast<std::uint32_t>(out.size() - length_pos - sizeof(std::uint32_t));
+    std::memcpy(out.data() + length_pos, &length, sizeof(length));
+}
+
+inline bool decodeRecord(std::string_view data, CaptureRecord& record) {
+    return detail::get(data, record.offset_us) &&
+           detail::get(data, record.status) &&
+           detail::get(data, record.duration_us) &&
+           detail::get(data, record.response_bytes) &&
+           detail::get(data, record.response_hash) &&
+           detail::getString(data, record.method) &&
+           detail::getString(data, record.target) &&
+           detail::getString(data, record.accept) &&
+           detail::getString(data, record.body) &&
+           data.empty();
+}
+
+inline bool readHeader(std::istream& in) {
+    char magic[sizeof(kFileMagic)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, kFileMagic, sizeof(magic)) == 0;
+}
+
+inline void writeHeader(std::ostream& out) {
+    out.write(kFileMagic, sizeof(kFileMagic));
+}
+
+// Следующая запись; false в конце файла или на оборванной последней записи
+inline bool readRecord(std::istream& in, CaptureRecord& record) {
+    std::uint32_t length = 0;
+    if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+        return false;
+    }
+    std::string payload(length, '\0');
+    if (!in.read(payload.data(), length)) {
+        return false;
+    }
+    return decodeRecord(payload, record);
+}
+
+} // namespace capture
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <crow.h>
+#include <chrono>
+
+#include "capture/traffic_capture.h"
+#include "metrics/metrics.h"
+#include "metrics/metrics_middleware.h"
+
+namespace capture {
+
+// Middleware Crow: для выборки запросов пишет метод, путь, тело, время
+// обработки, статус и хэш ответа в TrafficCapture. Заголовки, кроме Accept,
+// не сохраняются; служебные /debug/* не пишутся
+struct CaptureMiddleware {
+    struct context {
+        bool sampled = false;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void before_handle(crow::request& req, crow::response& /*res*/, context& ctx) {
+        ctx.sampled = TrafficCapture::instance().sample() &&
+                      req.body.size() <= TrafficCapture::instance().maxBodyBytes();
+        if (ctx.sampled) {
+            ctx.start = std::chrono::steady_clock::now();
+        }
+    }
+
+    template <typename AllContext>
+    void after_handle(crow::request& req, crow::response& res, context& ctx, AllContext& all_ctx) {
+        if (!ctx.sampled ||
+            all_ctx.template get<metrics::MetricsMiddleware>().state().route == metrics::RouteId::DEBUG) {
+            return;
+        }
+        auto& capture = TrafficCapture::instance();
+
+        CaptureRecord record;
+        record.offset_us = capture.offsetUs(ctx.start);
+        record.status = static_cast<std::uint16_t>(res.code);
+        record.duration_us = static_cast<std::uint32_t>(metrics::elapsedNs(ctx.start) / 1000);
+        record.response_bytes = res.body.size();
+        record.response_hash = bodyHash(res.body);
+        record.method = crow::method_name(req.method);
+        record.target = req.raw_url;
+        record.accept = req.get_header_value("Accept");
+        record.body = req.body;
+        capture.submit(std::move(record));
+    }
+};
+
+} // namespace capture
@@ -0,0 +1,119 @@
+#include "capture/traffic_capture.h"
+#include "logger/logger.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace capture {
+
+TrafficCapture& TrafficCapture::instance() {
+    static TrafficCapture capture;
+    return capture;
+}
+
+TrafficCapture::~TrafficCapture() {
+    stop();
+}
+
+void TrafficCapture::configure(Settings settings) {
+    stop();
+    if (!settings.enabled || settings.sample_rate <= 0.0) {
+        return;
+    }
+
+    // Смещения записей отсчитываются от запуска, поэтому файл каждый раз новый
+    std::FILE* file = std::fopen(settings.path.c_str(), "wb");
+    if (file == nullptr) {
+        LOG_ERROR("Traffic capture disabled: cannot open file", {{"path", settings.path}});
+        return;
+    }
+    std::fwrite(kFileMagic, 1, sizeof(kFileMagic), file);
+
+    const double rate = std::min(settings.sample_rate, 1.0);
+    sample_threshold_.store(rate >= 1.0 ? UINT64_MAX
+                                        : static_cast<std::uint64_t>(std::ldexp(rate, 64)),
+                            std::memory_order_relaxed);
+    max_body_bytes_.store(settings.max_body_bytes, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_ = file;
+        running_ = true;
+        started_ = std::chrono::steady_clock::now();
+    }
+    writer_ = std::thread([this] { writerLoop(); });
+    enabled_.store(true, std::memory_order_release);
+
+    LOG_INFO("Traffic capture enabled", {{"path", settings.path}, {"sample_rate", rate}});
+}
+
+void TrafficCapture::stop() {
+    enabled_.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    records_ready_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool TrafficCapture::sample() {
+    if (!enabled_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    return rng() < sample_threshold_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t TrafficCapture::offsetUs(std::chrono::steady_clock::time_point start) const {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(start - started_).count());
+}
+
+void TrafficCapture::submit(CaptureRecord record) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        if (records_.size() >= kMaxPendingRecords) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        records_.push_back(std::move(record));
+    }
+    records_ready_.notify_one();
+}
+
+void TrafficCapture::writerLoop() {
+    std::vector<CaptureRecord> batch;
+    std::string buffer;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            records_ready_.wait(lock, [this] { return !running_ || !records_.empty(); });
+            if (records_.empty() && !running_) {
+                break;
+            }
+            batch.assign(std::make_move_iterator(records_.begin()), std::make_move_iterator(records_.end()));
+            records_.clear();
+        }
+
+        buffer.clear();
+        for (const auto& record : batch) {
+            encodeRecord(buffer, record);
+        }
+        std::fwrite(buffer.data(), 1, buffer.size(), file_);
+        std::fflush(file_);
+    }
+}
+
+} // namespace capture
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "capture/capture_format.h"
+
+namespace capture {
+
+// Запись выборки запросов в файл для bookshelf_replay. Рабочий поток только
+// кладет готовую запись в ограниченную очередь, в файл пишет фоновый поток;
+// при переполнении очереди запись отбрасывается и учитывается в счетчике
+class TrafficCapture {
+public:
+    struct Settings {
+        bool enabled = false;
+        std::string path = "capture.bin";
+        double sample_rate = 0.01;              // доля записываемых запросов
+        std::size_t max_body_bytes = 64 * 1024; // запросы с телом больше не пишутся
+    };
+
+    static TrafficCapture& instance();
+
+    ~TrafficCapture();
+
+    void configure(Settings settings);
+    void stop();
+
+    // Решение о записи запроса; дешево, когда запись выключена
+    bool sample();
+
+    std::size_t maxBodyBytes() const { return max_body_bytes_.load(std::memory_order_relaxed); }
+
+    // Смещение момента start от начала записи
+    std::uint64_t offsetUs(std::chrono::steady_clock::time_point start) const;
+
+    void submit(CaptureRecord record);
+
+    std::uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+private:
+    TrafficCapture() = default;
+
+    void writerLoop();
+
+    static constexpr std::size_t kMaxPendingRecords = 4096;
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<std::uint64_t> sample_threshold_{0};   // sample_rate в долях 2^64
+    std::atomic<std::size_t> max_body_bytes_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::chrono::steady_clock::time_point started_;
+
+    std::mutex mutex_;
+    std::condition_variable records_ready_;
+    std::deque<CaptureRecord> records_;
+    bool running_ = false;
+    std::FILE* file_ = nullptr;
+    std::thread writer_;
+};
+
+} // namespace capture
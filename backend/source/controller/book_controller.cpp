@@ -1,65 +1,117 @@
-#include <nlohmann/json.hpp>
+#include <charconv>
+#include <cstring>
 #include <iostream>
 
 #include "book_controller.h"
 #include "error_handler.h"
 #include "book_service.h" 
+#include "serializer/book_serializer.h"
+#include "serializer/book_input_parser.h"
+#include "memory/request_arena.h"
+#include "metrics/metrics.h"
 
-using json = nlohmann::json;
+using serializer::BookInputParser;
+using serializer::BookSerializer;
+using serializer::InputError;
+using serializer::ResponseFormat;
+
+namespace {
+
+// Ограничения запроса поиска
+constexpr std::size_t kMaxSearchQueryLength = 256;
+constexpr std::size_t kDefaultSearchLimit = 20;
+constexpr std::size_t kMaxSearchLimit = 100;
+
+// Ответ в формате, выбранном по заголовку Accept
+crow::response formattedResponse(ResponseFormat format, std::string body) {
+    crow::response resp(std::move(body));
+    resp.set_header("Content-Type", BookSerializer::contentType(format));
+    resp.set_header("Vary", "Accept");
+    return resp;
+}
+
+// Ошибка разбора тела запроса -> ответ 400
+crow::response inputErrorResponse(const InputError& error) {
+    if (error.kind == InputError::Kind::INVALID_JSON) {
+        return error_handler::ErrorHandler::badRequest(error.message, error.details);
+    }
+    return error_handler::ErrorHandler::validationError(error.message, error.details);
+}
+
+// Обработка запроса в своей области: арена сбрасывается по завершении,
+// число выделений кучи за время обработки отдается в заголовке ответа.
+// Маршрут запоминается для метрик
+template <typename Handler>
+crow::response inRequestScope(metrics::RouteId route, Handler&& handler) {
+    metrics::setRoute(route);
+    memory::RequestScope scope;
+    crow::response resp = handler();
+    resp.set_header("X-Request-Allocations", std::to_string(scope.allocations()));
+    return resp;
+}
+
+} // namespace
 
 BookController::BookController(std::shared_ptr<BookService> book_service)
     : book_service_(book_service) {}
 
-void BookController::setupRoutes(crow::SimpleApp& app) {
+void BookController::setupRoutes(BookshelfApp& app) {
     // GET /api/books - получить все книги
     CROW_ROUTE(app, "/api/books")
     .methods("GET"_method)
-    ([this]() {
-        return handleGetAllBooks();
+    ([this](const crow::request& req) {
+        return inRequestScope(metrics::RouteId::GET_BOOKS, [&] { return handleGetAllBooks(req); });
     });
 
     // GET /api/books/<int> - получить книгу по ID
     CROW_ROUTE(app, "/api/books/<int>")
     .methods("GET"_method)
-    ([this](int id) {
-        return handleGetBookById(id);
+    ([this](const crow::request& req, int id) {
+        return inRequestScope(metrics::RouteId::GET_BOOK, [&] { return handleGetBookById(req, id); });
     });
 
     // POST /api/books - создать новую книгу
     CROW_ROUTE(app, "/api/books")
     .methods("POST"_method)
     ([this](const crow::request& req) {
-        return handleCreateBook(req);
+        return inRequestScope(metrics::RouteId::CREATE_BOOK, [&] { return handleCreateBook(req); });
     });
 
     // PUT /api/books/<int> - обновить книгу
     CROW_ROUTE(app, "/api/books/<int>")
     .methods("PUT"_method)
     ([this](const crow::request& req, int id) {
-        return handleUpdateBook(req, id);
+        return inRequestScope(metrics::RouteId::UPDATE_BOOK, [&] { return handleUpdateBook(req, id); });
     });
 
     // DELETE /api/books/<int> - удалить книгу
     CROW_ROUTE(app, "/api/books/<int>")
     .methods("DELETE"_method)
     ([this](int id) {
-        return handleDeleteBook(id);
+        return inRequestScope(metrics::RouteId::DELETE_BOOK, [&] { return handleDeleteBook(id); });
     });
 
     // GET /api/stats - получить статистику
     CROW_ROUTE(app, "/api/stats")
     .methods("GET"_method)
-    ([this]() {
-        return handleGetStats();
+    ([this](const crow::request& req) {
+        return inRequestScope(metrics::RouteId::GET_STATS, [&] { return handleGetStats(req); });
+    });
+
+    // GET /api/books/search?q=...&limit=20&cursor=... - полнотекстовый поиск
+    CROW_ROUTE(app, "/api/books/search")
+    .methods("GET"_method)
+    ([this](const crow::request& req) {
+        return inRequestScope(metrics::RouteId::SEARCH_BOOKS, [&] { return handleSearchBooks(req); });
     });
 }
 
-crow::response BookController::handleGetAllBooks() {
+crow::response BookController::handleGetAllBooks(const crow::request& req) {
     try {
-        json books = book_service_->getAllBooks();
-        crow::response resp(books.dump());
-        resp.set_header("Content-Type", "application/json");
-        return resp;
+        auto format = BookSerializer::negotiateFormat(req.get_header_value("Accept"));
+        auto books = book_service_->getAllBooks();
+        metrics::PhaseTimer serialize_timer(metrics::Phase::SERIALIZE);
+        return formattedResponse(format, BookSerializer::serializeBooks(books, format));
         
     } catch (const error_handler::ApiException& e) {
         return error_handler::ErrorHandler::handleError(e);
@@ -70,12 +122,15 @@ crow::response BookController::handleGetAllBooks() {
     }
 }
 
-crow::response BookController::handleGetBookById(int id) {
+crow::response BookController::handleGetBookById(const crow::request& req, int id) {
     try {
-        json book = book_service_->getBookById(id);
-        crow::response resp(book.dump());
-        resp.set_header("Content-Type", "application/json");
-        return resp;
+        auto format = BookSerializer::negotiateFormat(req.get_header_value("Accept"));
+        auto book = book_service_->getBookById(id);
+        if (!book) {
+            return error_handler::ErrorHandler::respond(book.error());
+        }
+        metrics::PhaseTimer serialize_timer(metrics::Phase::SERIALIZE);
+        return formattedResponse(format, BookSerializer::serializeBook(book.value(), format));
         
     } catch (const error_handler::ApiException& e) {
         return error_handler::ErrorHandler::handleError(e);
@@ -88,31 +143,26 @@ crow::response BookController::handleGetBookById(int id) {
 
 crow::response BookController::handleCreateBook(const crow::request& req) {
     try {
-        auto book_data = json::parse(req.body);
-        
-        // Валидация
-        if (!book_data.contains("title") || book_data["title"].is_null()) {
-            return error_handler::ErrorHandler::validationError(
-                "Title is required",
-                "Book title must be provided and cannot be null"
-            );
+        // Разбор и валидация за один проход
+        BookInput input(memory::RequestArena::current().resource());
+        std::optional<InputError> error;
+        {
+            metrics::PhaseTimer parse_timer(metrics::Phase::PARSE);
+            error = BookInputParser::parse(req.body, BookInputParser::Mode::CREATE, input);
         }
-        
-        if (!book_data.contains("author") || book_data["author"].is_null()) {
-            return error_handler::ErrorHandler::validationError(
-                "Author is required", 
-                "Book author must be provided and cannot be null"
-            );
+        if (error) {
+            return inputErrorResponse(*error);
         }
         
-        int book_id = book_service_->createBook(book_data);
+        auto book_id = book_service_->createBook(input);
+        if (!book_id) {
+            return error_handler::ErrorHandler::respond(book_id.error());
+        }
         
         crow::response resp(201);
-        resp.set_header("Location", "/api/books/" + std::to_string(book_id));
+        resp.set_header("Location", "/api/books/" + std::to_string(book_id.value()));
         return resp;
         
-    } catch (const json::parse_error& e) {
-        return error_handler::ErrorHandler::badRequest("Invalid JSON format", e.what());
     } catch (const error_handler::ApiException& e) {
         return error_handler::ErrorHandler::handleError(e);
     } catch (const std::exception& e) {
@@ -124,15 +174,24 @@ crow::response BookController::handleCreateBook(const crow::request& req) {
 
 crow::response BookController::handleUpdateBook(const crow::request& req, int id) {
     try {
-        auto book_data = json::parse(req.body);
-        json updated_book = book_service_->updateBook(id, book_data);
+        auto format = BookSerializer::negotiateFormat(req.get_header_value("Accept"));
+        BookInput input(memory::RequestArena::current().resource());
+        std::optional<InputError> error;
+        {
+            metrics::PhaseTimer parse_timer(metrics::Phase::PARSE);
+            error = BookInputParser::parse(req.body, BookInputParser::Mode::UPDATE, input);
+        }
+        if (error) {
+            return inputErrorResponse(*error);
+        }
+        auto updated_book = book_service_->updateBook(id, input);
+        if (!updated_book) {
+            return error_handler::ErrorHandler::respond(updated_book.error());
+        }
         
-        crow::response resp(updated_book.dump());
-        resp.set_header("Content-Type", "application/json");
-        return resp;
+        metrics::PhaseTimer serialize_timer(metrics::Phase::SERIALIZE);
+        return formattedResponse(format, BookSerializer::serializeBook(updated_book.value(), format));
         
-    } catch (const json::parse_error& e) {
-        return error_handler::ErrorHandler::badRequest("Invalid JSON format", e.what());
     } catch (const error_handler::ApiException& e) {
         return error_handler::ErrorHandler::handleError(e);
     } catch (const std::exception& e) {
@@ -148,9 +207,9 @@ crow::response BookController::handleDeleteBook(int id) {
             return error_handler::ErrorHandler::badRequest("Invalid book ID", "ID must be positive integer");
         }
 
-        bool deleted = book_service_->deleteBook(id);
+        auto deleted = book_service_->deleteBook(id);
         if (!deleted) {
-            return error_handler::ErrorHandler::notFound("Book not found", "Book with ID: " + std::to_string(id) + " does not exist");
+            return error_handler::ErrorHandler::respond(deleted.error());
         }
 
         crow::response resp(204); // No Content
@@ -165,13 +224,13 @@ crow::response BookController::handleDeleteBook(int id) {
     }
 }
 
-crow::response BookController::handleGetStats() {
+crow::response BookController::handleGetStats(const crow::request& req) {
     try {
-        json stats = book_service_->getStats();
+        auto format = BookSerializer::negotiateFormat(req.get_header_value("Accept"));
+        auto stats = book_service_->getStats();
         
-        crow::response resp(stats.dump());
-        resp.set_header("Content-Type", "application/json");
-        return resp;
+        metrics::PhaseTimer serialize_timer(metrics::Phase::SERIALIZE);
+        return formattedResponse(format, BookSerializer::serializeStats(stats, format));
         
     } catch (const error_handler::ApiException& e) {
         return error_handler::ErrorHandler::handleError(e);
@@ -180,4 +239,56 @@ crow::response BookController::handleGetStats() {
     } catch (...) {
         return error_handler::ErrorHandler::handleUnknownException();
     }
-}
\ No newline at end of file
+}
+
+crow::response BookController::handleSearchBooks(const crow::request& req) {
+    try {
+        auto format = BookSerializer::negotiateFormat(req.get_header_value("Accept"));
+
+        SearchQuery query;
+        const char* text = req.url_params.get("q");
+        if (text == nullptr || *text == '\0') {
+            return error_handler::ErrorHandler::validationError("Invalid search query", "Parameter 'q' is required");
+        }
+        if (serializer::utf8Length(text) > kMaxSearchQueryLength) {
+            return error_handler::ErrorHandler::validationError(
+                "Invalid search query",
+                "Parameter 'q' must be at most " + std::to_string(kMaxSearchQueryLength) + " characters");
+        }
+        query.text = text;
+
+        query.limit = kDefaultSearchLimit;
+        if (const char* limit = req.url_params.get("limit")) {
+            const char* end = limit + std::strlen(limit);
+            const auto [ptr, ec] = std::from_chars(limit, end, query.limit);
+            if (ec != std::errc{} || ptr != end || query.limit == 0 || query.limit > kMaxSearchLimit) {
+                return error_handler::ErrorHandler::validationError(
+                    "Invalid search limit",
+                    "Parameter 'limit' must be between 1 and " + std::to_string(kMaxSearchLimit));
+            }
+        }
+
+        if (const char* cursor = req.url_params.get("cursor")) {
+            query.after = BookSerializer::parseSearchCursor(cursor);
+            if (!query.after) {
+                return error_handler::ErrorHandler::badRequest("Invalid search cursor",
+                                                               "Use next_cursor from the previous page");
+            }
+        }
+
+        auto page = book_service_->searchBooks(query);
+        if (!page) {
+            return error_handler::ErrorHandler::respond(page.error());
+        }
+
+        metrics::PhaseTimer serialize_timer(metrics::Phase::SERIALIZE);
+        return formattedResponse(format, BookSerializer::serializeSearchPage(page.value(), format));
+
+    } catch (const error_handler::ApiException& e) {
+        return error_handler::ErrorHandler::handleError(e);
+    } catch (const std::exception& e) {
+        return error_handler::ErrorHandler::handleStdException(e);
+    } catch (...) {
+        return error_handler::ErrorHandler::handleUnknownException();
+    }
+}
@@ -3,22 +3,25 @@
 #include <crow.h>
 #include <memory>
 
+#include "builder/bookshelf_app.h"
+
 class BookService;
 
 class BookController {
 public:
     explicit BookController(std::shared_ptr<BookService> book_service);
     
-    void setupRoutes(crow::SimpleApp& app);
+    void setupRoutes(BookshelfApp& app);
     
 private:
     std::shared_ptr<BookService> book_service_;
     
     // Обработчики запросов
-    crow::response handleGetAllBooks();
-    crow::response handleGetBookById(int id);
+    crow::response handleGetAllBooks(const crow::request& req);
+    crow::response handleGetBookById(const crow::request& req, int id);
     crow::response handleCreateBook(const crow::request& req);
     crow::response handleUpdateBook(const crow::request& req, int id);
     crow::response handleDeleteBook(int id);
-    crow::response handleGetStats();
+    crow::response handleGetStats(const crow::request& req);
+    crow::response handleSearchBooks(const crow::request& req);
 };
\ No newline at end of file
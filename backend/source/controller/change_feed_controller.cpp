@@ -0,0 +1,40 @@
+#include "change_feed_controller.h"
+#include "error_handler.h"
+#include "feed/change_feed.h"
+#include "metrics/metrics_middleware.h"
+
+namespace {
+
+// Через сколько секунд повторить подписку, если ожидающих слишком много
+constexpr unsigned kBusyRetryAfterS = 5;
+
+} // namespace
+
+ChangeFeedController::ChangeFeedController(std::shared_ptr<feed::ChangeFeed> feed)
+    : feed_(std::move(feed)) {}
+
+void ChangeFeedController::setupRoutes(BookshelfApp& app) {
+    // GET /api/books/changes - события create/update/delete с позиции Last-Event-ID
+    CROW_ROUTE(app, "/api/books/changes")
+    .methods("GET"_method)
+    ([this, &app](const crow::request& req, crow::response& res) {
+        // Ответ может завершить поток ленты: маршрут запоминается в контексте запроса
+        metrics::MetricsMiddleware::detach(app.get_context<metrics::MetricsMiddleware>(req),
+                                           metrics::RouteId::BOOK_CHANGES);
+        handleSubscribe(req, res);
+    });
+}
+
+void ChangeFeedController::handleSubscribe(const crow::request& req, crow::response& res) {
+    // EventSource сам шлет Last-Event-ID при переподключении; параметр - для первого запроса
+    std::string last_event_id = req.get_header_value("Last-Event-ID");
+    if (last_event_id.empty()) {
+        if (const char* param = req.url_params.get("last_event_id")) {
+            last_event_id = param;
+        }
+    }
+    if (!feed_->subscribe(last_event_id, res)) {
+        res = error_handler::ErrorHandler::serviceUnavailable("Too many change feed subscribers", kBusyRetryAfterS);
+        res.end();
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <crow.h>
+#include <memory>
+
+#include "builder/bookshelf_app.h"
+
+namespace feed { class ChangeFeed; }
+
+// GET /api/books/changes - лента изменений книг (text/event-stream)
+class ChangeFeedController {
+public:
+    explicit ChangeFeedController(std::shared_ptr<feed::ChangeFeed> feed);
+
+    void setupRoutes(BookshelfApp& app);
+
+private:
+    std::shared_ptr<feed::ChangeFeed> feed_;
+
+    void handleSubscribe(const crow::request& req, crow::response& res);
+};
@@ -0,0 +1,21 @@
+#include "shelf_socket_controller.h"
+#include "feed/shelf_hub.h"
+
+ShelfSocketController::ShelfSocketController(std::shared_ptr<feed::ShelfHub> hub, std::uint64_t max_message_bytes)
+    : hub_(std::move(hub)), max_message_bytes_(max_message_bytes) {}
+
+void ShelfSocketController::setupRoutes(BookshelfApp& app) {
+    // Сообщения длиннее max_message_bytes закрывают соединение (код 1009)
+    CROW_WEBSOCKET_ROUTE(app, "/api/books/ws")
+    .max_payload(max_message_bytes_)
+    .onopen([this](crow::websocket::connection& conn) {
+        hub_->open(conn);
+    })
+    .onmessage([this](crow::websocket::connection& conn, const std::string& data, bool is_binary) {
+        hub_->message(conn, data, is_binary);
+    })
+    // Код закрытия передают не все версии Crow
+    .onclose([this](crow::websocket::connection& conn, const std::string& /*reason*/, auto... /*code*/) {
+        hub_->close(conn);
+    });
+}
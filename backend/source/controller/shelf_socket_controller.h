@@ -0,0 +1,21 @@
+#pragma once
+
+#include <crow.h>
+#include <cstdint>
+#include <memory>
+
+#include "builder/bookshelf_app.h"
+
+namespace feed { class ShelfHub; }
+
+// WebSocket /api/books/ws - подписки на книги по id и статусу (см. feed::ShelfHub)
+class ShelfSocketController {
+public:
+    ShelfSocketController(std::shared_ptr<feed::ShelfHub> hub, std::uint64_t max_message_bytes);
+
+    void setupRoutes(BookshelfApp& app);
+
+private:
+    std::shared_ptr<feed::ShelfHub> hub_;
+    std::uint64_t max_message_bytes_;
+};
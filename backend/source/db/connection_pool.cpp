@@ -0,0 +1,136 @@
+#include "db/connection_pool.h"
+#include "error_handler.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+
+namespace db {
+
+ConnectionPool::ConnectionPool(std::string connection_string, std::size_t size,
+                               std::chrono::milliseconds acquire_timeout, ConnectionInit on_connect)
+    : connection_string_(std::move(connection_string)),
+      size_(size == 0 ? 1 : size),
+      acquire_timeout_(acquire_timeout),
+      on_connect_(std::move(on_connect)) {
+    idle_.reserve(size_);
+}
+
+ConnectionPool::~ConnectionPool() = default;
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), connection_(std::move(other.connection_)) {
+    other.pool_ = nullptr;
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (pool_ != nullptr && connection_) {
+        pool_->release(std::move(connection_));
+    }
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<pqxx::connection> connection;
+    bool open_new = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto ready = [this] { return !idle_.empty() || opened_ < size_; };
+        if (!ready()) {
+            waiting_.fetch_add(1, std::memory_order_relaxed);
+            const bool got = available_.wait_for(lock, acquire_timeout_, ready);
+            waiting_.fetch_sub(1, std::memory_order_relaxed);
+            if (!got) {
+                acquire_timeouts_.fetch_add(1, std::memory_order_relaxed);
+                throw error_handler::DatabaseException(
+                    "Database connection pool exhausted",
+                    "No connection available within " + std::to_string(acquire_timeout_.count()) + " ms"
+                );
+            }
+        }
+
+        if (!idle_.empty()) {
+            connection = std::move(idle_.back());
+            idle_.pop_back();
+        } else {
+            ++opened_;
+            open_new = true;
+        }
+    }
+    acquire_wait_ns_.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+
+    // Разорванное соединение заменяем новым; открытие идет вне блокировки
+    if (connection && !connection->is_open()) {
+        LOG_WARN("Replacing closed database connection");
+        connection.reset();
+        open_new = true;
+    }
+    if (open_new) {
+        try {
+            connection = openConnection();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --opened_;
+            available_.notify_one();
+            throw;
+        }
+    }
+
+    in_use_.fetch_add(1, std::memory_order_relaxed);
+    return Lease(this, std::move(connection));
+}
+
+std::size_t ConnectionPool::warmUp(std::size_t count) {
+    count = std::min(count, size_);
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (opened_ >= count) {
+                return opened_;
+            }
+            ++opened_;
+        }
+        std::unique_ptr<pqxx::connection> connection;
+        try {
+            connection = openConnection();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --opened_;
+            available_.notify_one();
+            throw;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.push_back(std::move(connection));
+        }
+        available_.notify_one();
+    }
+}
+
+std::size_t ConnectionPool::opened() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return opened_;
+}
+
+std::unique_ptr<pqxx::connection> ConnectionPool::openConnection() const {
+    auto connection = std::make_unique<pqxx::connection>(connection_string_);
+    if (on_connect_) {
+        on_connect_(*connection);
+    }
+    return connection;
+}
+
+void ConnectionPool::release(std::unique_ptr<pqxx::connection> connection) {
+    in_use_.fetch_sub(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (connection->is_open()) {
+            idle_.push_back(std::move(connection));
+        } else {
+            --opened_;
+        }
+    }
+    available_.notify_one();
+}
+
+} // namespace db
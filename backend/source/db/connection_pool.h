@@ -0,0 +1,85 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace db {
+
+// Пул соединений с PostgreSQL фиксированного размера.
+// Соединения открываются по мере надобности; если все заняты, acquire() ждет
+// освобождения не дольше acquire_timeout и затем бросает DatabaseException.
+// on_connect вызывается для каждого нового соединения (подготовка операторов)
+class ConnectionPool {
+public:
+    using ConnectionInit = std::function<void(pqxx::connection&)>;
+
+    ConnectionPool(std::string connection_string, std::size_t size,
+                   std::chrono::milliseconds acquire_timeout, ConnectionInit on_connect = {});
+    ~ConnectionPool();
+
+    // Соединение, взятое из пула; возвращается в пул в деструкторе
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease();
+
+        pqxx::connection& operator*() const { return *connection_; }
+        pqxx::connection* operator->() const { return connection_.get(); }
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, std::unique_ptr<pqxx::connection> connection)
+            : pool_(pool), connection_(std::move(connection)) {}
+
+        ConnectionPool* pool_;
+        std::unique_ptr<pqxx::connection> connection_;
+    };
+
+    Lease acquire();
+
+    // Прогрев: открывает соединения, пока их не станет min(count, size).
+    // Возвращает число открытых соединений; ошибка соединения - исключение
+    std::size_t warmUp(std::size_t count);
+
+    // Состояние пула для /metrics
+    std::size_t size() const { return size_; }
+    std::size_t opened() const;
+    std::size_t inUse() const { return in_use_.load(std::memory_order_relaxed); }
+    std::size_t waiting() const { return waiting_.load(std::memory_order_relaxed); }
+    std::uint64_t acquireWaitNs() const { return acquire_wait_ns_.load(std::memory_order_relaxed); }
+    std::uint64_t acquireTimeouts() const { return acquire_timeouts_.load(std::memory_order_relaxed); }
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+private:
+    void release(std::unique_ptr<pqxx::connection> connection);
+    std::unique_ptr<pqxx::connection> openConnection() const;
+
+    const std::string connection_string_;
+    const std::size_t size_;
+    const std::chrono::milliseconds acquire_timeout_;
+    const ConnectionInit on_connect_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<std::unique_ptr<pqxx::connection>> idle_;
+    std::size_t opened_ = 0;            // открыто всего (свободные + выданные)
+
+    std::atomic<std::size_t> in_use_{0};
+    std::atomic<std::size_t> waiting_{0};
+    std::atomic<std::uint64_t> acquire_wait_ns_{0};
+    std::atomic<std::uint64_t> acquire_timeouts_{0};
+};
+
+} // namespace db
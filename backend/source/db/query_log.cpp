@@ -0,0 +1,233 @@
+#include "db/query_log.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace db {
+
+namespace {
+
+// Подстановка значений вместо $N: EXPLAIN ANALYZE нужен конкретный план
+std::string inlineParams(pqxx::work& txn, const std::string& sql,
+                         const std::vector<std::optional<std::string>>& params) {
+    std::string out;
+    out.reserve(sql.size() + 64);
+    for (std::size_t i = 0; i < sql.size(); ++i) {
+        if (sql[i] != '$' || i + 1 >= sql.size() || !std::isdigit(static_cast<unsigned char>(sql[i + 1]))) {
+            out += sql[i];
+            continue;
+        }
+        std::size_t end = i + 1;
+        std::size_t index = 0;
+        while (end < sql.size() && std::isdigit(static_cast<unsigned char>(sql[end]))) {
+            index = index * 10 + static_cast<std::size_t>(sql[end] - '0');
+            ++end;
+        }
+        if (index >= 1 && index <= params.size()) {
+            const auto& value = params[index - 1];
+            out += value.has_value() ? txn.quote(*value) : "NULL";
+        } else {
+            out.append(sql, i, end - i);
+        }
+        i = end - 1;
+    }
+    return out;
+}
+
+// Только чтение: SELECT/WITH без изменяющих данные и блокирующих строки слов.
+// Остальное под EXPLAIN ANALYZE выполнилось бы второй раз со всеми побочными
+// эффектами (значения SERIAL, блокировки, триггеры), которые откат не отменяет
+bool isReadOnly(const std::string& sql) {
+    std::vector<std::string> words;
+    std::string word;
+    for (std::size_t i = 0; i <= sql.size(); ++i) {
+        const unsigned char c = i < sql.size() ? static_cast<unsigned char>(sql[i]) : ' ';
+        if (std::isalnum(c) || c == '_') {
+            word += static_cast<char>(std::toupper(c));
+        } else if (!word.empty()) {
+            words.push_back(std::move(word));
+            word.clear();
+        }
+    }
+    if (words.empty() || (words.front() != "SELECT" && words.front() != "WITH")) {
+        return false;
+    }
+    for (const auto& w : words) {
+        if (w == "INSERT" || w == "UPDATE" || w == "DELETE" || w == "MERGE" || w == "SHARE" ||
+            w == "NEXTVAL" || w == "SETVAL" || w == "INTO") {
+            return false;
+        }
+    }
+    return true;
+}
+
+// В записи лога помещается около 1 КБ: план пишется частями по целым строкам
+constexpr std::size_t kPlanChunkLength = 600;
+
+std::vector<std::string> splitPlan(const pqxx::result& plan) {
+    std::vector<std::string> chunks(1);
+    for (const auto& row : plan) {
+        std::string_view line = row[0].c_str();
+        // Строка длиннее части режется, остальные не разрываются
+        while (!line.empty()) {
+            std::string& chunk = chunks.back();
+            const std::size_t room = kPlanChunkLength - std::min(chunk.size(), kPlanChunkLength);
+            if (!chunk.empty() && line.size() + 1 > room) {
+                chunks.emplace_back();
+                continue;
+            }
+            if (!chunk.empty()) {
+                chunk += '\n';
+            }
+            const std::size_t take = std::min(line.size(), kPlanChunkLength);
+            chunk.append(line.substr(0, take));
+            line.remove_prefix(take);
+            if (!line.empty()) {
+                chunks.emplace_back();
+            }
+        }
+    }
+    return chunks;
+}
+
+} // namespace
+
+QueryLog& QueryLog::instance() {
+    static QueryLog log;
+    return log;
+}
+
+QueryLog::~QueryLog() {
+    stop();
+}
+
+void QueryLog::configure(Settings settings) {
+    threshold_ns_.store(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(settings.threshold).count()),
+        std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    settings_ = std::move(settings);
+    if (settings_.explain && !running_) {
+        running_ = true;
+        worker_ = std::thread([this] { explainLoop(); });
+    }
+}
+
+void QueryLog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        jobs_.clear();
+    }
+    jobs_ready_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void QueryLog::reportSlow(const char* name, const char* sql, std::uint64_t duration_ns,
+                          std::size_t rows, std::size_t affected_rows, std::vector<QueryParam> params) {
+    std::string redacted;
+    for (const auto& param : params) {
+        if (!redacted.empty()) {
+            redacted += ", ";
+        }
+        redacted += param.redacted;
+    }
+
+    LOG_WARN("Slow query", {
+        {"statement", name},
+        {"duration_ms", static_cast<double>(duration_ns) / 1e6},
+        {"rows", rows},
+        {"affected_rows", affected_rows},
+        {"route", metrics::routeLabel(metrics::currentRequest().route)},
+        {"params", redacted}
+    });
+
+    ExplainJob job{name, sql, {}};
+    job.params.reserve(params.size());
+    for (auto& param : params) {
+        job.params.push_back(std::move(param.value));
+    }
+    if (enqueueExplain(std::move(job))) {
+        jobs_ready_.notify_one();
+    }
+}
+
+bool QueryLog::enqueueExplain(ExplainJob job) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!settings_.explain || !running_ || jobs_.size() >= kMaxPendingExplains) {
+        return false;
+    }
+    // План засчитывается только попавшему в очередь заданию
+    unsigned& count = explained_[job.name];
+    if (count >= settings_.explain_first_n) {
+        return false;
+    }
+    ++count;
+    jobs_.push_back(std::move(job));
+    return true;
+}
+
+void QueryLog::explainLoop() {
+    for (;;) {
+        ExplainJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobs_ready_.wait(lock, [this] { return !running_ || !jobs_.empty(); });
+            if (!running_) {
+                break;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        runExplain(job);
+    }
+    explain_connection_.reset();
+}
+
+void QueryLog::runExplain(const ExplainJob& job) {
+    try {
+        if (!explain_connection_ || !explain_connection_->is_open()) {
+            std::string connection_string;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                connection_string = settings_.connection_string;
+            }
+            explain_connection_ = std::make_unique<pqxx::connection>(connection_string);
+        }
+
+        // ANALYZE действительно выполняет запрос: только для чтения, и транзакция
+        // все равно не фиксируется. Для изменяющих запросов - план без выполнения
+        const bool analyze = isReadOnly(job.sql);
+        pqxx::work txn(*explain_connection_);
+        const pqxx::result plan = txn.exec(
+            std::string(analyze ? "EXPLAIN (ANALYZE, BUFFERS) " : "EXPLAIN ") +
+            inlineParams(txn, job.sql, job.params)
+        );
+        txn.abort();
+
+        const std::vector<std::string> chunks = splitPlan(plan);
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            LOG_WARN("Slow query plan", {
+                {"statement", job.name},
+                {"analyze", analyze},
+                {"part", i + 1},
+                {"parts", chunks.size()},
+                {"plan", chunks[i]}
+            });
+        }
+
+    } catch (const std::exception& e) {
+        LOG_ERROR("EXPLAIN failed", {{"statement", job.name}, {"error", e.what()}});
+        explain_connection_.reset();
+    }
+}
+
+} // namespace db
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "metrics/metrics.h"
+
+namespace db {
+
+// Именованный запрос: name - имя подготовленного оператора и метка в метриках,
+// sql нужен для PREPARE и для EXPLAIN в журнале медленных запросов
+struct Statement {
+    const char* name;
+    const char* sql;
+};
+
+// Значение параметра запроса для журнала медленных запросов.
+// value - исходное значение (только для EXPLAIN), redacted - то, что попадает в лог
+struct QueryParam {
+    std::optional<std::string> value;
+    std::string redacted;
+};
+
+inline QueryParam describeParam(int value) {
+    return {std::to_string(value), std::to_string(value)};
+}
+
+inline QueryParam describeParam(bool value) {
+    return {value ? "true" : "false", value ? "true" : "false"};
+}
+
+inline QueryParam describeParam(const std::optional<int>& value) {
+    return value.has_value() ? describeParam(*value) : QueryParam{std::nullopt, "NULL"};
+}
+
+// Текст в лог не пишется: только длина
+inline QueryParam describeParam(const char* value) {
+    if (value == nullptr) {
+        return {std::nullopt, "NULL"};
+    }
+    std::string text(value);
+    std::string redacted = "<text:" + std::to_string(text.size()) + ">";
+    return {std::move(text), std::move(redacted)};
+}
+
+inline QueryParam describeParam(const std::string& value) {
+    return describeParam(value.c_str());
+}
+
+// Журнал медленных запросов. Запросы дольше порога пишутся в лог с именем,
+// замаскированными параметрами, числом строк и маршрутом. Для первых N
+// медленных выполнений каждого запроса в фоне снимается план на отдельном
+// соединении: EXPLAIN (ANALYZE, BUFFERS) для чтения, EXPLAIN для изменений;
+// транзакция с EXPLAIN всегда откатывается. План пишется в лог частями
+class QueryLog {
+public:
+    struct Settings {
+        std::chrono::milliseconds threshold{100};
+        bool explain = false;
+        unsigned explain_first_n = 3;
+        std::string connection_string;    // для отдельного соединения EXPLAIN
+    };
+
+    static QueryLog& instance();
+
+    void configure(Settings settings);
+    void stop();
+
+    std::uint64_t thresholdNs() const { return threshold_ns_.load(std::memory_order_relaxed); }
+
+    void reportSlow(const char* name, const char* sql, std::uint64_t duration_ns,
+                    std::size_t rows, std::size_t affected_rows, std::vector<QueryParam> params);
+
+    QueryLog(const QueryLog&) = delete;
+    QueryLog& operator=(const QueryLog&) = delete;
+
+private:
+    QueryLog() = default;
+    ~QueryLog();
+
+    struct ExplainJob {
+        const char* name = nullptr;
+        std::string sql;
+        std::vector<std::optional<std::string>> params;
+    };
+
+    static constexpr std::size_t kMaxPendingExplains = 16;
+
+    bool enqueueExplain(ExplainJob job);
+    void explainLoop();
+    void runExplain(const ExplainJob& job);
+
+    std::atomic<std::uint64_t> threshold_ns_{100'000'000};
+
+    std::mutex mutex_;
+    Settings settings_;
+    std::unordered_map<std::string, unsigned> explained_;    // имя запроса -> сколько раз снят план
+    std::deque<ExplainJob> jobs_;
+    std::condition_variable jobs_ready_;
+    bool running_ = false;
+    std::thread worker_;
+    std::unique_ptr<pqxx::connection> explain_connection_;   // только в фоновом потоке
+};
+
+// Подготовка оператора на соединении; на сервере он создается сразу, а не при первом запросе
+inline void prepareStatement(pqxx::connection& connection, const Statement& statement) {
+    connection.prepare(statement.name, statement.sql);
+    connection.prepare_now(statement.name);
+}
+
+// Выполнение подготовленного оператора с замером времени (этап QUERY) и записью
+// в журнал медленных запросов. Оператор должен быть подготовлен на соединении
+// (prepareStatement); statement - статический объект
+template <typename Txn, typename... Params>
+pqxx::result timedExec(Txn& txn, const Statement& statement, const Params&... params) {
+    pqxx::result result;
+    std::uint64_t duration_ns;
+    {
+        metrics::QueryTimer timer(statement.name);
+        const auto start = std::chrono::steady_clock::now();
+        result = txn.exec_prepared(statement.name, params...);
+        duration_ns = metrics::elapsedNs(start);
+    }
+
+    if (duration_ns >= QueryLog::instance().thresholdNs()) {
+        QueryLog::instance().reportSlow(statement.name, statement.sql, duration_ns, result.size(),
+                                        static_cast<std::size_t>(result.affected_rows()),
+                                        {describeParam(params)...});
+    }
+    return result;
+}
+
+// commit учитывается в этапе QUERY
+template <typename Txn>
+void timedCommit(Txn& txn) {
+    metrics::PhaseTimer timer(metrics::Phase::QUERY);
+    txn.commit();
+}
+
+} // namespace db
@@ -0,0 +1,31 @@
+#include "debug/admin_guard.h"
+#include "error_handler.h"
+
+namespace debug {
+
+namespace {
+
+// Сравнение за время, не зависящее от позиции первого различия
+bool constantTimeEquals(const std::string& a, const std::string& b) {
+    unsigned char diff = a.size() == b.size() ? 0 : 1;
+    const std::string& other = a.size() == b.size() ? b : a;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        diff |= static_cast<unsigned char>(a[i] ^ other[i]);
+    }
+    return diff == 0;
+}
+
+} // namespace
+
+std::optional<crow::response> checkAdminAccess(const crow::request& req, const std::string& admin_token) {
+    if (admin_token.empty()) {
+        return error_handler::ErrorHandler::notFound("Not found", "Debug endpoints are disabled");
+    }
+    if (!constantTimeEquals(req.get_header_value("X-Admin-Token"), admin_token)) {
+        return crow::response(403, error_handler::ErrorHandler::createErrorResponse(
+            403, "forbidden", "Admin token required"));
+    }
+    return std::nullopt;
+}
+
+} // namespace debug
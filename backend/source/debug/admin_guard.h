@@ -0,0 +1,14 @@
+#pragma once
+
+#include <crow.h>
+#include <optional>
+#include <string>
+
+namespace debug {
+
+// Доступ к /debug/* только по заголовку X-Admin-Token.
+// Пустой токен в конфигурации отключает отладочные эндпоинты целиком.
+// Возвращает ответ с ошибкой или nullopt, если доступ разрешен
+std::optional<crow::response> checkAdminAccess(const crow::request& req, const std::string& admin_token);
+
+} // namespace debug
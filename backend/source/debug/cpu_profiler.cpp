@@ -0,0 +1,161 @@
+#include "debug/cpu_profiler.h"
+#include "debug/symbolizer.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+namespace debug {
+
+namespace {
+
+constexpr int kMaxDepth = 48;
+// Кадры обработчика сигнала и трамплина ядра в начале каждого стека
+constexpr int kSkipFrames = 2;
+
+struct Sample {
+    std::atomic<bool> ready{false};
+    int depth = 0;
+    void* frames[kMaxDepth];
+};
+
+// Состояние, доступное из обработчика сигнала: только атомарные переменные и буфер
+std::atomic<bool> g_active{false};
+std::atomic<int> g_in_handler{0};
+Sample* g_samples = nullptr;
+std::size_t g_capacity = 0;
+std::atomic<std::size_t> g_next{0};
+std::atomic<std::uint64_t> g_dropped{0};
+
+void onProfSignal(int) {
+    g_in_handler.fetch_add(1, std::memory_order_acq_rel);
+    if (g_active.load(std::memory_order_acquire)) {
+        const int saved_errno = errno;
+        const std::size_t idx = g_next.fetch_add(1, std::memory_order_relaxed);
+        if (idx < g_capacity) {
+            Sample& sample = g_samples[idx];
+            sample.depth = backtrace(sample.frames, kMaxDepth);
+            sample.ready.store(true, std::memory_order_release);
+        } else {
+            g_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        errno = saved_errno;
+    }
+    g_in_handler.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void setTimer(int frequency_hz) {
+    itimerval timer{};
+    if (frequency_hz > 0) {
+        timer.it_interval.tv_sec = 0;
+        timer.it_interval.tv_usec = 1000000 / frequency_hz;
+        timer.it_value = timer.it_interval;
+    }
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+} // namespace
+
+CpuProfiler& CpuProfiler::instance() {
+    static CpuProfiler profiler;
+    return profiler;
+}
+
+std::optional<std::string> CpuProfiler::profile(std::chrono::seconds duration, int frequency_hz) {
+    if (busy_.exchange(true)) {
+        return std::nullopt;
+    }
+
+    duration = std::clamp(duration, std::chrono::seconds(1), std::chrono::seconds(kMaxSeconds));
+    frequency_hz = std::clamp(frequency_hz, 1, kMaxFrequencyHz);
+
+    // Буфер на весь сеанс: частота * длительность * число ядер, но не больше 64К сэмплов
+    const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t capacity = std::min<std::size_t>(
+        static_cast<std::size_t>(frequency_hz) * static_cast<std::size_t>(duration.count()) * cores, 64 * 1024);
+    std::unique_ptr<Sample[]> samples(new Sample[capacity]);
+
+    // Первый вызов backtrace загружает libgcc и выделяет память - делаем его вне обработчика
+    std::call_once(handler_installed_, [] {
+        void* warmup[1];
+        backtrace(warmup, 1);
+
+        struct sigaction action {};
+        action.sa_handler = onProfSignal;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGPROF, &action, nullptr);
+    });
+
+    g_samples = samples.get();
+    g_capacity = capacity;
+    g_next.store(0, std::memory_order_relaxed);
+    g_dropped.store(0, std::memory_order_relaxed);
+    g_active.store(true, std::memory_order_release);
+
+    LOG_INFO("CPU profiling started", {{"seconds", static_cast<long long>(duration.count())}, {"frequency_hz", frequency_hz}});
+    setTimer(frequency_hz);
+    std::this_thread::sleep_for(duration);
+    setTimer(0);
+
+    // Обработчик остается установленным (сигнал мог уже прийти), но больше ничего не пишет
+    g_active.store(false, std::memory_order_release);
+    while (g_in_handler.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+
+    const std::size_t taken = std::min(g_next.load(std::memory_order_relaxed), capacity);
+    const std::uint64_t dropped = g_dropped.load(std::memory_order_relaxed);
+    g_samples = nullptr;
+    g_capacity = 0;
+
+    // Свертка стеков: корень слева, лист справа
+    std::unordered_map<void*, std::string> symbols;
+    std::unordered_map<std::string, std::uint64_t> folded;
+    for (std::size_t i = 0; i < taken; ++i) {
+        const Sample& sample = samples[i];
+        if (!sample.ready.load(std::memory_order_acquire) || sample.depth <= kSkipFrames) {
+            continue;
+        }
+        std::string stack;
+        for (int f = sample.depth - 1; f >= kSkipFrames; --f) {
+            // Адреса возврата указывают на инструкцию после call; сам прерванный кадр - точный
+            void* address = f == kSkipFrames ? sample.frames[f] : static_cast<char*>(sample.frames[f]) - 1;
+            auto it = symbols.find(address);
+            if (it == symbols.end()) {
+                it = symbols.emplace(address, symbolize(address)).first;
+            }
+            if (!stack.empty()) {
+                stack += ';';
+            }
+            stack += it->second;
+        }
+        ++folded[stack];
+    }
+
+    std::vector<std::pair<std::string, std::uint64_t>> sorted(folded.begin(), folded.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    std::string out;
+    for (const auto& [stack, count] : sorted) {
+        out += stack;
+        out += ' ';
+        out += std::to_string(count);
+        out += '\n';
+    }
+
+    LOG_INFO("CPU profiling finished", {{"samples", taken}, {"dropped", dropped}, {"stacks", sorted.size()}});
+    busy_.store(false);
+    return out;
+}
+
+} // namespace debug
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace debug {
+
+// Сэмплирующий профилировщик CPU на SIGPROF (setitimer ITIMER_PROF).
+// Таймер считает процессорное время всего процесса, сигнал получает поток,
+// который в этот момент работает, поэтому в профиль попадают все потоки Crow.
+// Стеки пишутся обработчиком сигнала в заранее выделенный буфер;
+// вне сеанса профилирования обработчик не установлен или сразу возвращается
+class CpuProfiler {
+public:
+    static constexpr int kMaxSeconds = 60;
+    static constexpr int kMaxFrequencyHz = 1000;
+
+    static CpuProfiler& instance();
+
+    // Профилирует duration и возвращает стеки в формате folded
+    // (строка "корень;...;лист count", вход для flamegraph.pl / speedscope).
+    // Блокирует вызывающий поток. nullopt - профилирование уже идет
+    std::optional<std::string> profile(std::chrono::seconds duration, int frequency_hz);
+
+    CpuProfiler(const CpuProfiler&) = delete;
+    CpuProfiler& operator=(const CpuProfiler&) = delete;
+
+private:
+    CpuProfiler() = default;
+
+    std::atomic<bool> busy_{false};
+    std::once_flag handler_installed_;
+};
+
+} // namespace debug
@@ -0,0 +1,266 @@
+#include "debug/heap_profiler.h"
+#include "debug/symbolizer.h"
+#include "serializer/json_writer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+
+#include <execinfo.h>
+
+namespace debug {
+
+namespace {
+
+constexpr int kMaxDepth = 32;
+// Кадры sampleAllocation и onAllocate в начале стека
+constexpr int kSkipFrames = 2;
+constexpr std::size_t kStripeCount = 16;
+
+struct Site {
+    std::vector<void*> frames;          // от места выделения к корню
+    std::uint64_t live_bytes = 0;
+    std::uint64_t live_objects = 0;
+    std::uint64_t allocated_bytes = 0;
+    std::uint64_t allocated_objects = 0;
+};
+
+struct LiveSample {
+    std::uint64_t site;
+    std::uint64_t bytes;
+    std::uint64_t objects;
+};
+
+struct Stripe {
+    std::mutex mutex;
+    std::unordered_map<void*, LiveSample> live;
+};
+
+// Создается в enable() и намеренно не уничтожается: delete может прийти
+// из деструкторов статических объектов после выхода из main
+struct State {
+    std::size_t interval = 0;
+    std::mutex sites_mutex;
+    std::unordered_map<std::uint64_t, Site> sites;
+    Stripe stripes[kStripeCount];
+};
+
+std::atomic<State*> g_state{nullptr};
+std::atomic<std::size_t> g_live_samples{0};
+
+// Только тривиально инициализируемые thread_local: хук вызывается из operator new
+thread_local bool tls_in_profiler = false;
+thread_local std::int64_t tls_bytes_until_sample = 0;
+thread_local std::uint64_t tls_rng = 0;
+
+Stripe& stripeFor(State& state, void* ptr) {
+    return state.stripes[(reinterpret_cast<std::uintptr_t>(ptr) >> 4) % kStripeCount];
+}
+
+// Экспоненциальный интервал до следующего сэмпла со средним interval
+std::int64_t nextSampleDistance(std::size_t interval) {
+    if (tls_rng == 0) {
+        tls_rng = reinterpret_cast<std::uintptr_t>(&tls_rng) | 1;
+    }
+    tls_rng ^= tls_rng << 13;
+    tls_rng ^= tls_rng >> 7;
+    tls_rng ^= tls_rng << 17;
+    const double u = (static_cast<double>(tls_rng >> 11) + 1.0) / 9007199254740993.0;
+    return static_cast<std::int64_t>(-std::log(u) * static_cast<double>(interval)) + 1;
+}
+
+__attribute__((noinline)) void sampleAllocation(State& state, void* ptr, std::size_t size) {
+    const bool first = tls_rng == 0;
+    tls_bytes_until_sample = nextSampleDistance(state.interval);
+    if (first) {
+        // Первое выделение потока только запускает отсчет
+        return;
+    }
+
+    void* frames[kMaxDepth];
+    const int depth = backtrace(frames, kMaxDepth);
+
+    std::uint64_t hash = 1469598103934665603ULL;
+    for (int i = kSkipFrames; i < depth; ++i) {
+        hash = (hash ^ reinterpret_cast<std::uintptr_t>(frames[i])) * 1099511628211ULL;
+    }
+
+    // Вес сэмпла: сколько байт и объектов он представляет
+    const std::uint64_t bytes = std::max<std::uint64_t>(size, state.interval);
+    const std::uint64_t objects = size >= state.interval ? 1 : std::max<std::uint64_t>(1, state.interval / std::max<std::size_t>(size, 1));
+
+    {
+        std::lock_guard<std::mutex> lock(state.sites_mutex);
+        Site& site = state.sites[hash];
+        if (site.frames.empty() && depth > kSkipFrames) {
+            site.frames.assign(frames + kSkipFrames, frames + depth);
+        }
+        site.live_bytes += bytes;
+        site.live_objects += objects;
+        site.allocated_bytes += bytes;
+        site.allocated_objects += objects;
+    }
+    {
+        Stripe& stripe = stripeFor(state, ptr);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.live[ptr] = {hash, bytes, objects};
+    }
+    g_live_samples.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+void HeapProfiler::enable(std::size_t sample_interval_bytes) {
+    if (g_state.load() != nullptr) {
+        return;
+    }
+    // Первый backtrace загружает libgcc и выделяет память
+    void* warmup[1];
+    backtrace(warmup, 1);
+
+    auto* state = new State;
+    state->interval = std::max<std::size_t>(sample_interval_bytes, 1024);
+    g_state.store(state, std::memory_order_release);
+}
+
+bool HeapProfiler::enabled() {
+    return g_state.load(std::memory_order_relaxed) != nullptr;
+}
+
+__attribute__((noinline)) void HeapProfiler::onAllocate(void* ptr, std::size_t size) {
+    State* state = g_state.load(std::memory_order_acquire);
+    if (state == nullptr || ptr == nullptr || tls_in_profiler) {
+        return;
+    }
+    tls_bytes_until_sample -= static_cast<std::int64_t>(size);
+    if (tls_bytes_until_sample > 0) {
+        return;
+    }
+    tls_in_profiler = true;
+    sampleAllocation(*state, ptr, size);
+    tls_in_profiler = false;
+}
+
+void HeapProfiler::onFree(void* ptr) {
+    if (g_live_samples.load(std::memory_order_relaxed) == 0 || ptr == nullptr || tls_in_profiler) {
+        return;
+    }
+    State* state = g_state.load(std::memory_order_acquire);
+    if (state == nullptr) {
+        return;
+    }
+
+    tls_in_profiler = true;
+    LiveSample sample{};
+    bool found = false;
+    {
+        Stripe& stripe = stripeFor(*state, ptr);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.live.find(ptr);
+        if (it != stripe.live.end()) {
+            sample = it->second;
+            stripe.live.erase(it);
+            found = true;
+        }
+    }
+    if (found) {
+        g_live_samples.fetch_sub(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(state->sites_mutex);
+        auto it = state->sites.find(sample.site);
+        if (it != state->sites.end()) {
+            it->second.live_bytes -= sample.bytes;
+            it->second.live_objects -= sample.objects;
+        }
+    }
+    tls_in_profiler = false;
+}
+
+std::string HeapProfiler::reportJson(const std::vector<metrics::RouteAllocationStats>& routes,
+                                     std::size_t max_sites) {
+    State* state = g_state.load(std::memory_order_acquire);
+
+    // Копия под блокировкой; выделения внутри не сэмплируются (иначе взаимоблокировка)
+    std::vector<Site> sites;
+    if (state != nullptr) {
+        tls_in_profiler = true;
+        {
+            std::lock_guard<std::mutex> lock(state->sites_mutex);
+            sites.reserve(state->sites.size());
+            for (const auto& [hash, site] : state->sites) {
+                sites.push_back(site);
+            }
+        }
+        tls_in_profiler = false;
+    }
+
+    std::sort(sites.begin(), sites.end(), [](const Site& a, const Site& b) {
+        return a.live_bytes > b.live_bytes;
+    });
+    if (sites.size() > max_sites) {
+        sites.resize(max_sites);
+    }
+
+    std::uint64_t live_total = 0;
+    for (const auto& site : sites) {
+        live_total += site.live_bytes;
+    }
+
+    std::string out;
+    serializer::JsonWriter writer(out);
+    writer.beginObject(0);
+    writer.key("enabled");
+    writer.boolean(state != nullptr);
+    writer.key("sample_interval_bytes");
+    writer.integer(state != nullptr ? static_cast<std::int64_t>(state->interval) : 0);
+    writer.key("live_bytes_estimate");
+    writer.integer(static_cast<std::int64_t>(live_total));
+
+    writer.key("sites");
+    writer.beginArray(sites.size());
+    for (const auto& site : sites) {
+        writer.beginObject(0);
+        writer.key("live_bytes");
+        writer.integer(static_cast<std::int64_t>(site.live_bytes));
+        writer.key("live_objects");
+        writer.integer(static_cast<std::int64_t>(site.live_objects));
+        writer.key("allocated_bytes");
+        writer.integer(static_cast<std::int64_t>(site.allocated_bytes));
+        writer.key("allocated_objects");
+        writer.integer(static_cast<std::int64_t>(site.allocated_objects));
+        writer.key("stack");
+        writer.beginArray(site.frames.size());
+        for (std::size_t i = 0; i < site.frames.size(); ++i) {
+            // Адреса возврата указывают на инструкцию после call
+            writer.string(symbolize(static_cast<char*>(site.frames[i]) - 1));
+        }
+        writer.endArray();
+        writer.endObject();
+    }
+    writer.endArray();
+
+    writer.key("routes");
+    writer.beginArray(routes.size());
+    for (const auto& route : routes) {
+        writer.beginObject(0);
+        writer.key("route");
+        writer.string(route.route);
+        writer.key("requests");
+        writer.integer(static_cast<std::int64_t>(route.requests));
+        writer.key("allocations");
+        writer.integer(static_cast<std::int64_t>(route.allocations));
+        writer.key("allocated_bytes");
+        writer.integer(static_cast<std::int64_t>(route.allocated_bytes));
+        writer.key("allocations_per_request");
+        writer.real(route.requests > 0 ? static_cast<double>(route.allocations) / static_cast<double>(route.requests) : 0.0);
+        writer.key("bytes_per_request");
+        writer.real(route.requests > 0 ? static_cast<double>(route.allocated_bytes) / static_cast<double>(route.requests) : 0.0);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+    return out;
+}
+
+} // namespace debug
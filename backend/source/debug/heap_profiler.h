@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "metrics/metrics.h"
+
+namespace debug {
+
+// Сэмплирующий профилировщик кучи. Подключен к замененным operator new/delete
+// (memory/request_arena.cpp): в среднем раз на sample_interval выделенных байт
+// снимается стек, сэмпл живет до освобождения указателя. Оценка живых байт по месту
+// выделения - сумма весов живых сэмплов (как в tcmalloc heap profiler).
+// Выключен по умолчанию; в выключенном состоянии хук - одна проверка флага
+class HeapProfiler {
+public:
+    static void enable(std::size_t sample_interval_bytes);
+    static bool enabled();
+
+    // Хуки operator new/delete
+    static void onAllocate(void* ptr, std::size_t size);
+    static void onFree(void* ptr);
+
+    // JSON для /debug/heap: места выделения по живым байтам и выделения по маршрутам
+    static std::string reportJson(const std::vector<metrics::RouteAllocationStats>& routes,
+                                  std::size_t max_sites);
+};
+
+} // namespace debug
@@ -0,0 +1,40 @@
+#include "debug/symbolizer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+
+namespace debug {
+
+std::string symbolize(void* address) {
+    Dl_info info{};
+    if (dladdr(address, &info) == 0) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%p", address);
+        return buf;
+    }
+
+    std::string name;
+    if (info.dli_sname != nullptr) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        name = status == 0 && demangled != nullptr ? demangled : info.dli_sname;
+        std::free(demangled);
+    } else {
+        const char* module = info.dli_fname != nullptr ? std::strrchr(info.dli_fname, '/') : nullptr;
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "+0x%zx",
+                      static_cast<std::size_t>(static_cast<char*>(address) - static_cast<char*>(info.dli_fbase)));
+        name = std::string(module != nullptr ? module + 1 : "?") + buf;
+    }
+
+    // ';' разделяет кадры в формате folded
+    std::replace(name.begin(), name.end(), ';', ':');
+    return name;
+}
+
+} // namespace debug
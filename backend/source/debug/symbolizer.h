@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+namespace debug {
+
+// Имя функции по адресу кода (с demangle); для символов без экспорта -
+// "модуль+0xсмещение". Символ ';' заменяется на ':' (разделитель в folded stacks)
+std::string symbolize(void* address);
+
+} // namespace debug
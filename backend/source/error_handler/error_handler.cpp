@@ -1,107 +1,146 @@
 #include "error_handler.h"
-#include <iostream>
+#include "serializer/json_writer.h"
+#include "logger/logger.h"
+
 #include <ctime>
 
 namespace error_handler {
 
-crow::response ErrorHandler::handleError(const ApiException& e) {
-    const auto& details = e.getDetails();
-    
-    std::cerr << "API Error [" << ErrorHandler::errorTypeToString(details.type) << "]: " 
-              << details.message << " | Details: " << details.details << std::endl;
-    
-    auto response = ErrorHandler::createErrorResponse(
-        details.status_code,
-        ErrorHandler::errorTypeToString(details.type),
-        details.message,
-        details.details
-    );
-    
-    crow::response resp(details.status_code, response.dump());
+crow::response ErrorHandler::respond(const ErrorDetails& error) {
+    // 4xx - ожидаемые исходы (не найдено, неверные данные), в лог пишем только сбои сервиса
+    if (error.status_code >= 500) {
+        LOG_ERROR("API error", {
+            {"type", ErrorHandler::errorTypeToString(error.type)},
+            {"message", error.message},
+            {"details", error.details},
+            {"status_code", error.status_code}
+        });
+    }
+
+    crow::response resp(error.status_code, ErrorHandler::createErrorResponse(
+        error.status_code,
+        ErrorHandler::errorTypeToString(error.type),
+        error.message,
+        error.details
+    ));
     resp.set_header("Content-Type", "application/json");
     return resp;
 }
 
+crow::response ErrorHandler::handleError(const ApiException& e) {
+    return ErrorHandler::respond(e.getDetails());
+}
+
 crow::response ErrorHandler::handleStdException(const std::exception& e) {
-    std::cerr << "Standard exception: " << e.what() << std::endl;
+    LOG_ERROR("Standard exception", {{"error", e.what()}});
     
-    auto response = ErrorHandler::createErrorResponse(
+    crow::response resp(500, ErrorHandler::createErrorResponse(
         500,
         "internal_server_error",
         "Internal server error occurred",
         e.what()
-    );
-    
-    crow::response resp(500, response.dump());
+    ));
     resp.set_header("Content-Type", "application/json");
     return resp;
 }
 
 crow::response ErrorHandler::handleUnknownException() {
-    std::cerr << "Unknown exception occurred" << std::endl;
+    LOG_ERROR("Unknown exception occurred");
     
-    auto response = ErrorHandler::createErrorResponse(
+    crow::response resp(500, ErrorHandler::createErrorResponse(
         500,
         "unknown_error",
         "Unknown internal server error occurred"
-    );
-    
-    crow::response resp(500, response.dump());
+    ));
     resp.set_header("Content-Type", "application/json");
     return resp;
 }
 
 crow::response ErrorHandler::badRequest(const std::string& message, const std::string& details) {
-    BadRequestException ex(message, details);
-    return ErrorHandler::handleError(ex);
+    return ErrorHandler::respond({ErrorType::BAD_REQUEST_ERROR, message, details, 400});
 }
 
 crow::response ErrorHandler::notFound(const std::string& message, const std::string& details) {
-    NotFoundException ex(message, details);
-    return ErrorHandler::handleError(ex);
+    return ErrorHandler::respond(notFoundError(message, details));
 }
 
 crow::response ErrorHandler::internalError(const std::string& message, const std::string& details) {
-    ApiException ex(ErrorDetails{ErrorType::INTERNAL_SERVER_ERROR, message, details, 500});
-    return ErrorHandler::handleError(ex);
+    return ErrorHandler::respond({ErrorType::INTERNAL_SERVER_ERROR, message, details, 500});
 }
 
 crow::response ErrorHandler::validationError(const std::string& message, const std::string& details) {
-    ValidationException ex(message, details);
-    return ErrorHandler::handleError(ex);
+    return ErrorHandler::respond(error_handler::validationError(message, details));
 }
 
 crow::response ErrorHandler::databaseError(const std::string& message, const std::string& details) {
-    DatabaseException ex(message, details);
-    return ErrorHandler::handleError(ex);
+    return ErrorHandler::respond({ErrorType::DATABASE_ERROR, message, details, 500});
+}
+
+crow::response ErrorHandler::conflict(const std::string& message, const std::string& details) {
+    return ErrorHandler::respond(conflictError(message, details));
 }
 
-std::string ErrorHandler::errorTypeToString(ErrorType type) {
+crow::response ErrorHandler::payloadTooLarge(std::size_t body_bytes, std::size_t limit_bytes) {
+    crow::response resp(413, ErrorHandler::createErrorResponse(
+        413,
+        "payload_too_large",
+        "Request body is too large",
+        std::to_string(body_bytes) + " bytes, limit " + std::to_string(limit_bytes)
+    ));
+    resp.set_header("Content-Type", "application/json");
+    return resp;
+}
+
+crow::response ErrorHandler::serviceUnavailable(const std::string& message, unsigned retry_after_s) {
+    crow::response resp(503, ErrorHandler::createErrorResponse(
+        503,
+        "service_unavailable",
+        message,
+        "Retry after " + std::to_string(retry_after_s) + " s"
+    ));
+    resp.set_header("Content-Type", "application/json");
+    resp.set_header("Retry-After", std::to_string(retry_after_s));
+    return resp;
+}
+
+const char* ErrorHandler::errorTypeToString(ErrorType type) {
     switch (type) {
         case ErrorType::DATABASE_ERROR: return "database_error";
         case ErrorType::VALIDATION_ERROR: return "validation_error";
         case ErrorType::NOT_FOUND_ERROR: return "not_found_error";
         case ErrorType::BAD_REQUEST_ERROR: return "bad_request_error";
+        case ErrorType::CONFLICT_ERROR: return "conflict_error";
+        case ErrorType::NOT_IMPLEMENTED_ERROR: return "not_implemented_error";
         case ErrorType::INTERNAL_SERVER_ERROR: return "internal_server_error";
         default: return "unknown_error";
     }
 }
 
-json ErrorHandler::createErrorResponse(int status_code, const std::string& error, 
-                                     const std::string& message, const std::string& details) {
-    json response;
-    response["status"] = "error";
-    response["error"] = error;
-    response["message"] = message;
-    
+std::string ErrorHandler::createErrorResponse(int status_code, const char* error,
+                                              const std::string& message, const std::string& details) {
+    // Один буфер под весь ответ: без DOM и без перевыделений
+    std::string body;
+    body.reserve(128 + message.size() + details.size());
+
+    serializer::JsonWriter writer(body);
+    writer.beginObject(details.empty() ? 5 : 6);
+    writer.key("status");
+    writer.string("error");
+    writer.key("error");
+    writer.string(error);
+    writer.key("message");
+    writer.string(message);
     if (!details.empty()) {
-        response["details"] = details;
+        writer.key("details");
+        writer.string(details);
     }
-    
-    response["status_code"] = status_code;
-    response["timestamp"] = std::to_string(std::time(nullptr));
-    
-    return response;
+    writer.key("status_code");
+    writer.integer(status_code);
+    writer.key("timestamp");
+    writer.string(std::to_string(std::time(nullptr)));
+    writer.endObject();
+
+    return body;
 }
 
-} // namespace error_handler
\ No newline at end of file
+} // namespace error_handler
@@ -2,29 +2,11 @@
 #include <string>
 #include <stdexcept>
 #include <crow.h>
-#include <nlohmann/json.hpp>
 
-using json = nlohmann::json;
+#include "result.h"
 
 namespace error_handler {
 
-// Типы ошибок
-enum class ErrorType {
-    DATABASE_ERROR,
-    VALIDATION_ERROR,
-    NOT_FOUND_ERROR,
-    BAD_REQUEST_ERROR,
-    INTERNAL_SERVER_ERROR
-};
-
-// Структура для деталей ошибки
-struct ErrorDetails {
-    ErrorType type;
-    std::string message;
-    std::string details;
-    int status_code;
-};
-
 // Базовый класс для пользовательских исключений
 class ApiException : public std::runtime_error {
 public:
@@ -63,9 +45,18 @@ public:
         : ApiException({ErrorType::BAD_REQUEST_ERROR, message, details, 400}) {}
 };
 
+class ConflictException : public ApiException {
+public:
+    explicit ConflictException(const std::string& message, const std::string& details = "")
+        : ApiException(conflictError(message, details)) {}
+};
+
 // Класс ErrorHandler
 class ErrorHandler {
 public:
+    // Ответ для ошибки, возвращенной как значение (Result)
+    static crow::response respond(const ErrorDetails& error);
+
     // Основные методы обработки ошибок
     static crow::response handleError(const ApiException& e);
     static crow::response handleStdException(const std::exception& e);
@@ -77,12 +68,18 @@ public:
     static crow::response internalError(const std::string& message, const std::string& details = "");
     static crow::response validationError(const std::string& message, const std::string& details = "");
     static crow::response databaseError(const std::string& message, const std::string& details = "");
+    static crow::response conflict(const std::string& message, const std::string& details = "");
+    static crow::response payloadTooLarge(std::size_t body_bytes, std::size_t limit_bytes);
+    // 503 с Retry-After: временная перегрузка, клиенту стоит повторить позже
+    static crow::response serviceUnavailable(const std::string& message, unsigned retry_after_s);
+
+    // Тело ответа с ошибкой (JSON пишется напрямую в строку)
+    static std::string createErrorResponse(int status_code, const char* error,
+                                           const std::string& message, const std::string& details = "");
 
 private:
     // Внутренние вспомогательные методы
-    static std::string errorTypeToString(ErrorType type);
-    static json createErrorResponse(int status_code, const std::string& error, 
-                                  const std::string& message, const std::string& details = "");
+    static const char* errorTypeToString(ErrorType type);
 };
 
 } // namespace error_handler
\ No newline at end of file
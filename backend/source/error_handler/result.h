@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace error_handler {
+
+// Типы ошибок
+enum class ErrorType {
+    DATABASE_ERROR,
+    VALIDATION_ERROR,
+    NOT_FOUND_ERROR,
+    BAD_REQUEST_ERROR,
+    CONFLICT_ERROR,
+    NOT_IMPLEMENTED_ERROR,
+    INTERNAL_SERVER_ERROR
+};
+
+// Структура для деталей ошибки
+struct ErrorDetails {
+    ErrorType type;
+    std::string message;
+    std::string details;
+    int status_code;
+};
+
+// Ожидаемые исходы (не найдено, неверные данные, конфликт) возвращаются
+// как значение, без исключений
+inline ErrorDetails notFoundError(std::string message, std::string details = "") {
+    return {ErrorType::NOT_FOUND_ERROR, std::move(message), std::move(details), 404};
+}
+
+inline ErrorDetails validationError(std::string message, std::string details = "") {
+    return {ErrorType::VALIDATION_ERROR, std::move(message), std::move(details), 400};
+}
+
+inline ErrorDetails conflictError(std::string message, std::string details = "") {
+    return {ErrorType::CONFLICT_ERROR, std::move(message), std::move(details), 409};
+}
+
+inline ErrorDetails notImplementedError(std::string message, std::string details = "") {
+    return {ErrorType::NOT_IMPLEMENTED_ERROR, std::move(message), std::move(details), 501};
+}
+
+// Результат операции сервиса: значение или описание ожидаемой ошибки
+template <typename T>
+class Result {
+public:
+    Result(T value) : data_(std::in_place_index<0>, std::move(value)) {}
+    Result(ErrorDetails error) : data_(std::in_place_index<1>, std::move(error)) {}
+
+    bool ok() const { return data_.index() == 0; }
+    explicit operator bool() const { return ok(); }
+
+    T& value() { return std::get<0>(data_); }
+    const T& value() const { return std::get<0>(data_); }
+    const ErrorDetails& error() const { return std::get<1>(data_); }
+
+private:
+    std::variant<T, ErrorDetails> data_;
+};
+
+template <>
+class Result<void> {
+public:
+    Result() = default;
+    Result(ErrorDetails error) : error_(std::move(error)), ok_(false) {}
+
+    bool ok() const { return ok_; }
+    explicit operator bool() const { return ok_; }
+
+    const ErrorDetails& error() const { return error_; }
+
+private:
+    ErrorDetails error_{};
+    bool ok_ = true;
+};
+
+} // namespace error_handler
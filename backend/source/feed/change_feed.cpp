@@ -0,0 +1,301 @@
+#include "feed/change_feed.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace feed {
+
+namespace {
+
+std::uint32_t randomEpoch() {
+    std::random_device device;
+    return static_cast<std::uint32_t>(device());
+}
+
+} // namespace
+
+const char* opName(ChangeOp op) {
+    switch (op) {
+        case ChangeOp::CREATE: return "create";
+        case ChangeOp::UPDATE: return "update";
+        case ChangeOp::DELETE: return "delete";
+    }
+    return "update";
+}
+
+std::optional<ChangeOp> opFromString(std::string_view name) {
+    if (name == "create" || name == "insert") {
+        return ChangeOp::CREATE;
+    }
+    if (name == "update") {
+        return ChangeOp::UPDATE;
+    }
+    if (name == "delete") {
+        return ChangeOp::DELETE;
+    }
+    return std::nullopt;
+}
+
+ChangeFeed::ChangeFeed(Settings settings)
+    : settings_(std::move(settings)), epoch_(randomEpoch()) {
+    worker_ = std::thread([this] { loop(); });
+}
+
+ChangeFeed::~ChangeFeed() {
+    stop();
+}
+
+void ChangeFeed::publish(ChangeOp op, int id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        const bool first = pending_.empty();
+        auto [it, inserted] = pending_.try_emplace(id, op);
+        if (!inserted) {
+            // Созданная и сразу измененная книга для клиента - новая
+            it->second = it->second == ChangeOp::CREATE && op == ChangeOp::UPDATE ? ChangeOp::CREATE : op;
+        }
+        if (!first) {
+            return;
+        }
+        flush_at_ = std::chrono::steady_clock::now() + settings_.coalesce;
+    }
+    wake_.notify_one();
+}
+
+void ChangeFeed::addListener(Listener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listeners_.push_back(std::move(listener));
+}
+
+void ChangeFeed::notifyListeners(const std::vector<Change>& changes, bool reset) const {
+    for (const auto& listener : listeners_) {
+        listener(changes, reset);
+    }
+}
+
+void ChangeFeed::resync() {
+    std::vector<Completion> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        epoch_ = randomEpoch();
+        ring_.clear();
+        for (const auto& subscriber : subscribers_) {
+            done.push_back({subscriber.response, renderReset()});
+        }
+        subscribers_.clear();
+    }
+    resets_.fetch_add(done.size(), std::memory_order_relaxed);
+    notifyListeners({}, true);
+    for (auto& completion : done) {
+        complete(*completion.response, std::move(completion.body));
+    }
+}
+
+bool ChangeFeed::subscribe(const std::string& last_event_id, crow::response& res) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!running_) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const auto cursor = parseCursor(last_event_id);
+    if (!cursor || *cursor < head_) {
+        std::string body = cursor ? renderBatch(*cursor) : renderReset();
+        lock.unlock();
+        if (!cursor) {
+            resets_.fetch_add(1, std::memory_order_relaxed);
+        }
+        complete(res, std::move(body));
+        return true;
+    }
+    if (subscribers_.size() >= settings_.max_subscribers) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const bool first = subscribers_.empty();
+    subscribers_.push_back({&res, *cursor, std::chrono::steady_clock::now() + settings_.hold});
+    lock.unlock();
+    if (first) {
+        wake_.notify_one();
+    }
+    return true;
+}
+
+void ChangeFeed::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        // Соединения ожидающих закрывает сам сервер при остановке
+        subscribers_.clear();
+    }
+    wake_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+std::size_t ChangeFeed::subscribers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.size();
+}
+
+void ChangeFeed::loop() {
+    std::vector<Change> flushed;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        auto wake_at = std::chrono::steady_clock::time_point::max();
+        if (!pending_.empty()) {
+            wake_at = flush_at_;
+        }
+        if (!subscribers_.empty()) {
+            wake_at = std::min(wake_at, subscribers_.front().deadline);
+        }
+        if (wake_at == std::chrono::steady_clock::time_point::max()) {
+            wake_.wait(lock);
+        } else {
+            wake_.wait_until(lock, wake_at);
+        }
+        if (!running_) {
+            break;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        flushed.clear();
+        if (!pending_.empty() && now >= flush_at_) {
+            flushPending(flushed);
+        }
+
+        // Все, кто ждал с одной позиции, получают один и тот же текст
+        std::vector<Completion> done;
+        std::unordered_map<std::uint64_t, std::string> rendered;
+        auto keep = std::remove_if(subscribers_.begin(), subscribers_.end(), [&](const Subscriber& subscriber) {
+            if (subscriber.cursor >= head_ && subscriber.deadline > now) {
+                return false;
+            }
+            // Большая пачка могла вытеснить из кольца позицию ожидающего
+            const bool lost = !ring_.empty() && subscriber.cursor + 1 < ring_.front().seq;
+            const std::uint64_t key = lost ? UINT64_MAX : subscriber.cursor;
+            auto it = rendered.find(key);
+            if (it == rendered.end()) {
+                it = rendered.emplace(key, lost ? renderReset() : renderBatch(subscriber.cursor)).first;
+            }
+            if (lost) {
+                resets_.fetch_add(1, std::memory_order_relaxed);
+            }
+            done.push_back({subscriber.response, it->second});
+            return true;
+        });
+        subscribers_.erase(keep, subscribers_.end());
+        if (done.empty() && flushed.empty()) {
+            continue;
+        }
+
+        lock.unlock();
+        if (!flushed.empty()) {
+            notifyListeners(flushed, false);
+        }
+        for (auto& completion : done) {
+            complete(*completion.response, std::move(completion.body));
+        }
+        lock.lock();
+    }
+}
+
+void ChangeFeed::flushPending(std::vector<Change>& flushed) {
+    for (const auto& [id, op] : pending_) {
+        ring_.push_back({++head_, id, op});
+        if (!listeners_.empty()) {
+            flushed.push_back({op, id});
+        }
+    }
+    events_.fetch_add(pending_.size(), std::memory_order_relaxed);
+    pending_.clear();
+    while (ring_.size() > std::max<std::size_t>(settings_.history, 1)) {
+        ring_.pop_front();
+    }
+}
+
+std::optional<std::uint64_t> ChangeFeed::parseCursor(const std::string& last_event_id) const {
+    if (last_event_id.empty()) {
+        return head_;
+    }
+    // <эпоха hex>-<seq>
+    const auto dash = last_event_id.find('-');
+    if (dash == std::string::npos) {
+        return std::nullopt;
+    }
+    char* end = nullptr;
+    const auto epoch = std::strtoul(last_event_id.c_str(), &end, 16);
+    if (end != last_event_id.c_str() + dash || epoch != epoch_) {
+        return std::nullopt;
+    }
+    const auto seq = std::strtoull(last_event_id.c_str() + dash + 1, &end, 10);
+    if (*end != '\0' || seq > head_) {
+        return std::nullopt;
+    }
+    // События после seq уже вытеснены из кольца
+    const std::uint64_t oldest = ring_.empty() ? head_ + 1 : ring_.front().seq;
+    if (seq + 1 < oldest) {
+        return std::nullopt;
+    }
+    return seq;
+}
+
+std::string ChangeFeed::renderBatch(std::uint64_t cursor) const {
+    std::string body = "retry: " + std::to_string(settings_.retry.count()) + "\n";
+    if (cursor >= head_ || ring_.empty()) {
+        // Пустой ответ только переносит позицию: EventSource запомнит id без события
+        body += "id: " + eventId(cursor) + "\n\n";
+        return body;
+    }
+
+    const std::size_t first = static_cast<std::size_t>(cursor + 1 - ring_.front().seq);
+    const std::size_t last = std::min(ring_.size(), first + std::max<std::size_t>(settings_.max_batch, 1));
+
+    // Несколько изменений книги в пачке - одно событие с последним из них
+    std::unordered_map<int, std::size_t> latest;
+    latest.reserve(last - first);
+    for (std::size_t i = first; i < last; ++i) {
+        latest[ring_[i].id] = i;
+    }
+    char data[64];
+    for (std::size_t i = first; i < last; ++i) {
+        const Event& event = ring_[i];
+        if (latest[event.id] != i) {
+            continue;
+        }
+        std::snprintf(data, sizeof(data), "{\"op\":\"%s\",\"id\":%d}", opName(event.op), event.id);
+        body += "id: " + eventId(event.seq) + "\nevent: book\ndata: " + data + "\n\n";
+    }
+    return body;
+}
+
+std::string ChangeFeed::renderReset() const {
+    return "retry: " + std::to_string(settings_.retry.count()) + "\n" +
+           "id: " + eventId(head_) + "\nevent: reset\ndata: {}\n\n";
+}
+
+std::string ChangeFeed::eventId(std::uint64_t seq) const {
+    char id[32];
+    std::snprintf(id, sizeof(id), "%08x-%llu", epoch_, static_cast<unsigned long long>(seq));
+    return id;
+}
+
+void ChangeFeed::complete(crow::response& res, std::string body) {
+    res.code = 200;
+    res.set_header("Content-Type", "text/event-stream");
+    res.set_header("Cache-Control", "no-cache");
+    // Обратный прокси не должен копить ответ
+    res.set_header("X-Accel-Buffering", "no");
+    res.body = std::move(body);
+    res.end();
+}
+
+} // namespace feed
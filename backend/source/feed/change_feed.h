@@ -0,0 +1,139 @@
+#pragma once
+
+#include <crow.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace feed {
+
+enum class ChangeOp : std::uint8_t {
+    CREATE,
+    UPDATE,
+    DELETE
+};
+
+const char* opName(ChangeOp op);
+// "create"/"insert", "update", "delete"
+std::optional<ChangeOp> opFromString(std::string_view name);
+
+// Лента изменений книг для GET /api/books/changes (Server-Sent Events).
+//
+// Crow отправляет ответ целиком, поэтому поток SSE устроен как серия ответов:
+// запрос ждет событий не дольше hold, получает их пачкой и завершается, а
+// EventSource переподключается через retry с заголовком Last-Event-ID.
+// Ожидающие запросы не занимают потоки сервера: ответ завершает поток ленты.
+//
+// Изменения одной книги в пределах окна coalesce сливаются в одно событие.
+// События хранятся в общем кольце на history записей: подписчик держит только
+// позицию в нем, а текст пачки для всех, кто ждал с одной позиции, собирается
+// один раз. За один ответ отдается не больше max_batch событий - отставший
+// клиент догоняет следующими запросами; выпавшему из кольца, как и клиенту с id
+// другой ленты (перезапуск, пропуск уведомлений), отправляется событие reset:
+// список книг нужно перечитать
+class ChangeFeed {
+public:
+    struct Change {
+        ChangeOp op;
+        int id;
+    };
+
+    // Получатель слитых изменений, вызывается потоком ленты.
+    // reset - изменения могли быть пропущены, известное состояние устарело
+    using Listener = std::function<void(const std::vector<Change>& changes, bool reset)>;
+
+    struct Settings {
+        std::size_t history = 4096;
+        std::chrono::milliseconds coalesce{100};
+        std::chrono::seconds hold{25};
+        std::size_t max_batch = 256;
+        std::size_t max_subscribers = 10000;
+        std::chrono::milliseconds retry{1000};
+    };
+
+    explicit ChangeFeed(Settings settings);
+    ~ChangeFeed();
+
+    void publish(ChangeOp op, int id);
+
+    // Регистрируется до начала работы сервера
+    void addListener(Listener listener);
+
+    // Изменения могли быть пропущены (разрыв LISTEN): новая эпоха ленты,
+    // всем подписчикам - reset
+    void resync();
+
+    // Асинхронный ответ: завершается сразу, если для last_event_id уже есть события,
+    // иначе потоком ленты. false - подписчиков слишком много, ответ не тронут
+    bool subscribe(const std::string& last_event_id, crow::response& res);
+
+    void stop();
+
+    std::size_t subscribers() const;
+    std::uint64_t events() const { return events_.load(std::memory_order_relaxed); }
+    std::uint64_t resets() const { return resets_.load(std::memory_order_relaxed); }
+    std::uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+    ChangeFeed(const ChangeFeed&) = delete;
+    ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+private:
+    struct Event {
+        std::uint64_t seq;
+        int id;
+        ChangeOp op;
+    };
+
+    struct Subscriber {
+        crow::response* response;
+        std::uint64_t cursor;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    struct Completion {
+        crow::response* response;
+        std::string body;
+    };
+
+    void loop();
+    // Переносит слитые изменения в кольцо; для получателей - в flushed
+    void flushPending(std::vector<Change>& flushed);
+    void notifyListeners(const std::vector<Change>& changes, bool reset) const;
+    // Под mutex_: позиция из Last-Event-ID; nullopt - нужен reset
+    std::optional<std::uint64_t> parseCursor(const std::string& last_event_id) const;
+    std::string renderBatch(std::uint64_t cursor) const;
+    std::string renderReset() const;
+    std::string eventId(std::uint64_t seq) const;
+    static void complete(crow::response& res, std::string body);
+
+    const Settings settings_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_ = true;
+    std::uint32_t epoch_;
+    std::uint64_t head_ = 0;                    // seq последнего события
+    std::deque<Event> ring_;
+    std::unordered_map<int, ChangeOp> pending_; // еще не вошедшие в кольцо
+    std::chrono::steady_clock::time_point flush_at_;
+    std::vector<Subscriber> subscribers_;       // по возрастанию deadline
+    std::vector<Listener> listeners_;
+    std::thread worker_;
+
+    std::atomic<std::uint64_t> events_{0};
+    std::atomic<std::uint64_t> resets_{0};
+    std::atomic<std::uint64_t> rejected_{0};
+};
+
+} // namespace feed
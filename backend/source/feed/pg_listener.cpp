@@ -0,0 +1,140 @@
+#include "feed/pg_listener.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace feed {
+
+namespace {
+
+// Полезная нагрузка уведомления: "<op>:<id>", например "update:42"
+class Receiver : public pqxx::notification_receiver {
+public:
+    Receiver(pqxx::connection& conn, ChangeFeed& feed)
+        : pqxx::notification_receiver(conn, PgListener::kChannel), feed_(feed) {}
+
+    void operator()(const std::string& payload, int /*backend_pid*/) override {
+        const auto colon = payload.find(':');
+        const auto op = colon == std::string::npos ? std::nullopt
+                                                   : opFromString(std::string_view(payload).substr(0, colon));
+        const int id = op ? std::atoi(payload.c_str() + colon + 1) : 0;
+        if (!op || id <= 0) {
+            LOG_WARN("Ignoring malformed change notification", {{"payload", payload}});
+            return;
+        }
+        feed_.publish(*op, id);
+    }
+
+private:
+    ChangeFeed& feed_;
+};
+
+constexpr auto kMinBackoff = std::chrono::milliseconds(200);
+constexpr auto kMaxBackoff = std::chrono::milliseconds(10000);
+
+} // namespace
+
+PgListener::PgListener(std::string connection_string, std::shared_ptr<ChangeFeed> feed)
+    : connection_string_(std::move(connection_string)), feed_(std::move(feed)) {}
+
+PgListener::~PgListener() {
+    stop();
+}
+
+void PgListener::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    worker_ = std::thread([this] { loop(); });
+}
+
+void PgListener::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    stopped_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool PgListener::backoff(std::chrono::milliseconds delay) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return !stopped_.wait_for(lock, delay, [this] { return !running_; });
+}
+
+void PgListener::loop() {
+    auto delay = kMinBackoff;
+    bool connected_before = false;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                return;
+            }
+        }
+        try {
+            pqxx::connection conn(connection_string_);
+            Receiver receiver(conn, *feed_);
+            if (connected_before) {
+                // Уведомления за время разрыва потеряны - подписчики перечитают список
+                feed_->resync();
+                LOG_INFO("Change feed listener reconnected");
+            }
+            connected_before = true;
+            delay = kMinBackoff;
+
+            for (;;) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!running_) {
+                        return;
+                    }
+                }
+                // Секундный таймаут: ограничивает задержку остановки
+                conn.await_notification(1, 0);
+            }
+        } catch (const std::exception& e) {
+            LOG_WARN("Change feed listener connection lost",
+                     {{"error", e.what()}, {"retry_ms", static_cast<long long>(delay.count())}});
+        }
+        if (!backoff(delay)) {
+            return;
+        }
+        delay = std::min(delay * 2, kMaxBackoff);
+    }
+}
+
+void PgListener::installTrigger(pqxx::connection& conn) {
+    pqxx::work txn(conn);
+    // Процессы prefork стартуют одновременно: установка под блокировкой
+    txn.exec("SELECT pg_advisory_xact_lock(hashtext('books_notify_change'))");
+    const pqxx::result existing = txn.exec(
+        "SELECT 1 FROM pg_trigger WHERE tgname = 'books_notify_change' "
+        "AND tgrelid = 'books'::regclass");
+
+    txn.exec(
+        "CREATE OR REPLACE FUNCTION books_notify_change() RETURNS trigger AS $$\n"
+        "BEGIN\n"
+        "    IF TG_OP = 'DELETE' THEN\n"
+        "        PERFORM pg_notify('books_changes', 'delete:' || OLD.id);\n"
+        "    ELSE\n"
+        "        PERFORM pg_notify('books_changes', lower(TG_OP) || ':' || NEW.id);\n"
+        "    END IF;\n"
+        "    RETURN NULL;\n"
+        "END;\n"
+        "$$ LANGUAGE plpgsql");
+    if (existing.empty()) {
+        txn.exec(
+            "CREATE TRIGGER books_notify_change "
+            "AFTER INSERT OR UPDATE OR DELETE ON books "
+            "FOR EACH ROW EXECUTE PROCEDURE books_notify_change()");
+    }
+    txn.commit();
+}
+
+} // namespace feed
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "feed/change_feed.h"
+
+namespace feed {
+
+// Источник ленты для PostgreSQL: одно выделенное соединение с LISTEN на канал
+// books_changes. Уведомления шлет триггер на таблице books (installTrigger),
+// поэтому в ленту попадают изменения от всех процессов и любых клиентов базы.
+// После разрыва соединения лента получает resync: уведомления за время
+// переподключения потеряны
+class PgListener {
+public:
+    static constexpr const char* kChannel = "books_changes";
+
+    PgListener(std::string connection_string, std::shared_ptr<ChangeFeed> feed);
+    ~PgListener();
+
+    void start();
+    void stop();
+
+    // Функция и триггер NOTIFY на таблице books; повторный вызов безопасен
+    static void installTrigger(pqxx::connection& conn);
+
+    PgListener(const PgListener&) = delete;
+    PgListener& operator=(const PgListener&) = delete;
+
+private:
+    void loop();
+    // Ждет паузу переподключения; false - остановка
+    bool backoff(std::chrono::milliseconds delay);
+
+    const std::string connection_string_;
+    const std::shared_ptr<ChangeFeed> feed_;
+
+    std::mutex mutex_;
+    std::condition_variable stopped_;
+    bool running_ = false;
+    std::thread worker_;
+};
+
+} // namespace feed
@@ -0,0 +1,525 @@
+#include "feed/shelf_hub.h"
+#include "service/book_service.h"
+#include "serializer/book_serializer.h"
+#include "serializer/json_writer.h"
+#include "logger/logger.h"
+
+#include <nlohmann/json.hpp>
+#include <climits>
+#include <iterator>
+
+namespace feed {
+
+namespace {
+
+constexpr std::size_t kMaxStatusLength = 50;
+constexpr const char* kResetMessage = R"({"type":"reset"})";
+constexpr const char* kSubscribedMessage = R"({"type":"subscribed"})";
+
+struct ClientRequest {
+    bool subscribe = true;
+    std::vector<int> ids;
+    std::vector<std::string> statuses;
+};
+
+// Разбор сообщения клиента; при ошибке заполняет error
+std::optional<ClientRequest> parseRequest(const std::string& data, std::string& error) {
+    const auto doc = nlohmann::json::parse(data, nullptr, false);
+    if (doc.is_discarded() || !doc.is_object()) {
+        error = "Message must be a JSON object";
+        return std::nullopt;
+    }
+    const auto type = doc.find("type");
+    if (type == doc.end() || !type->is_string() || (*type != "subscribe" && *type != "unsubscribe")) {
+        error = "Field 'type' must be 'subscribe' or 'unsubscribe'";
+        return std::nullopt;
+    }
+
+    ClientRequest request;
+    request.subscribe = *type == "subscribe";
+    if (const auto ids = doc.find("ids"); ids != doc.end()) {
+        if (!ids->is_array()) {
+            error = "Field 'ids' must be an array";
+            return std::nullopt;
+        }
+        for (const auto& id : *ids) {
+            if (!id.is_number_integer() || id.get<long long>() <= 0 || id.get<long long>() > INT_MAX) {
+                error = "Field 'ids' must contain positive integers";
+                return std::nullopt;
+            }
+            request.ids.push_back(id.get<int>());
+        }
+    }
+    if (const auto statuses = doc.find("statuses"); statuses != doc.end()) {
+        if (!statuses->is_array()) {
+            error = "Field 'statuses' must be an array";
+            return std::nullopt;
+        }
+        for (const auto& status : *statuses) {
+            if (!status.is_string() || status.get_ref<const std::string&>().empty() ||
+                status.get_ref<const std::string&>().size() > kMaxStatusLength) {
+                error = "Field 'statuses' must contain non-empty strings up to 50 characters";
+                return std::nullopt;
+            }
+            request.statuses.push_back(status.get<std::string>());
+        }
+    }
+    return request;
+}
+
+std::string bookMessage(const BookRow& book) {
+    return "{\"type\":\"book\",\"book\":" +
+           serializer::BookSerializer::serializeBook(book, serializer::ResponseFormat::JSON) + "}";
+}
+
+std::string removedMessage(int id, bool deleted) {
+    std::string out;
+    serializer::JsonWriter writer(out);
+    writer.beginObject(3);
+    writer.key("type");
+    writer.string("removed");
+    writer.key("id");
+    writer.integer(id);
+    writer.key("deleted");
+    writer.boolean(deleted);
+    writer.endObject();
+    return out;
+}
+
+std::string errorMessage(const std::string& message) {
+    std::string out;
+    serializer::JsonWriter writer(out);
+    writer.beginObject(2);
+    writer.key("type");
+    writer.string("error");
+    writer.key("message");
+    writer.string(message);
+    writer.endObject();
+    return out;
+}
+
+void writeOptionalInt(serializer::JsonWriter& writer, const std::optional<int>& value) {
+    if (value.has_value()) {
+        writer.integer(*value);
+    } else {
+        writer.null();
+    }
+}
+
+// Только поля, различающиеся в версиях книги; пусто - различий нет
+std::string deltaMessage(const BookRow& before, const BookRow& after) {
+    std::string out = "{\"type\":\"delta\",\"id\":" + std::to_string(after.id) + ",\"fields\":";
+    const std::size_t fields_at = out.size();
+    serializer::JsonWriter writer(out);
+    writer.beginObject(0);
+    auto text = [&](const char* name, const std::string& old_value, const std::string& new_value) {
+        if (old_value != new_value) {
+            writer.key(name);
+            writer.string(new_value);
+        }
+    };
+    auto number = [&](const char* name, const std::optional<int>& old_value, const std::optional<int>& new_value) {
+        if (old_value != new_value) {
+            writer.key(name);
+            writeOptionalInt(writer, new_value);
+        }
+    };
+    text("title", before.title, after.title);
+    text("author", before.author, after.author);
+    number("year", before.year, after.year);
+    text("status", before.status, after.status);
+    number("rating", before.rating, after.rating);
+    text("review", before.review, after.review);
+    text("updated_at", before.updated_at, after.updated_at);
+    writer.endObject();
+    if (out.size() == fields_at + 2) {
+        return {};
+    }
+    out.push_back('}');
+    return out;
+}
+
+} // namespace
+
+ShelfHub::ShelfHub(Settings settings, std::shared_ptr<BookService> service)
+    : settings_(std::move(settings)), service_(std::move(service)) {
+    worker_ = std::thread([this] { loop(); });
+}
+
+ShelfHub::~ShelfHub() {
+    stop();
+}
+
+void ShelfHub::open(crow::websocket::connection& socket) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_ && clients_.size() < settings_.max_connections) {
+            auto client = std::make_unique<Client>();
+            client->socket = &socket;
+            client->serial = ++next_serial_;
+            clients_.emplace(&socket, std::move(client));
+            return;
+        }
+    }
+    socket.close("Too many connections");
+}
+
+void ShelfHub::message(crow::websocket::connection& socket, const std::string& data, bool is_binary) {
+    std::string error;
+    std::optional<ClientRequest> request;
+    if (is_binary) {
+        error = "Binary messages are not supported";
+    } else {
+        request = parseRequest(data, error);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = clients_.find(&socket);
+        if (it == clients_.end()) {
+            return;
+        }
+        Client& client = *it->second;
+        if (request && request->subscribe &&
+            client.ids.size() + client.statuses.size() + request->ids.size() + request->statuses.size() >
+                settings_.max_subscriptions) {
+            error = "Too many subscriptions, limit is " + std::to_string(settings_.max_subscriptions);
+            request.reset();
+        }
+
+        if (!request) {
+            queue(client, errorMessage(error));
+        } else if (request->subscribe) {
+            // Изменения маршрутизируются по подписке сразу, снимок читается в следующем тике
+            subscribe(client, request->ids, request->statuses);
+            snapshots_.push_back({&socket, client.serial, std::move(request->ids),
+                                  std::move(request->statuses), false});
+        } else {
+            unsubscribe(client, request->ids, request->statuses);
+            prune_ = true;
+        }
+        dirty_ = true;
+    }
+    wake_.notify_one();
+}
+
+void ShelfHub::close(crow::websocket::connection& socket) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = clients_.find(&socket);
+    if (it == clients_.end()) {
+        return;
+    }
+    Client& client = *it->second;
+    unsubscribe(client, std::vector<int>(client.ids.begin(), client.ids.end()),
+                std::vector<std::string>(client.statuses.begin(), client.statuses.end()));
+    outgoing_.erase(&client);
+    clients_.erase(it);
+    prune_ = true;
+}
+
+void ShelfHub::onChanges(const std::vector<ChangeFeed::Change>& changes, bool reset) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& change : changes) {
+            changes_.insert_or_assign(change.id, change.op);
+        }
+        reset_ = reset_ || reset;
+        dirty_ = true;
+    }
+    wake_.notify_one();
+}
+
+void ShelfHub::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+std::size_t ShelfHub::connections() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clients_.size();
+}
+
+void ShelfHub::loop() {
+    auto last_tick = std::chrono::steady_clock::now() - settings_.tick;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        wake_.wait(lock, [this] { return !running_ || dirty_; });
+        // Окно тика: все, что придет до его конца, уйдет в тех же кадрах
+        wake_.wait_until(lock, last_tick + settings_.tick, [this] { return !running_; });
+        if (!running_) {
+            break;
+        }
+        last_tick = std::chrono::steady_clock::now();
+        dirty_ = false;
+
+        if (reset_) {
+            reset_ = false;
+            known_.clear();
+            for (const auto& [socket, client] : clients_) {
+                snapshots_.push_back({socket, client->serial,
+                                      std::vector<int>(client->ids.begin(), client->ids.end()),
+                                      std::vector<std::string>(client->statuses.begin(), client->statuses.end()),
+                                      true});
+            }
+        }
+
+        // Читаются только книги, которые кто-то видит или может увидеть
+        std::vector<ChangeFeed::Change> changed;
+        for (const auto& [id, op] : changes_) {
+            if (by_id_.count(id) != 0 || known_.count(id) != 0 || (op != ChangeOp::DELETE && !by_status_.empty())) {
+                changed.push_back({op, id});
+            }
+        }
+        changes_.clear();
+        std::vector<Snapshot> snapshots = std::move(snapshots_);
+        snapshots_.clear();
+
+        Loaded books;
+        std::unordered_map<std::string, std::vector<int>> by_status;
+        lock.unlock();
+        bool loaded = true;
+        try {
+            load(changed, snapshots, books, by_status);
+        } catch (const std::exception& e) {
+            LOG_WARN("Shelf hub failed to read books, retrying next tick", {{"error", e.what()}});
+            loaded = false;
+        }
+        lock.lock();
+
+        if (!loaded) {
+            // Более поздние изменения тех же книг уже в очереди и важнее возвращаемых
+            for (const auto& change : changed) {
+                changes_.try_emplace(change.id, change.op);
+            }
+            snapshots_.insert(snapshots_.begin(), std::make_move_iterator(snapshots.begin()),
+                              std::make_move_iterator(snapshots.end()));
+            dirty_ = true;
+            continue;
+        }
+
+        // Снимок первым: прочитанная в этом тике версия станет для нового подписчика
+        // базой, и изменение той же книги не придет ему второй копией
+        for (const auto& snapshot : snapshots) {
+            deliver(snapshot, books, by_status);
+        }
+        for (const auto& change : changed) {
+            route(change.id, books[change.id]);
+        }
+        if (prune_) {
+            prune();
+            prune_ = false;
+        }
+        flush();
+    }
+}
+
+void ShelfHub::load(const std::vector<ChangeFeed::Change>& changed, const std::vector<Snapshot>& snapshots,
+                    Loaded& books, std::unordered_map<std::string, std::vector<int>>& by_status) const {
+    auto fetch = [&](int id) {
+        if (books.count(id) != 0) {
+            return;
+        }
+        auto book = service_->getBookById(id);
+        books.emplace(id, book ? std::optional<BookRow>(std::move(book.value())) : std::nullopt);
+    };
+
+    for (const auto& change : changed) {
+        if (change.op == ChangeOp::DELETE) {
+            books.emplace(change.id, std::nullopt);
+        } else {
+            fetch(change.id);
+        }
+    }
+
+    std::unordered_set<std::string> statuses;
+    for (const auto& snapshot : snapshots) {
+        for (int id : snapshot.ids) {
+            fetch(id);
+        }
+        statuses.insert(snapshot.statuses.begin(), snapshot.statuses.end());
+    }
+    if (statuses.empty()) {
+        return;
+    }
+    // Один проход по списку на все подписки тика
+    for (auto& book : service_->getAllBooks()) {
+        if (statuses.count(book.status) != 0) {
+            by_status[book.status].push_back(book.id);
+            books.try_emplace(book.id, std::move(book));
+        }
+    }
+}
+
+void ShelfHub::route(int id, const std::optional<BookRow>& after) {
+    const auto known = known_.find(id);
+    const BookRow* before = known == known_.end() ? nullptr : &known->second;
+
+    std::unordered_set<Client*> candidates;
+    auto collect = [&](const auto& index, const auto& key) {
+        if (const auto it = index.find(key); it != index.end()) {
+            candidates.insert(it->second.begin(), it->second.end());
+        }
+    };
+    collect(by_id_, id);
+    if (before != nullptr) {
+        collect(by_status_, before->status);
+    }
+    if (after) {
+        collect(by_status_, after->status);
+    }
+
+    // Тексты общие для всех получателей
+    std::optional<std::string> full;
+    std::optional<std::string> delta;
+    bool visible = false;
+    for (Client* client : candidates) {
+        const bool watches_id = client->ids.count(id) != 0;
+        const bool was = before != nullptr && (watches_id || client->statuses.count(before->status) != 0);
+        const bool is = after && (watches_id || client->statuses.count(after->status) != 0);
+        visible = visible || is;
+        if (was && is) {
+            if (!delta) {
+                delta = deltaMessage(*before, *after);
+            }
+            if (!delta->empty()) {
+                queue(*client, *delta);
+            }
+        } else if (is) {
+            if (!full) {
+                full = bookMessage(*after);
+            }
+            queue(*client, *full);
+        } else if (was || watches_id) {
+            queue(*client, removedMessage(id, !after));
+        }
+    }
+
+    if (visible) {
+        known_.insert_or_assign(id, *after);
+    } else if (known != known_.end()) {
+        known_.erase(known);
+    }
+}
+
+void ShelfHub::deliver(const Snapshot& snapshot, const Loaded& books,
+                       const std::unordered_map<std::string, std::vector<int>>& by_status) {
+    Client* client = find(snapshot.socket, snapshot.serial);
+    if (client == nullptr) {
+        return;
+    }
+    if (snapshot.reset) {
+        queue(*client, kResetMessage);
+    }
+
+    std::unordered_set<int> sent;
+    auto send = [&](const BookRow& book) {
+        if (sent.insert(book.id).second) {
+            queue(*client, bookMessage(book));
+            // Более старую версию не заменяем: от нее считаются delta остальных подписчиков
+            known_.try_emplace(book.id, book);
+        }
+    };
+    for (int id : snapshot.ids) {
+        if (client->ids.count(id) == 0) {
+            continue;
+        }
+        const auto it = books.find(id);
+        if (it != books.end() && it->second) {
+            send(*it->second);
+        } else if (sent.insert(id).second) {
+            queue(*client, removedMessage(id, true));
+        }
+    }
+    for (const auto& status : snapshot.statuses) {
+        const auto ids = by_status.find(status);
+        if (client->statuses.count(status) == 0 || ids == by_status.end()) {
+            continue;
+        }
+        for (int id : ids->second) {
+            const auto it = books.find(id);
+            if (it != books.end() && it->second && it->second->status == status) {
+                send(*it->second);
+            }
+        }
+    }
+    queue(*client, kSubscribedMessage);
+}
+
+void ShelfHub::subscribe(Client& client, const std::vector<int>& ids, const std::vector<std::string>& statuses) {
+    for (int id : ids) {
+        if (client.ids.insert(id).second) {
+            by_id_[id].insert(&client);
+        }
+    }
+    for (const auto& status : statuses) {
+        if (client.statuses.insert(status).second) {
+            by_status_[status].insert(&client);
+        }
+    }
+}
+
+void ShelfHub::unsubscribe(Client& client, const std::vector<int>& ids, const std::vector<std::string>& statuses) {
+    auto remove = [&client](auto& index, const auto& key) {
+        const auto it = index.find(key);
+        if (it != index.end() && it->second.erase(&client) != 0 && it->second.empty()) {
+            index.erase(it);
+        }
+    };
+    for (int id : ids) {
+        if (client.ids.erase(id) != 0) {
+            remove(by_id_, id);
+        }
+    }
+    for (const auto& status : statuses) {
+        if (client.statuses.erase(status) != 0) {
+            remove(by_status_, status);
+        }
+    }
+}
+
+void ShelfHub::prune() {
+    for (auto it = known_.begin(); it != known_.end();) {
+        if (by_id_.count(it->first) != 0 || by_status_.count(it->second.status) != 0) {
+            ++it;
+        } else {
+            it = known_.erase(it);
+        }
+    }
+}
+
+void ShelfHub::flush() {
+    for (Client* client : outgoing_) {
+        std::string frame;
+        frame.reserve(client->outbox.size() + 2);
+        frame.push_back('[');
+        frame.append(client->outbox);
+        frame.push_back(']');
+        client->socket->send_text(std::move(frame));
+        client->outbox.clear();
+    }
+    frames_.fetch_add(outgoing_.size(), std::memory_order_relaxed);
+    outgoing_.clear();
+}
+
+void ShelfHub::queue(Client& client, const std::string& message) {
+    if (client.outbox.empty()) {
+        outgoing_.insert(&client);
+    } else {
+        client.outbox.push_back(',');
+    }
+    client.outbox.append(message);
+    messages_.fetch_add(1, std::memory_order_relaxed);
+}
+
+ShelfHub::Client* ShelfHub::find(crow::websocket::connection* socket, std::uint64_t serial) {
+    const auto it = clients_.find(socket);
+    return it != clients_.end() && it->second->serial == serial ? it->second.get() : nullptr;
+}
+
+} // namespace feed
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <crow.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "feed/change_feed.h"
+#include "model/book.h"
+
+class BookService;
+
+namespace feed {
+
+// Подписки WebSocket на книги по id и по статусу (GET /api/books/ws).
+//
+// Сообщения клиента:
+//   {"type":"subscribe","ids":[1,2],"statuses":["reading"]}
+//   {"type":"unsubscribe","ids":[2]}
+// Сервер шлет кадр - JSON-массив сообщений:
+//   {"type":"book","book":{...}}              книга целиком: снимок подписки или вход в фильтр
+//   {"type":"delta","id":5,"fields":{...}}    только изменившиеся поля
+//   {"type":"removed","id":5,"deleted":true}  книга удалена или вышла из фильтра статуса
+//   {"type":"subscribed"}                     снимок по подписке отправлен
+//   {"type":"reset"}                          изменения могли быть пропущены, следом новый снимок
+//   {"type":"error","message":"..."}
+//
+// Изменения приходят из ChangeFeed уже слитыми и обрабатываются потоком хаба
+// раз в tick: каждая книга читается один раз для всех подписчиков, а сообщения
+// соединения за тик уходят одним кадром - число кадров и системных вызовов
+// не растет с частотой изменений
+class ShelfHub {
+public:
+    struct Settings {
+        std::chrono::milliseconds tick{50};
+        std::size_t max_connections = 10000;
+        std::size_t max_subscriptions = 1000;   // id и статусов на соединение
+    };
+
+    ShelfHub(Settings settings, std::shared_ptr<BookService> service);
+    ~ShelfHub();
+
+    // Обработчики WebSocket-маршрута (потоки сервера)
+    void open(crow::websocket::connection& socket);
+    void message(crow::websocket::connection& socket, const std::string& data, bool is_binary);
+    void close(crow::websocket::connection& socket);
+
+    // Получатель ChangeFeed
+    void onChanges(const std::vector<ChangeFeed::Change>& changes, bool reset);
+
+    void stop();
+
+    std::size_t connections() const;
+    std::uint64_t frames() const { return frames_.load(std::memory_order_relaxed); }
+    std::uint64_t messages() const { return messages_.load(std::memory_order_relaxed); }
+
+    ShelfHub(const ShelfHub&) = delete;
+    ShelfHub& operator=(const ShelfHub&) = delete;
+
+private:
+    struct Client {
+        crow::websocket::connection* socket;
+        std::uint64_t serial;                   // адрес соединения может достаться новому
+        std::unordered_set<int> ids;
+        std::unordered_set<std::string> statuses;
+        std::string outbox;                     // сообщения кадра через запятую
+    };
+
+    // Снимок для новой подписки (или для всех подписок после reset)
+    struct Snapshot {
+        crow::websocket::connection* socket;
+        std::uint64_t serial;
+        std::vector<int> ids;
+        std::vector<std::string> statuses;
+        bool reset;
+    };
+
+    // Книги, прочитанные за тик; nullopt - книги нет
+    using Loaded = std::unordered_map<int, std::optional<BookRow>>;
+
+    void loop();
+    // Без mutex_: чтение книг из сервиса
+    void load(const std::vector<ChangeFeed::Change>& changed, const std::vector<Snapshot>& snapshots,
+              Loaded& books, std::unordered_map<std::string, std::vector<int>>& by_status) const;
+    // Под mutex_
+    void route(int id, const std::optional<BookRow>& after);
+    void deliver(const Snapshot& snapshot, const Loaded& books,
+                 const std::unordered_map<std::string, std::vector<int>>& by_status);
+    void subscribe(Client& client, const std::vector<int>& ids, const std::vector<std::string>& statuses);
+    void unsubscribe(Client& client, const std::vector<int>& ids, const std::vector<std::string>& statuses);
+    void prune();
+    void flush();
+    void queue(Client& client, const std::string& message);
+    Client* find(crow::websocket::connection* socket, std::uint64_t serial);
+
+    const Settings settings_;
+    const std::shared_ptr<BookService> service_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_ = true;
+    bool dirty_ = false;                        // есть работа для следующего тика
+    bool reset_ = false;
+    bool prune_ = false;
+    std::uint64_t next_serial_ = 0;
+    std::unordered_map<crow::websocket::connection*, std::unique_ptr<Client>> clients_;
+    std::unordered_map<int, std::unordered_set<Client*>> by_id_;
+    std::unordered_map<std::string, std::unordered_set<Client*>> by_status_;
+    std::unordered_map<int, ChangeOp> changes_;
+    std::vector<Snapshot> snapshots_;
+    std::unordered_set<Client*> outgoing_;      // с непустым outbox
+    // Последнее отправленное состояние книг, которые видят подписчики: база для delta
+    std::unordered_map<int, BookRow> known_;
+    std::thread worker_;
+
+    std::atomic<std::uint64_t> frames_{0};
+    std::atomic<std::uint64_t> messages_{0};
+};
+
+} // namespace feed
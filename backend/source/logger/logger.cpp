@@ -0,0 +1,294 @@
+#include "logger/logger.h"
+#include "serializer/json_writer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+namespace logger {
+
+namespace {
+
+const char* levelName(Level level) {
+    switch (level) {
+        case Level::DEBUG: return "debug";
+        case Level::INFO: return "info";
+        case Level::WARN: return "warn";
+        case Level::ERROR: return "error";
+        default: return "unknown";
+    }
+}
+
+// Время в формате ISO 8601 (UTC, миллисекунды)
+std::string_view timestamp(char (&buf)[32]) {
+    const auto now = std::chrono::system_clock::now();
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    const std::time_t seconds = static_cast<std::time_t>(ms / 1000);
+    std::tm tm{};
+    gmtime_r(&seconds, &tm);
+    const int len = std::snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                                  tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(ms % 1000));
+    return std::string_view(buf, static_cast<std::size_t>(len));
+}
+
+// Наибольшее начало строки, которое после экранирования JsonWriter занимает
+// не больше budget байт. Символ UTF-8 не разрывается
+std::string_view escapedPrefix(std::string_view text, std::size_t budget) {
+    std::size_t used = 0;
+    std::size_t end = 0;
+    for (; end < text.size(); ++end) {
+        const auto c = static_cast<unsigned char>(text[end]);
+        std::size_t width = 1;
+        if (c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t' || c == '\b' || c == '\f') {
+            width = 2;
+        } else if (c < 0x20) {
+            width = 6;
+        }
+        if (used + width > budget) {
+            break;
+        }
+        used += width;
+    }
+    while (end > 0 && end < text.size() && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80) {
+        --end;
+    }
+    return text.substr(0, end);
+}
+
+std::int64_t steadySeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+Level levelFromString(const std::string& name, Level fallback) {
+    if (name == "debug") return Level::DEBUG;
+    if (name == "info") return Level::INFO;
+    if (name == "warn" || name == "warning") return Level::WARN;
+    if (name == "error") return Level::ERROR;
+    return fallback;
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : slots_(new Slot[kCapacity]) {
+    for (std::size_t i = 0; i < kCapacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer_ = std::thread([this] { writerLoop(); });
+}
+
+Logger::~Logger() {
+    shutdown();
+}
+
+void Logger::write(Level level, std::uint64_t suppressed, std::string_view message,
+                   std::initializer_list<Field> fields) {
+    // Строка собирается в буфере потока: после прогрева без выделений памяти
+    thread_local std::string line;
+    line.clear();
+
+    char ts_buf[32];
+    serializer::JsonWriter writer(line);
+    writer.beginObject(0);
+    writer.key("ts");
+    writer.string(timestamp(ts_buf));
+    writer.key("level");
+    writer.string(levelName(level));
+    writer.key("msg");
+    writer.string(message);
+    for (const auto& field : fields) {
+        writer.key(field.key_);
+        switch (field.type_) {
+            case Field::Type::STRING: writer.string(field.text_); break;
+            case Field::Type::INT: writer.integer(field.number_.i); break;
+            case Field::Type::UINT: writer.integer(static_cast<std::int64_t>(field.number_.u)); break;
+            case Field::Type::DOUBLE: writer.real(field.number_.d); break;
+            case Field::Type::BOOL: writer.boolean(field.number_.b); break;
+        }
+    }
+    if (suppressed > 0) {
+        writer.key("suppressed");
+        writer.integer(static_cast<std::int64_t>(suppressed));
+    }
+    writer.endObject();
+
+    // Запись не помещается в слот - оставляем только уровень и начало сообщения.
+    // Экранирование раздувает текст до шести раз, поэтому начало подбирается по
+    // длине в записи: сначала собираем запись без сообщения, остаток слота - бюджет
+    if (line.size() + 1 > kSlotSize) {
+        const auto write_short = [&](std::string_view text) {
+            line.clear();
+            serializer::JsonWriter short_writer(line);
+            short_writer.beginObject(0);
+            short_writer.key("ts");
+            short_writer.string(timestamp(ts_buf));
+            short_writer.key("level");
+            short_writer.string(levelName(level));
+            short_writer.key("msg");
+            short_writer.string(text);
+            short_writer.key("truncated");
+            short_writer.boolean(true);
+            short_writer.endObject();
+        };
+        write_short({});
+        const std::size_t budget = line.size() + 1 < kSlotSize ? kSlotSize - 1 - line.size() : 0;
+        write_short(escapedPrefix(message, budget));
+        if (line.size() + 1 > kSlotSize) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    line.push_back('\n');
+
+    // После остановки фонового потока пишем синхронно
+    if (!running_.load(std::memory_order_acquire)) {
+        writeOut(line);
+        return;
+    }
+
+    // Захват слота (ограниченная MPMC очередь Вьюкова, здесь с одним потребителем)
+    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots_[pos & (kCapacity - 1)];
+        const std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Буфер полон: не блокируем рабочий поток
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->length = static_cast<std::uint32_t>(line.size());
+    std::memcpy(slot->data, line.data(), line.size());
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    if (writer_sleeping_.load(std::memory_order_relaxed)) {
+        wake_.notify_one();
+    }
+}
+
+std::size_t Logger::drain(std::string& batch) {
+    std::size_t count = 0;
+    for (;;) {
+        Slot& slot = slots_[dequeue_pos_ & (kCapacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+            break;
+        }
+        batch.append(slot.data, slot.length);
+        slot.sequence.store(dequeue_pos_ + kCapacity, std::memory_order_release);
+        ++dequeue_pos_;
+        ++count;
+    }
+
+    const std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped_) {
+        char ts_buf[32];
+        serializer::JsonWriter writer(batch);
+        writer.beginObject(0);
+        writer.key("ts");
+        writer.string(timestamp(ts_buf));
+        writer.key("level");
+        writer.string(levelName(Level::WARN));
+        writer.key("msg");
+        writer.string("Log records dropped: buffer full");
+        writer.key("dropped");
+        writer.integer(static_cast<std::int64_t>(dropped - reported_dropped_));
+        writer.key("dropped_total");
+        writer.integer(static_cast<std::int64_t>(dropped));
+        writer.endObject();
+        batch.push_back('\n');
+        reported_dropped_ = dropped;
+    }
+    return count;
+}
+
+void Logger::writeOut(const std::string& batch) {
+    std::size_t written = 0;
+    while (written < batch.size()) {
+        const ssize_t n = ::write(STDERR_FILENO, batch.data() + written, batch.size() - written);
+        if (n <= 0) {
+            break;
+        }
+        written += static_cast<std::size_t>(n);
+    }
+}
+
+void Logger::writerLoop() {
+    std::string batch;
+    batch.reserve(64 * 1024);
+
+    while (running_.load(std::memory_order_acquire)) {
+        batch.clear();
+        if (drain(batch) > 0 || !batch.empty()) {
+            writeOut(batch);
+            continue;
+        }
+
+        // Пробуждение по записи; таймаут страхует от пропущенного notify
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        writer_sleeping_.store(true, std::memory_order_relaxed);
+        wake_.wait_for(lock, std::chrono::milliseconds(50));
+        writer_sleeping_.store(false, std::memory_order_relaxed);
+    }
+
+    batch.clear();
+    drain(batch);
+    writeOut(batch);
+}
+
+void Logger::restart() {
+    // После shutdown очередь пуста: фоновый поток дописал ее перед выходом
+    if (running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread([this] { writerLoop(); });
+}
+
+void Logger::shutdown() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+bool RateLimiter::allow() {
+    const std::uint32_t limit = Logger::instance().rateLimit();
+    if (limit == 0) {
+        return true;
+    }
+
+    const std::int64_t now = steadySeconds();
+    std::int64_t window = window_.load(std::memory_order_relaxed);
+    if (window != now && window_.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+        count_.store(0, std::memory_order_relaxed);
+    }
+
+    if (count_.fetch_add(1, std::memory_order_relaxed) < limit) {
+        return true;
+    }
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+} // namespace logger
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace logger {
+
+enum class Level {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR
+};
+
+Level levelFromString(const std::string& name, Level fallback = Level::INFO);
+
+// Поле структурированной записи: ключ и значение (строка, число или bool)
+class Field {
+public:
+    Field(const char* key, std::string_view value) : key_(key), type_(Type::STRING), text_(value) {}
+    Field(const char* key, const char* value) : Field(key, std::string_view(value)) {}
+    Field(const char* key, const std::string& value) : Field(key, std::string_view(value)) {}
+    Field(const char* key, long long value) : key_(key), type_(Type::INT) { number_.i = value; }
+    Field(const char* key, long value) : Field(key, static_cast<long long>(value)) {}
+    Field(const char* key, int value) : Field(key, static_cast<long long>(value)) {}
+    Field(const char* key, unsigned long long value) : key_(key), type_(Type::UINT) { number_.u = value; }
+    Field(const char* key, unsigned long value) : Field(key, static_cast<unsigned long long>(value)) {}
+    Field(const char* key, unsigned value) : Field(key, static_cast<unsigned long long>(value)) {}
+    Field(const char* key, double value) : key_(key), type_(Type::DOUBLE) { number_.d = value; }
+    Field(const char* key, bool value) : key_(key), type_(Type::BOOL) { number_.b = value; }
+
+private:
+    friend class Logger;
+    enum class Type { STRING, INT, UINT, DOUBLE, BOOL };
+
+    const char* key_;
+    Type type_;
+    std::string_view text_;
+    union {
+        long long i;
+        unsigned long long u;
+        double d;
+        bool b;
+    } number_{};
+};
+
+// Асинхронный логгер: рабочие потоки кладут готовые JSON-строки в
+// lock-free MPSC кольцевой буфер, фоновый поток пишет их в stderr пачками.
+// При переполнении буфера запись отбрасывается и учитывается в счетчике
+class Logger {
+public:
+    static Logger& instance();
+
+    ~Logger();
+
+    void setLevel(Level level) { level_.store(level, std::memory_order_relaxed); }
+    bool enabled(Level level) const { return level >= level_.load(std::memory_order_relaxed); }
+
+    // Сколько записей в секунду пропускает одно место вызова (0 - без ограничения)
+    void setRateLimit(std::uint32_t per_second) { rate_limit_.store(per_second, std::memory_order_relaxed); }
+    std::uint32_t rateLimit() const { return rate_limit_.load(std::memory_order_relaxed); }
+
+    void log(Level level, std::string_view message, std::initializer_list<Field> fields = {}) {
+        write(level, 0, message, fields);
+    }
+
+    // suppressed - сколько записей этого места вызова отброшено ограничителем частоты
+    void write(Level level, std::uint64_t suppressed, std::string_view message,
+               std::initializer_list<Field> fields = {});
+
+    std::uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Дописывает накопленные записи и останавливает фоновый поток
+    void shutdown();
+
+    // Запуск фонового потока после shutdown: в дочернем процессе после fork
+    void restart();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+private:
+    Logger();
+
+    static constexpr std::size_t kCapacity = 4096;      // степень двойки
+    static constexpr std::size_t kSlotSize = 1024 - sizeof(std::atomic<std::size_t>) - sizeof(std::uint32_t);
+
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        std::uint32_t length;
+        char data[kSlotSize];
+    };
+
+    void writerLoop();
+    std::size_t drain(std::string& batch);
+    void writeOut(const std::string& batch);
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(64) std::size_t dequeue_pos_ = 0;
+
+    std::atomic<Level> level_{Level::INFO};
+    std::atomic<std::uint32_t> rate_limit_{100};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint64_t reported_dropped_ = 0;
+
+    std::atomic<bool> running_{true};
+    std::atomic<bool> writer_sleeping_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::thread writer_;
+};
+
+// Ограничитель частоты для одного места вызова (окно в одну секунду)
+class RateLimiter {
+public:
+    bool allow();
+    std::uint64_t takeSuppressed() { return suppressed_.exchange(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::int64_t> window_{0};
+    std::atomic<std::uint32_t> count_{0};
+    std::atomic<std::uint64_t> suppressed_{0};
+};
+
+} // namespace logger
+
+// LOG_ERROR("Message", {{"key", value}, ...}) - у каждого места вызова свой RateLimiter
+#define BOOKSHELF_LOG(level, ...)                                                        \
+    do {                                                                                 \
+        static ::logger::RateLimiter bookshelf_log_limiter_;                             \
+        auto& bookshelf_logger_ = ::logger::Logger::instance();                          \
+        if (bookshelf_logger_.enabled(level) && bookshelf_log_limiter_.allow()) {        \
+            bookshelf_logger_.write(level, bookshelf_log_limiter_.takeSuppressed(),      \
+                                    __VA_ARGS__);                                        \
+        }                                                                                \
+    } while (0)
+
+#define LOG_DEBUG(...) BOOKSHELF_LOG(::logger::Level::DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)  BOOKSHELF_LOG(::logger::Level::INFO, __VA_ARGS__)
+#define LOG_WARN(...)  BOOKSHELF_LOG(::logger::Level::WARN, __VA_ARGS__)
+#define LOG_ERROR(...) BOOKSHELF_LOG(::logger::Level::ERROR, __VA_ARGS__)
@@ -1,42 +1,147 @@
 #include "application_builder.h"
+#include "feed/change_feed.h"
+#include "feed/pg_listener.h"
+#include "feed/shelf_hub.h"
+#include "logger/logger.h"
+#include "server/prefork.h"
+#include "server/readiness.h"
+#include "server/reuse_port.h"
+#include "server/server_tuning.h"
+#include "server/worker_group.h"
 #include <iostream>
+#include <cstdlib>
+#include <future>
 #include <cstring> // для strcmp
 
+namespace {
+
+// Лента и хаб подписок пишут в соединения своими потоками: останавливаются, пока серверы еще не разрушены
+void stopChangeFeed(AppComponents& components) {
+    if (components.change_listener) {
+        components.change_listener->stop();
+    }
+    if (components.change_feed) {
+        components.change_feed->stop();
+    }
+    if (components.shelf_hub) {
+        components.shelf_hub->stop();
+    }
+}
+
+// Сборка приложения и работа сервера до остановки; в prefork-режиме - в каждом обработчике
+int runServer(bool init_database, bool prefork) {
+    try {
+        ApplicationBuilder builder;
+        auto components = builder.buildApplication(init_database);
+        
+        // Получаем конфигурацию из билдера
+        AppConfig config = builder.getConfig();
+        
+        LOG_INFO("Starting server", {
+            {"port", config.server_port},
+            {"database", config.db_name},
+            {"db_host", config.db_host},
+            {"db_port", config.db_port}
+        });
+        
+        // Потоки и таймаут заданы билдером; параметры слушающих сокетов
+        // применяются, когда Crow их уже создал
+        const auto port = static_cast<std::uint16_t>(config.server_port);
+        auto& tuning = server::ServerTuning::instance();
+        auto& readiness = server::Readiness::instance();
+
+        // Общий порт SO_REUSEPORT: ядро шлет соединения процессу, как только он слушает,
+        // поэтому обработчик прогревается до открытия сокета. Один процесс прогревается
+        // в фоне, пока балансировщик ждет /ready
+        if (prefork) {
+            readiness.warmUp();
+        }
+
+        std::future<void> tcp_server;
+        std::future<void> local_server;
+        if (components.app) {
+            tcp_server = components.app->port(port).run_async();
+            components.app->wait_for_server_start();
+            tuning.tuneListenSocket(port);
+        }
+        if (components.local_app) {
+            tuning.prepareUnixSocket();
+            local_server = components.local_app->local_socket_path(tuning.unixSocketPath()).run_async();
+            components.local_app->wait_for_server_start();
+            tuning.tuneUnixSocket();
+        }
+        tuning.logTopology(port);
+        if (!prefork) {
+            readiness.startWarmUp();
+        }
+
+        // Сигнал останавливает оба сервера; при сбое одного останавливаем и второй
+        try {
+            if (tcp_server.valid()) {
+                tcp_server.get();
+            }
+            if (local_server.valid()) {
+                local_server.get();
+            }
+        } catch (...) {
+            for (auto* app : {components.app.get(), components.local_app.get()}) {
+                if (app != nullptr) {
+                    app->stop();
+                }
+            }
+            readiness.stop();
+            stopChangeFeed(components);
+            tuning.removeUnixSocket();
+            throw;
+        }
+        readiness.stop();
+        stopChangeFeed(components);
+        tuning.removeUnixSocket();
+
+        server::WorkerGroup::instance().stopPublishing();
+
+    } catch (const std::exception& e) {
+        LOG_ERROR("Fatal error during application startup", {{"error", e.what()}});
+        logger::Logger::instance().shutdown();
+        return 1;
+    }
+
+    return 0;
+}
+
+} // namespace
+
 int main(int argc, char* argv[]) {
     bool init_database = false;
+    unsigned workers = 0;
     
     // Проверяем аргументы командной строки
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "--init-db") == 0 || strcmp(argv[i], "-i") == 0) {
             init_database = true;
         }
-        // Можно добавить другие флаги, например для порта
+        else if ((strcmp(argv[i], "--workers") == 0 || strcmp(argv[i], "-w") == 0) && i + 1 < argc) {
+            workers = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
         else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             std::cout << "Usage: " << argv[0] << " [options]" << std::endl;
             std::cout << "Options:" << std::endl;
             std::cout << "  -i, --init-db    Initialize database schema" << std::endl;
+            std::cout << "  -w, --workers N  Run N server processes sharing the port (SO_REUSEPORT)" << std::endl;
             std::cout << "  -h, --help       Show this help message" << std::endl;
             return 0;
         }
     }
 
-    try {
-        ApplicationBuilder builder;
-        auto components = builder.buildApplication(init_database);
-        
-        // Получаем конфигурацию из билдера
-        AppConfig config = builder.getConfig();
-        
-        std::cout << "Starting server on port " << config.server_port << "..." << std::endl;
-        std::cout << "Database: " << config.db_name << " on " << config.db_host << ":" << config.db_port << std::endl;
-        
-        // Используем порт из конфигурации
-        components.app->port(config.server_port).multithreaded().run();
+    if (workers == 0) {
+        return runServer(init_database, false);
+    }
 
-    } catch (const std::exception& e) {
-        std::cerr << "Fatal error during application startup: " << e.what() << std::endl;
+    // Схему создает один процесс: обработчики стартуют одновременно
+    if (init_database) {
+        std::cerr << "--init-db cannot be combined with --workers: initialize the database first" << std::endl;
         return 1;
     }
-
-    return 0;
-}
\ No newline at end of file
+    server::enableReusePort();
+    return server::runPrefork(workers, [] { return runServer(false, true); });
+}
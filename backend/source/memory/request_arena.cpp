@@ -0,0 +1,107 @@
+#include "memory/request_arena.h"
+#include "debug/heap_profiler.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace memory {
+
+namespace {
+
+// Константная инициализация: безопасно использовать из operator new
+// до и после конструкторов/деструкторов thread_local объектов
+thread_local AllocationCounters tls_counters;
+
+void* countedAllocate(std::size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    ++tls_counters.count;
+    tls_counters.bytes += size;
+    void* ptr = std::malloc(size);
+    debug::HeapProfiler::onAllocate(ptr, size);
+    return ptr;
+}
+
+void* countedAllocateAligned(std::size_t size, std::size_t alignment) {
+    // aligned_alloc требует размер, кратный выравниванию
+    size = (size + alignment - 1) / alignment * alignment;
+    if (size == 0) {
+        size = alignment;
+    }
+    ++tls_counters.count;
+    tls_counters.bytes += size;
+    void* ptr = std::aligned_alloc(alignment, size);
+    debug::HeapProfiler::onAllocate(ptr, size);
+    return ptr;
+}
+
+void countedFree(void* ptr) {
+    debug::HeapProfiler::onFree(ptr);
+    std::free(ptr);
+}
+
+} // namespace
+
+AllocationCounters threadAllocationCounters() {
+    return tls_counters;
+}
+
+RequestArena& RequestArena::current() {
+    thread_local RequestArena arena;
+    return arena;
+}
+
+RequestArena::RequestArena()
+    : resource_(initial_buffer_, sizeof(initial_buffer_), std::pmr::new_delete_resource()) {}
+
+RequestScope::RequestScope()
+    : start_(tls_counters) {}
+
+RequestScope::~RequestScope() {
+    RequestArena::current().reset();
+}
+
+std::uint64_t RequestScope::allocations() const {
+    return tls_counters.count - start_.count;
+}
+
+std::uint64_t RequestScope::allocatedBytes() const {
+    return tls_counters.bytes - start_.bytes;
+}
+
+} // namespace memory
+
+// Замена глобальных operator new/delete для подсчета выделений по потокам.
+// Остальные формы (new[], nothrow) по умолчанию вызывают эти.
+// Выровненные версии нужны отдельно: через них выделяет std::pmr::new_delete_resource().
+// Через эти же функции работает сэмплирующий профилировщик кучи (/debug/heap)
+void* operator new(std::size_t size) {
+    if (void* ptr = memory::countedAllocate(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = memory::countedAllocateAligned(size, static_cast<std::size_t>(alignment))) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    memory::countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    memory::countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    memory::countedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    memory::countedFree(ptr);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace memory {
+
+// Счетчики выделений кучи (operator new) в текущем потоке
+struct AllocationCounters {
+    std::uint64_t count = 0;
+    std::uint64_t bytes = 0;
+};
+
+AllocationCounters threadAllocationCounters();
+
+// Монотонная арена на время обработки одного запроса.
+// Своя у каждого потока Crow; память возвращается целиком в reset()
+class RequestArena {
+public:
+    static RequestArena& current();
+
+    std::pmr::memory_resource* resource() { return &resource_; }
+    void reset() { resource_.release(); }
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+private:
+    RequestArena();
+
+    // Первые 16 КБ берутся из буфера внутри потока, дальше - из кучи
+    static constexpr std::size_t kInitialBufferSize = 16 * 1024;
+
+    alignas(std::max_align_t) std::byte initial_buffer_[kInitialBufferSize];
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
+// Область обработки запроса: запоминает счетчики выделений на входе
+// и сбрасывает арену на выходе
+class RequestScope {
+public:
+    RequestScope();
+    ~RequestScope();
+
+    RequestScope(const RequestScope&) = delete;
+    RequestScope& operator=(const RequestScope&) = delete;
+
+    // Выделений кучи с начала запроса
+    std::uint64_t allocations() const;
+    std::uint64_t allocatedBytes() const;
+
+private:
+    AllocationCounters start_;
+};
+
+} // namespace memory
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace metrics {
+
+// Лог-линейная шкала в духе HdrHistogram: каждая степень двойки делится на
+// kSubBuckets равных интервалов, относительная погрешность не больше 1/kSubBuckets.
+// Значения - наносекунды, всё выше ~68 с попадает в последний интервал
+struct LogLinearScale {
+    static constexpr unsigned kSubBucketBits = 3;
+    static constexpr std::uint64_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr unsigned kMaxExponent = 36;
+    static constexpr std::size_t kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+    static constexpr std::size_t index(std::uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<std::size_t>(value);
+        }
+        if (value >= (std::uint64_t{1} << kMaxExponent)) {
+            return kBucketCount - 1;
+        }
+        const unsigned exponent = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        const unsigned shift = exponent - kSubBucketBits;
+        return (shift + 1) * kSubBuckets + static_cast<std::size_t>((value >> shift) - kSubBuckets);
+    }
+
+    // Нижняя граница интервала (включительно)
+    static constexpr std::uint64_t lowerBound(std::size_t idx) {
+        if (idx < kSubBuckets) {
+            return idx;
+        }
+        const std::size_t shift = idx / kSubBuckets - 1;
+        return (kSubBuckets + idx % kSubBuckets) << shift;
+    }
+
+    // Верхняя граница интервала (не включительно)
+    static constexpr std::uint64_t upperBound(std::size_t idx) {
+        return lowerBound(idx + 1);
+    }
+};
+
+static_assert(LogLinearScale::index(LogLinearScale::lowerBound(100)) == 100);
+static_assert(LogLinearScale::index(LogLinearScale::upperBound(100) - 1) == 100);
+
+// Гистограмма без синхронизации: для агрегированных снимков и однопоточных утилит
+class Histogram {
+public:
+    void record(std::uint64_t value, std::uint64_t times = 1) {
+        counts_[LogLinearScale::index(value)] += times;
+        count_ += times;
+        sum_ += value * times;
+    }
+
+    void addBucket(std::size_t idx, std::uint64_t times) {
+        counts_[idx] += times;
+        count_ += times;
+    }
+
+    void addSum(std::uint64_t sum) { sum_ += sum; }
+
+    void merge(const Histogram& other) {
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+    }
+
+    void reset() {
+        counts_.fill(0);
+        count_ = 0;
+        sum_ = 0;
+    }
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t sum() const { return sum_; }
+    std::uint64_t bucket(std::size_t idx) const { return counts_[idx]; }
+
+    // Число значений, которые гарантированно не больше limit
+    std::uint64_t countAtOrBelow(std::uint64_t limit) const {
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < counts_.size() && LogLinearScale::upperBound(i) - 1 <= limit; ++i) {
+            total += counts_[i];
+        }
+        return total;
+    }
+
+    // Значение квантиля q (0..1): верхняя граница интервала, как highestEquivalentValue в HDR
+    std::uint64_t valueAtQuantile(double q) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count_) + 0.5);
+        if (rank == 0) {
+            rank = 1;
+        }
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return LogLinearScale::upperBound(i) - 1;
+            }
+        }
+        return LogLinearScale::upperBound(counts_.size() - 1) - 1;
+    }
+
+private:
+    std::array<std::uint64_t, LogLinearScale::kBucketCount> counts_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+};
+
+} // namespace metrics
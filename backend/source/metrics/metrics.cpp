@@ -0,0 +1,345 @@
+#include "metrics/metrics.h"
+#include "metrics/histogram.h"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+
+namespace metrics {
+
+namespace {
+
+// Коды ответа, которые отдает сервис; остальные попадают в "other"
+constexpr std::array<int, 10> kStatusCodes = {200, 201, 204, 400, 404, 405, 409, 413, 500, 503};
+constexpr std::size_t kStatusSlots = kStatusCodes.size() + 1;
+
+std::size_t statusSlot(int code) {
+    for (std::size_t i = 0; i < kStatusCodes.size(); ++i) {
+        if (kStatusCodes[i] == code) {
+            return i;
+        }
+    }
+    return kStatusCodes.size();
+}
+
+// Счетчик с единственным писателем: load+store вместо fetch_add, без lock-префикса
+inline void bump(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// Гистограмма шарда: пишет один поток, читает сборщик /metrics
+struct ShardHistogram {
+    std::array<std::atomic<std::uint64_t>, LogLinearScale::kBucketCount> counts{};
+    std::atomic<std::uint64_t> sum{0};
+
+    void record(std::uint64_t value) {
+        bump(counts[LogLinearScale::index(value)], 1);
+        bump(sum, value);
+    }
+
+    void addTo(Histogram& out) const {
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            if (const auto n = counts[i].load(std::memory_order_relaxed)) {
+                out.addBucket(i, n);
+            }
+        }
+        out.addSum(sum.load(std::memory_order_relaxed));
+    }
+};
+
+// Границы бакетов Prometheus, секунды
+constexpr std::array<double, 14> kExportBuckets = {
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+constexpr std::array<double, 4> kExportQuantiles = {0.5, 0.9, 0.99, 0.999};
+
+void appendNumber(std::string& out, double value) {
+    char buf[32];
+    const int len = std::snprintf(buf, sizeof(buf), "%.9g", value);
+    out.append(buf, static_cast<std::size_t>(len));
+}
+
+void appendNumber(std::string& out, std::uint64_t value) {
+    out += std::to_string(value);
+}
+
+double seconds(std::uint64_t ns) {
+    return static_cast<double>(ns) / 1e9;
+}
+
+void appendHeader(std::string& out, const char* name, const char* help, const char* type) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+// Гистограмма и квантили в секундах; labels - уже готовые пары без фигурных скобок
+void appendHistogram(std::string& out, const char* name, const std::string& labels, const Histogram& hist) {
+    for (double le : kExportBuckets) {
+        out += name;
+        out += "_bucket{" + labels + ",le=\"";
+        appendNumber(out, le);
+        out += "\"} ";
+        appendNumber(out, hist.countAtOrBelow(static_cast<std::uint64_t>(le * 1e9)));
+        out += '\n';
+    }
+    out += name;
+    out += "_bucket{" + labels + ",le=\"+Inf\"} ";
+    appendNumber(out, hist.count());
+    out += '\n';
+
+    out += name;
+    out += "_sum{" + labels + "} ";
+    appendNumber(out, seconds(hist.sum()));
+    out += '\n';
+
+    out += name;
+    out += "_count{" + labels + "} ";
+    appendNumber(out, hist.count());
+    out += '\n';
+}
+
+void appendQuantiles(std::string& out, const char* name, const std::string& labels, const Histogram& hist) {
+    for (double q : kExportQuantiles) {
+        out += name;
+        out += '{' + labels + ",quantile=\"";
+        appendNumber(out, q);
+        out += "\"} ";
+        appendNumber(out, seconds(hist.valueAtQuantile(q)));
+        out += '\n';
+    }
+}
+
+std::string routeLabels(std::size_t route) {
+    return std::string("route=\"") + routeLabel(static_cast<RouteId>(route)) + '"';
+}
+
+} // namespace
+
+struct Registry::Shard {
+    std::array<std::array<std::atomic<std::uint64_t>, kStatusSlots>, kRouteCount> requests{};
+    std::array<ShardHistogram, kRouteCount> latency;
+    std::array<std::array<ShardHistogram, kPhaseCount>, kRouteCount> phases;
+    std::array<std::atomic<std::uint64_t>, kRouteCount> allocations{};
+    std::array<std::atomic<std::uint64_t>, kRouteCount> allocated_bytes{};
+};
+
+const char* routeLabel(RouteId route) {
+    switch (route) {
+        case RouteId::GET_BOOKS: return "GET /api/books";
+        case RouteId::GET_BOOK: return "GET /api/books/<id>";
+        case RouteId::CREATE_BOOK: return "POST /api/books";
+        case RouteId::UPDATE_BOOK: return "PUT /api/books/<id>";
+        case RouteId::DELETE_BOOK: return "DELETE /api/books/<id>";
+        case RouteId::GET_STATS: return "GET /api/stats";
+        case RouteId::BOOK_CHANGES: return "GET /api/books/changes";
+        case RouteId::SEARCH_BOOKS: return "GET /api/books/search";
+        case RouteId::HEALTH: return "GET /health";
+        case RouteId::METRICS: return "GET /metrics";
+        case RouteId::READY: return "GET /ready";
+        case RouteId::DEBUG: return "GET /debug/*";
+        case RouteId::UNMATCHED:
+        default: return "unmatched";
+    }
+}
+
+const char* phaseLabel(Phase phase) {
+    switch (phase) {
+        case Phase::PARSE: return "parse";
+        case Phase::CHECKOUT: return "checkout";
+        case Phase::QUERY: return "sql";
+        case Phase::MAPPING: return "map";
+        case Phase::SERIALIZE: return "serialize";
+        default: return "unknown";
+    }
+}
+
+RequestState& currentRequest() {
+    thread_local RequestState state;
+    return state;
+}
+
+namespace {
+std::atomic<bool> sql_timing_detail{false};
+} // namespace
+
+void setSqlTimingDetail(bool enabled) {
+    sql_timing_detail.store(enabled, std::memory_order_relaxed);
+}
+
+bool sqlTimingDetail() {
+    return sql_timing_detail.load(std::memory_order_relaxed);
+}
+
+Registry& Registry::instance() {
+    static Registry registry;
+    return registry;
+}
+
+Registry::Shard& Registry::localShard() {
+    // Шард создается при первом запросе потока и живет до конца процесса
+    thread_local Shard* shard = nullptr;
+    if (shard == nullptr) {
+        auto owned = std::make_unique<Shard>();
+        std::lock_guard<std::mutex> lock(mutex_);
+        shards_.push_back(owned.get());
+        shard = owned.release();
+    }
+    return *shard;
+}
+
+void Registry::recordRequest(RouteId route, int status_code, std::uint64_t total_ns, const RequestState& state,
+                             std::uint64_t allocations, std::uint64_t allocated_bytes) {
+    Shard& shard = localShard();
+    const auto r = static_cast<std::size_t>(route);
+
+    bump(shard.requests[r][statusSlot(status_code)], 1);
+    bump(shard.allocations[r], allocations);
+    bump(shard.allocated_bytes[r], allocated_bytes);
+    shard.latency[r].record(total_ns);
+    for (std::size_t p = 0; p < kPhaseCount; ++p) {
+        if (state.phases_seen & (1u << p)) {
+            shard.phases[r][p].record(state.phase_ns[p]);
+        }
+    }
+}
+
+std::vector<RouteAllocationStats> Registry::routeAllocations() const {
+    std::array<RouteAllocationStats, kRouteCount> totals{};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const Shard* shard : shards_) {
+            for (std::size_t r = 0; r < kRouteCount; ++r) {
+                for (const auto& counter : shard->requests[r]) {
+                    totals[r].requests += counter.load(std::memory_order_relaxed);
+                }
+                totals[r].allocations += shard->allocations[r].load(std::memory_order_relaxed);
+                totals[r].allocated_bytes += shard->allocated_bytes[r].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::vector<RouteAllocationStats> result;
+    for (std::size_t r = 0; r < kRouteCount; ++r) {
+        if (totals[r].requests > 0) {
+            totals[r].route = routeLabel(static_cast<RouteId>(r));
+            result.push_back(totals[r]);
+        }
+    }
+    return result;
+}
+
+void Registry::addSample(std::string name, std::string help, SampleType type, SampleFn fn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.push_back({std::move(name), std::move(help), type, std::move(fn)});
+}
+
+std::string Registry::renderPrometheus() const {
+    // Сумма по шардам; сами шарды не блокируются
+    std::array<std::array<std::uint64_t, kStatusSlots>, kRouteCount> requests{};
+    std::array<std::uint64_t, kRouteCount> allocations{};
+    std::array<std::uint64_t, kRouteCount> allocated_bytes{};
+    auto latency = std::make_unique<std::array<Histogram, kRouteCount>>();
+    auto phases = std::make_unique<std::array<std::array<Histogram, kPhaseCount>, kRouteCount>>();
+    std::vector<Sample> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const Shard* shard : shards_) {
+            for (std::size_t r = 0; r < kRouteCount; ++r) {
+                for (std::size_t s = 0; s < kStatusSlots; ++s) {
+                    requests[r][s] += shard->requests[r][s].load(std::memory_order_relaxed);
+                }
+                allocations[r] += shard->allocations[r].load(std::memory_order_relaxed);
+                allocated_bytes[r] += shard->allocated_bytes[r].load(std::memory_order_relaxed);
+                shard->latency[r].addTo((*latency)[r]);
+                for (std::size_t p = 0; p < kPhaseCount; ++p) {
+                    shard->phases[r][p].addTo((*phases)[r][p]);
+                }
+            }
+        }
+        samples = samples_;
+    }
+
+    std::string out;
+    out.reserve(16 * 1024);
+
+    appendHeader(out, "bookshelf_http_requests_total", "Requests by route and status code.", "counter");
+    for (std::size_t r = 0; r < kRouteCount; ++r) {
+        for (std::size_t s = 0; s < kStatusSlots; ++s) {
+            if (requests[r][s] == 0) {
+                continue;
+            }
+            out += "bookshelf_http_requests_total{" + routeLabels(r) + ",code=\"";
+            out += s < kStatusCodes.size() ? std::to_string(kStatusCodes[s]) : "other";
+            out += "\"} ";
+            appendNumber(out, requests[r][s]);
+            out += '\n';
+        }
+    }
+
+    appendHeader(out, "bookshelf_http_request_allocations_total", "Heap allocations made while handling requests.", "counter");
+    for (std::size_t r = 0; r < kRouteCount; ++r) {
+        if (allocations[r] > 0) {
+            out += "bookshelf_http_request_allocations_total{" + routeLabels(r) + "} ";
+            appendNumber(out, allocations[r]);
+            out += '\n';
+        }
+    }
+
+    appendHeader(out, "bookshelf_http_request_allocated_bytes_total", "Heap bytes allocated while handling requests.", "counter");
+    for (std::size_t r = 0; r < kRouteCount; ++r) {
+        if (allocated_bytes[r] > 0) {
+            out += "bookshelf_http_request_allocated_bytes_total{" + routeLabels(r) + "} ";
+            appendNumber(out, allocated_bytes[r]);
+            out += '\n';
+        }
+    }
+
+    appendHeader(out, "bookshelf_http_request_duration_seconds", "Request latency by route.", "histogram");
+    for (std::size_t r = 0; r < kRouteCount; ++r) {
+        if ((*latency)[r].count() > 0) {
+            appendHistogram(out, "bookshelf_http_request_duration_seconds", routeLabels(r), (*latency)[r]);
+        }
+    }
+
+    appendHeader(out, "bookshelf_http_request_duration_quantile_seconds",
+                 "Request latency quantiles by route (log-linear histogram, up to 12.5% error).", "gauge");
+    for (std::size_t r = 0; r < kRouteCount; ++r) {
+        if ((*latency)[r].count() > 0) {
+            appendQuantiles(out, "bookshelf_http_request_duration_quantile_seconds", routeLabels(r), (*latency)[r]);
+        }
+    }
+
+    appendHeader(out, "bookshelf_request_phase_duration_seconds",
+                 "Time spent in request phases (parse, checkout, sql, map, serialize) by route.", "histogram");
+    for (std::size_t r = 0; r < kRouteCount; ++r) {
+        for (std::size_t p = 0; p < kPhaseCount; ++p) {
+            if ((*phases)[r][p].count() == 0) {
+                continue;
+            }
+            const std::string labels = routeLabels(r) + ",phase=\"" + phaseLabel(static_cast<Phase>(p)) + '"';
+            appendHistogram(out, "bookshelf_request_phase_duration_seconds", labels, (*phases)[r][p]);
+        }
+    }
+
+    for (const auto& sample : samples) {
+        appendHeader(out, sample.name.c_str(), sample.help.c_str(),
+                     sample.type == SampleType::COUNTER ? "counter" : "gauge");
+        out += sample.name;
+        out += ' ';
+        appendNumber(out, sample.fn());
+        out += '\n';
+    }
+
+    return out;
+}
+
+} // namespace metrics
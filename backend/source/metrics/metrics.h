@@ -0,0 +1,173 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace metrics {
+
+// Маршруты API: фиксированный набор, чтобы счетчики были плоскими массивами
+enum class RouteId : std::uint8_t {
+    GET_BOOKS,
+    GET_BOOK,
+    CREATE_BOOK,
+    UPDATE_BOOK,
+    DELETE_BOOK,
+    GET_STATS,
+    BOOK_CHANGES,
+    SEARCH_BOOKS,
+    HEALTH,
+    METRICS,
+    READY,
+    DEBUG,
+    UNMATCHED,
+    COUNT
+};
+
+// Этапы обработки запроса, время которых учитывается отдельно
+enum class Phase : std::uint8_t {
+    PARSE,          // разбор тела запроса
+    CHECKOUT,       // ожидание соединения из пула
+    QUERY,          // выполнение SQL (вместе с commit)
+    MAPPING,        // преобразование строк результата в BookRow
+    SERIALIZE,      // сборка тела ответа
+    COUNT
+};
+
+constexpr std::size_t kRouteCount = static_cast<std::size_t>(RouteId::COUNT);
+constexpr std::size_t kPhaseCount = static_cast<std::size_t>(Phase::COUNT);
+constexpr std::size_t kMaxQueryTimings = 8;
+
+const char* routeLabel(RouteId route);
+const char* phaseLabel(Phase phase);
+
+// Состояние текущего запроса в потоке обработчика.
+// Заполняется обработчиком (маршрут, этапы), сбрасывается и сдается middleware
+struct RequestState {
+    struct QueryTiming {
+        const char* name;
+        std::uint64_t ns;
+    };
+
+    RouteId route = RouteId::UNMATCHED;
+    std::uint8_t phases_seen = 0;
+    std::uint64_t phase_ns[kPhaseCount] = {};
+
+    // Время отдельных запросов к БД, если включена детализация SQL
+    std::uint8_t query_count = 0;
+    QueryTiming queries[kMaxQueryTimings] = {};
+
+    void addPhase(Phase phase, std::uint64_t ns) {
+        const auto idx = static_cast<std::size_t>(phase);
+        phase_ns[idx] += ns;
+        phases_seen |= static_cast<std::uint8_t>(1u << idx);
+    }
+};
+
+RequestState& currentRequest();
+
+inline void setRoute(RouteId route) { currentRequest().route = route; }
+
+inline std::uint64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// Выделения кучи по маршруту (сумма по всем потокам)
+struct RouteAllocationStats {
+    const char* route;
+    std::uint64_t requests;
+    std::uint64_t allocations;
+    std::uint64_t allocated_bytes;
+};
+
+// Замер этапа на время жизни объекта; вложенные и повторные замеры суммируются
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase phase)
+        : phase_(phase), start_(std::chrono::steady_clock::now()) {}
+
+    ~PhaseTimer() { currentRequest().addPhase(phase_, elapsedNs(start_)); }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Детализация SQL в Server-Timing (отладочный переключатель)
+void setSqlTimingDetail(bool enabled);
+bool sqlTimingDetail();
+
+// Замер одного запроса к БД: идет в этап QUERY и, при включенной
+// детализации, отдельной строкой в Server-Timing. name - статическая строка
+class QueryTimer {
+public:
+    explicit QueryTimer(const char* name)
+        : name_(name), start_(std::chrono::steady_clock::now()) {}
+
+    ~QueryTimer() {
+        const std::uint64_t ns = elapsedNs(start_);
+        auto& state = currentRequest();
+        state.addPhase(Phase::QUERY, ns);
+        if (sqlTimingDetail() && state.query_count < kMaxQueryTimings) {
+            state.queries[state.query_count++] = {name_, ns};
+        }
+    }
+
+    QueryTimer(const QueryTimer&) = delete;
+    QueryTimer& operator=(const QueryTimer&) = delete;
+
+private:
+    const char* name_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Реестр метрик. Запись идет в шард текущего потока (один писатель,
+// без атомарных RMW и блокировок), при выдаче /metrics шарды суммируются
+class Registry {
+public:
+    static Registry& instance();
+
+    void recordRequest(RouteId route, int status_code, std::uint64_t total_ns, const RequestState& state,
+                       std::uint64_t allocations, std::uint64_t allocated_bytes);
+
+    // Для /debug/heap: только маршруты, по которым были запросы
+    std::vector<RouteAllocationStats> routeAllocations() const;
+
+    // Значение, которое снимается в момент выдачи (размер пула, счетчики внешних компонентов)
+    enum class SampleType { GAUGE, COUNTER };
+    using SampleFn = std::function<double()>;
+    void addSample(std::string name, std::string help, SampleType type, SampleFn fn);
+
+    // Текст в формате Prometheus exposition 0.0.4
+    std::string renderPrometheus() const;
+
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+private:
+    Registry() = default;
+
+    struct Shard;
+    struct Sample {
+        std::string name;
+        std::string help;
+        SampleType type;
+        SampleFn fn;
+    };
+
+    Shard& localShard();
+
+    mutable std::mutex mutex_;          // только регистрация шардов и выборок
+    std::vector<Shard*> shards_;
+    std::vector<Sample> samples_;
+};
+
+} // namespace metrics
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <crow.h>
+#include <chrono>
+#include <thread>
+
+#include "metrics/metrics.h"
+#include "memory/request_arena.h"
+
+namespace metrics {
+
+// Middleware Crow: замеряет полное время обработки и число выделений кучи
+// и пишет их в реестр вместе с маршрутом и этапами, которые отметил обработчик.
+// Асинхронный ответ (лента изменений) завершается в другом потоке, где состояние
+// потока принадлежит чужому запросу: обработчик переносит маршрут и этапы в
+// контекст (detach), а счетчики выделений того потока не учитываются
+struct MetricsMiddleware {
+    struct context {
+        std::chrono::steady_clock::time_point start;
+        memory::AllocationCounters allocations;
+        std::thread::id thread;
+        bool detached = false;
+        RequestState detached_state;
+
+        // Состояние запроса для after_handle этого и следующих middleware
+        const RequestState& state() const { return detached ? detached_state : currentRequest(); }
+    };
+
+    // Вызывается обработчиком асинхронного ответа до передачи ответа другому потоку
+    static void detach(context& ctx, RouteId route) {
+        setRoute(route);
+        ctx.detached_state = currentRequest();
+        ctx.detached = true;
+    }
+
+    void before_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+        currentRequest() = RequestState{};
+        ctx.allocations = memory::threadAllocationCounters();
+        ctx.thread = std::this_thread::get_id();
+        ctx.start = std::chrono::steady_clock::now();
+    }
+
+    void after_handle(crow::request& /*req*/, crow::response& res, context& ctx) {
+        const auto& state = ctx.state();
+        const auto allocations = ctx.thread == std::this_thread::get_id() ? memory::threadAllocationCounters()
+                                                                           : ctx.allocations;
+        Registry::instance().recordRequest(state.route, res.code, elapsedNs(ctx.start), state,
+                                           allocations.count - ctx.allocations.count,
+                                           allocations.bytes - ctx.allocations.bytes);
+    }
+};
+
+} // namespace metrics
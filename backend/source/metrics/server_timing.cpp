@@ -0,0 +1,47 @@
+#include "metrics/server_timing.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace metrics {
+
+namespace {
+
+void appendEntry(std::string& out, const char* name, const char* desc, std::uint64_t ns) {
+    if (!out.empty()) {
+        out += ", ";
+    }
+    char buf[128];
+    const double ms = static_cast<double>(ns) / 1e6;
+    const int len = desc != nullptr
+        ? std::snprintf(buf, sizeof(buf), "%s;desc=\"%s\";dur=%.3f", name, desc, ms)
+        : std::snprintf(buf, sizeof(buf), "%s;dur=%.3f", name, ms);
+    if (len > 0) {
+        out.append(buf, std::min(static_cast<std::size_t>(len), sizeof(buf) - 1));
+    }
+}
+
+} // namespace
+
+std::string formatServerTiming(const RequestState& state, std::uint64_t total_ns) {
+    std::string out;
+    out.reserve(160);
+
+    for (std::size_t p = 0; p < kPhaseCount; ++p) {
+        if (state.phases_seen & (1u << p)) {
+            appendEntry(out, phaseLabel(static_cast<Phase>(p)), nullptr, state.phase_ns[p]);
+        }
+    }
+
+    // Детализация SQL: имя метрики q1..qN, в desc - имя запроса
+    for (std::size_t i = 0; i < state.query_count; ++i) {
+        char name[8];
+        std::snprintf(name, sizeof(name), "q%zu", i + 1);
+        appendEntry(out, name, state.queries[i].name, state.queries[i].ns);
+    }
+
+    appendEntry(out, "total", nullptr, total_ns);
+    return out;
+}
+
+} // namespace metrics
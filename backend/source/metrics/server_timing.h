@@ -0,0 +1,36 @@
+#pragma once
+
+#include <crow.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "metrics/metrics.h"
+#include "metrics/metrics_middleware.h"
+
+namespace metrics {
+
+// Значение заголовка Server-Timing (https://www.w3.org/TR/server-timing/):
+// этапы запроса и общее время в миллисекундах
+std::string formatServerTiming(const RequestState& state, std::uint64_t total_ns);
+
+// Middleware Crow: добавляет Server-Timing к каждому ответу.
+// Этапы отмечают обработчики через PhaseTimer/QueryTimer; состояние запроса
+// берется из контекста MetricsMiddleware (all_ctx)
+struct ServerTimingMiddleware {
+    struct context {
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void before_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+        ctx.start = std::chrono::steady_clock::now();
+    }
+
+    template <typename AllContext>
+    void after_handle(crow::request& /*req*/, crow::response& res, context& ctx, AllContext& all_ctx) {
+        const RequestState& state = all_ctx.template get<MetricsMiddleware>().state();
+        res.set_header("Server-Timing", formatServerTiming(state, elapsedNs(ctx.start)));
+    }
+};
+
+} // namespace metrics
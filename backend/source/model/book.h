@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Типизированное представление строки таблицы books
+struct BookRow {
+    int id = 0;
+    std::string title;
+    std::string author;
+    std::optional<int> year;
+    std::string status;
+    std::optional<int> rating;
+    std::string review;        // NULL в БД отдается как пустая строка
+    std::string created_at;
+    std::string updated_at;
+};
+
+// Агрегированная статистика для /api/stats
+struct BookStats {
+    std::vector<std::pair<std::string, int>> by_status;
+    std::optional<double> average_rating;
+    int total_books = 0;
+};
+
+// Позиция keyset-пагинации поиска: ранг и id последней книги страницы.
+// Ранг хранится текстом, как его вернула БД: сравнение должно быть точным
+struct SearchCursor {
+    std::string rank;
+    int id = 0;
+};
+
+// Запрос полнотекстового поиска по названию, автору и отзыву
+struct SearchQuery {
+    std::string text;
+    std::size_t limit = 20;
+    std::optional<SearchCursor> after;
+};
+
+// Найденная книга: ранг и фрагменты-HTML: текст экранирован, совпадения в <mark>...</mark>
+struct SearchHit {
+    BookRow book;
+    std::string rank;
+    std::string title_highlight;
+    std::string snippet;            // из отзыва; пусто, если отзыва нет
+};
+
+// Страница результатов по убыванию ранга; next - позиция следующей страницы
+struct SearchPage {
+    std::vector<SearchHit> hits;
+    std::optional<SearchCursor> next;
+};
+
+// Данные книги из тела POST/PUT запроса.
+// present - битовая маска полей, явно переданных клиентом.
+// Живет только в рамках запроса, поэтому строки берутся из арены запроса
+struct BookInput {
+    enum Field : std::uint32_t {
+        TITLE  = 1u << 0,
+        AUTHOR = 1u << 1,
+        YEAR   = 1u << 2,
+        STATUS = 1u << 3,
+        RATING = 1u << 4,
+        REVIEW = 1u << 5
+    };
+
+    explicit BookInput(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : title(resource), author(resource), status(resource) {}
+
+    std::uint32_t present = 0;
+    std::pmr::string title;
+    std::pmr::string author;
+    std::optional<int> year;
+    std::pmr::string status;
+    std::optional<int> rating;
+    std::optional<std::pmr::string> review;   // создается с тем же аллокатором, что и title
+
+    bool has(Field field) const { return (present & field) != 0; }
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include "model/book.h"
+#include "error_handler/result.h"
+
+// Хранилище книг. Ожидаемые исходы (не найдено, нарушение ограничений)
+// возвращаются в Result, исключения остаются только для сбоев хранилища
+class BookRepository {
+public:
+    virtual ~BookRepository() = default;
+
+    // Список отсортирован по created_at, новые первыми
+    virtual std::vector<BookRow> getAllBooks() = 0;
+    virtual error_handler::Result<BookRow> getBookById(int id) = 0;
+    virtual error_handler::Result<int> createBook(const BookInput& input) = 0;
+    // Меняются только поля, отмеченные в input.present
+    virtual error_handler::Result<BookRow> updateBook(int id, const BookInput& input) = 0;
+    virtual error_handler::Result<void> deleteBook(int id) = 0;
+    virtual BookStats getStats() = 0;
+    // Полнотекстовый поиск; хранилища без индекса отвечают notImplementedError
+    virtual error_handler::Result<SearchPage> searchBooks(const SearchQuery& query) = 0;
+};
@@ -0,0 +1,78 @@
+#include "repository/cached_book_repository.h"
+
+namespace {
+
+// Книга удаляется из кэша и при исключении: изменение могло успеть зафиксироваться
+class InvalidateOnExit {
+public:
+    InvalidateOnExit(cache::SharedBookCache& cache, int id) : cache_(cache), id_(id) {}
+    ~InvalidateOnExit() { cache_.invalidate(id_); }
+
+    InvalidateOnExit(const InvalidateOnExit&) = delete;
+    InvalidateOnExit& operator=(const InvalidateOnExit&) = delete;
+
+private:
+    cache::SharedBookCache& cache_;
+    int id_;
+};
+
+} // namespace
+
+CachedBookRepository::CachedBookRepository(std::shared_ptr<BookRepository> inner,
+                                           std::shared_ptr<cache::SharedBookCache> cache)
+    : inner_(std::move(inner)), cache_(std::move(cache)) {}
+
+std::vector<BookRow> CachedBookRepository::getAllBooks() {
+    return inner_->getAllBooks();
+}
+
+error_handler::Result<BookRow> CachedBookRepository::getBookById(int id) {
+    if (auto cached = cache_->get(id)) {
+        return std::move(*cached);
+    }
+    // Билет до чтения: изменение книги после него отменит заполнение
+    const auto ticket = cache_->fillTicket(id);
+    auto book = inner_->getBookById(id);
+    if (book) {
+        cache_->fill(ticket, book.value());
+    }
+    return book;
+}
+
+error_handler::Result<int> CachedBookRepository::createBook(const BookInput& input) {
+    return inner_->createBook(input);
+}
+
+error_handler::Result<BookRow> CachedBookRepository::updateBook(int id, const BookInput& input) {
+    InvalidateOnExit invalidate(*cache_, id);
+    return inner_->updateBook(id, input);
+}
+
+error_handler::Result<void> CachedBookRepository::deleteBook(int id) {
+    InvalidateOnExit invalidate(*cache_, id);
+    return inner_->deleteBook(id);
+}
+
+std::size_t CachedBookRepository::preload(std::size_t limit) {
+    // Список дает только id: книги читаются по одной, через билеты заполнения,
+    // чтобы изменение во время прогрева не оставило в кэше старую версию
+    const auto books = inner_->getAllBooks();
+    std::size_t loaded = 0;
+    for (const auto& book : books) {
+        if (loaded >= limit) {
+            break;
+        }
+        if (getBookById(book.id)) {
+            ++loaded;
+        }
+    }
+    return loaded;
+}
+
+BookStats CachedBookRepository::getStats() {
+    return inner_->getStats();
+}
+
+error_handler::Result<SearchPage> CachedBookRepository::searchBooks(const SearchQuery& query) {
+    return inner_->searchBooks(query);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+
+#include "repository/book_repository.h"
+#include "cache/shared_book_cache.h"
+
+// Кэш чтения книг по id поверх другого хранилища. Изменения проходят в
+// хранилище, затем книга удаляется из кэша; список и статистика не кэшируются
+class CachedBookRepository : public BookRepository {
+public:
+    CachedBookRepository(std::shared_ptr<BookRepository> inner, std::shared_ptr<cache::SharedBookCache> cache);
+
+    std::vector<BookRow> getAllBooks() override;
+    error_handler::Result<BookRow> getBookById(int id) override;
+    error_handler::Result<int> createBook(const BookInput& input) override;
+    error_handler::Result<BookRow> updateBook(int id, const BookInput& input) override;
+    error_handler::Result<void> deleteBook(int id) override;
+    BookStats getStats() override;
+    error_handler::Result<SearchPage> searchBooks(const SearchQuery& query) override;
+
+    // Прогрев: первые limit книг списка (новые) загружаются в кэш; возвращает их число
+    std::size_t preload(std::size_t limit);
+
+private:
+    std::shared_ptr<BookRepository> inner_;
+    std::shared_ptr<cache::SharedBookCache> cache_;
+};
@@ -0,0 +1,79 @@
+#include "repository/log_book_repository.h"
+#include "logger/logger.h"
+
+#include <vector>
+
+LogBookRepository::LogBookRepository(Settings settings)
+    : settings_(std::move(settings)),
+      log_(std::make_unique<storage::BookLog>(settings_.path, settings_.fsync)) {
+    auto state = log_->replay();
+    load(std::move(state.books), state.next_id);
+
+    background_ = std::thread([this] { backgroundLoop(); });
+}
+
+LogBookRepository::~LogBookRepository() {
+    {
+        std::lock_guard<std::mutex> lock(background_mutex_);
+        stopping_ = true;
+    }
+    background_wake_.notify_one();
+    if (background_.joinable()) {
+        background_.join();
+    }
+}
+
+void LogBookRepository::persistPut(const BookRow& book) {
+    log_->appendPut(book);
+}
+
+void LogBookRepository::persistDelete(int id) {
+    log_->appendDelete(id);
+}
+
+bool LogBookRepository::needsCompaction() const {
+    return log_->fileBytes() >= settings_.compact_min_bytes &&
+           log_->garbageBytes() * 2 > log_->fileBytes();
+}
+
+void LogBookRepository::compact() {
+    // Разделяемая блокировка: чтения продолжаются, записи ждут окончания
+    std::shared_lock lock(mutex_);
+    std::vector<const BookRow*> books;
+    forEachBook([&](const BookRow& book) { books.push_back(&book); });
+    try {
+        log_->compact(books, nextId());
+    } catch (const std::exception& e) {
+        LOG_ERROR("Storage log compaction failed", {{"error", e.what()}});
+    }
+}
+
+void LogBookRepository::backgroundLoop() {
+    const auto tick = settings_.fsync == storage::FsyncPolicy::INTERVAL
+        ? std::min<std::chrono::milliseconds>(settings_.fsync_interval, settings_.compact_interval)
+        : std::chrono::milliseconds(settings_.compact_interval);
+    auto next_compaction_check = std::chrono::steady_clock::now() + settings_.compact_interval;
+
+    std::unique_lock<std::mutex> lock(background_mutex_);
+    while (!background_wake_.wait_for(lock, tick, [this] { return stopping_; })) {
+        lock.unlock();
+
+        if (settings_.fsync == storage::FsyncPolicy::INTERVAL) {
+            log_->sync();
+        }
+
+        if (std::chrono::steady_clock::now() >= next_compaction_check) {
+            next_compaction_check = std::chrono::steady_clock::now() + settings_.compact_interval;
+            bool compaction_due;
+            {
+                std::shared_lock state_lock(mutex_);
+                compaction_due = needsCompaction();
+            }
+            if (compaction_due) {
+                compact();
+            }
+        }
+
+        lock.lock();
+    }
+}
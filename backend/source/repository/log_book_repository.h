@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "repository/memory_book_repository.h"
+#include "storage/book_log.h"
+
+// Встроенное хранилище для одного узла: данные и индексы (id, created_at)
+// в памяти процесса, каждое изменение до применения дописывается в журнал
+// на диске. При старте журнал воспроизводится; фоновый поток сбрасывает
+// журнал на диск (политика INTERVAL) и уплотняет его, когда мусора больше,
+// чем живых данных
+class LogBookRepository : public InMemoryBookRepository {
+public:
+    struct Settings {
+        std::string path = "bookshelf.log";
+        storage::FsyncPolicy fsync = storage::FsyncPolicy::INTERVAL;
+        std::chrono::milliseconds fsync_interval{100};
+        std::chrono::seconds compact_interval{60};
+        std::uint64_t compact_min_bytes = 4 * 1024 * 1024;   // меньше - не уплотняем
+    };
+
+    explicit LogBookRepository(Settings settings);
+    ~LogBookRepository() override;
+
+protected:
+    void persistPut(const BookRow& book) override;
+    void persistDelete(int id) override;
+
+private:
+    void backgroundLoop();
+    bool needsCompaction() const;
+    // Только из фонового потока: sync идет из него же и не пересекается с подменой файла
+    void compact();
+
+    Settings settings_;
+    std::unique_ptr<storage::BookLog> log_;
+
+    std::mutex background_mutex_;
+    std::condition_variable background_wake_;
+    bool stopping_ = false;
+    std::thread background_;
+};
@@ -0,0 +1,231 @@
+#include "repository/memory_book_repository.h"
+#include "error_handler.h"
+#include "metrics/metrics.h"
+#include "serializer/book_input_parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <optional>
+
+namespace {
+
+// Текущее время как его выводит PostgreSQL для TIMESTAMP:
+// локальное время, микросекунды без хвостовых нулей
+std::string currentTimestamp() {
+    const auto now = std::chrono::system_clock::now();
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    const std::time_t seconds = static_cast<std::time_t>(us / 1000000);
+    std::tm tm{};
+    localtime_r(&seconds, &tm);
+
+    char buf[40];
+    int len = std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d",
+                            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                            tm.tm_hour, tm.tm_min, tm.tm_sec);
+    if (const int fraction = static_cast<int>(us % 1000000); fraction != 0) {
+        len += std::snprintf(buf + len, sizeof(buf) - static_cast<std::size_t>(len), ".%06d", fraction);
+        while (buf[len - 1] == '0') {
+            --len;
+        }
+    }
+    return std::string(buf, static_cast<std::size_t>(len));
+}
+
+error_handler::ErrorDetails bookNotFound(int id) {
+    return error_handler::notFoundError(
+        "Book not found",
+        "Book with id " + std::to_string(id) + " does not exist"
+    );
+}
+
+// Ограничения столбцов таблицы books. Превышение длины VARCHAR в PostgreSQL -
+// ошибка данных, а не нарушение ограничения, поэтому оно идет исключением.
+// Длина, как и в VARCHAR(n), в символах, а не в байтах
+std::optional<error_handler::ErrorDetails> checkConstraints(const BookRow& book) {
+    auto tooLong = [](const std::string& value, std::size_t limit) {
+        if (serializer::utf8Length(value) > limit) {
+            throw error_handler::DatabaseException(
+                "Database query failed",
+                "value too long for type character varying(" + std::to_string(limit) + ")"
+            );
+        }
+    };
+    tooLong(book.title, 255);
+    tooLong(book.author, 255);
+    tooLong(book.status, 50);
+
+    if (book.rating.has_value() && (*book.rating < 1 || *book.rating > 5)) {
+        return error_handler::validationError(
+            "Constraint violation",
+            "new row for relation \"books\" violates check constraint \"books_rating_check\""
+        );
+    }
+    return std::nullopt;
+}
+
+void applyInput(BookRow& book, const BookInput& input) {
+    if (input.has(BookInput::TITLE)) book.title.assign(input.title);
+    if (input.has(BookInput::AUTHOR)) book.author.assign(input.author);
+    if (input.has(BookInput::YEAR)) book.year = input.year;
+    if (input.has(BookInput::STATUS)) book.status.assign(input.status);
+    if (input.has(BookInput::RATING)) book.rating = input.rating;
+    if (input.has(BookInput::REVIEW)) {
+        // NULL в БД отдается как пустая строка
+        if (input.review.has_value()) {
+            book.review.assign(*input.review);
+        } else {
+            book.review.clear();
+        }
+    }
+}
+
+} // namespace
+
+std::vector<BookRow> InMemoryBookRepository::getAllBooks() {
+    metrics::QueryTimer timer("books.select_all");
+    std::shared_lock lock(mutex_);
+
+    // ORDER BY created_at DESC
+    std::vector<BookRow> books;
+    books.reserve(books_.size());
+    for (auto it = by_created_at_.rbegin(); it != by_created_at_.rend(); ++it) {
+        books.push_back(books_.find(it->second)->second);
+    }
+    return books;
+}
+
+error_handler::Result<BookRow> InMemoryBookRepository::getBookById(int id) {
+    metrics::QueryTimer timer("books.select_by_id");
+    std::shared_lock lock(mutex_);
+
+    const auto it = books_.find(id);
+    if (it == books_.end()) {
+        return bookNotFound(id);
+    }
+    return it->second;
+}
+
+error_handler::Result<int> InMemoryBookRepository::createBook(const BookInput& input) {
+    metrics::QueryTimer timer("books.insert");
+
+    BookRow book;
+    book.status = "planned";
+    applyInput(book, input);
+
+    // Проверка до выдачи номера: отклоненная вставка id не расходует
+    if (auto error = checkConstraints(book)) {
+        return std::move(*error);
+    }
+
+    std::unique_lock lock(mutex_);
+    book.id = next_id_++;
+    book.created_at = currentTimestamp();
+    book.updated_at = book.created_at;
+
+    persistPut(book);
+    account(book, +1);
+    const int id = book.id;
+    books_.emplace(id, std::move(book));
+    return id;
+}
+
+error_handler::Result<BookRow> InMemoryBookRepository::updateBook(int id, const BookInput& input) {
+    if (input.present == 0) {
+        return getBookById(id);
+    }
+
+    metrics::QueryTimer timer("books.update");
+    std::unique_lock lock(mutex_);
+
+    const auto it = books_.find(id);
+    if (it == books_.end()) {
+        return bookNotFound(id);
+    }
+
+    BookRow updated = it->second;
+    applyInput(updated, input);
+    updated.updated_at = currentTimestamp();
+    if (auto error = checkConstraints(updated)) {
+        return std::move(*error);
+    }
+
+    persistPut(updated);
+    account(it->second, -1);
+    account(updated, +1);
+    it->second = updated;
+    return updated;
+}
+
+error_handler::Result<void> InMemoryBookRepository::deleteBook(int id) {
+    metrics::QueryTimer timer("books.delete");
+    std::unique_lock lock(mutex_);
+
+    const auto it = books_.find(id);
+    if (it == books_.end()) {
+        return bookNotFound(id);
+    }
+    persistDelete(id);
+    account(it->second, -1);
+    books_.erase(it);
+    return {};
+}
+
+BookStats InMemoryBookRepository::getStats() {
+    metrics::QueryTimer timer("books.stats");
+    std::shared_lock lock(mutex_);
+
+    BookStats stats;
+    stats.by_status.reserve(status_counts_.size());
+    for (const auto& [status, count] : status_counts_) {
+        stats.by_status.emplace_back(status, count);
+    }
+    if (rating_count_ > 0) {
+        stats.average_rating = static_cast<double>(rating_sum_) / rating_count_;
+    }
+    stats.total_books = static_cast<int>(books_.size());
+    return stats;
+}
+
+error_handler::Result<SearchPage> InMemoryBookRepository::searchBooks(const SearchQuery& /*query*/) {
+    return error_handler::notImplementedError(
+        "Search is not available",
+        "Full-text search requires PostgreSQL storage"
+    );
+}
+
+void InMemoryBookRepository::load(std::unordered_map<int, BookRow> books, int next_id) {
+    std::unique_lock lock(mutex_);
+    books_ = std::move(books);
+    by_created_at_.clear();
+    status_counts_.clear();
+    rating_sum_ = 0;
+    rating_count_ = 0;
+    for (const auto& [id, book] : books_) {
+        account(book, +1);
+    }
+    next_id_ = next_id;
+}
+
+void InMemoryBookRepository::account(const BookRow& book, int delta) {
+    if (delta > 0) {
+        by_created_at_.emplace(book.created_at, book.id);
+    } else {
+        by_created_at_.erase({book.created_at, book.id});
+    }
+
+    auto status = status_counts_.find(book.status);
+    if (status == status_counts_.end()) {
+        status = status_counts_.emplace(book.status, 0).first;
+    }
+    status->second += delta;
+    if (status->second == 0) {
+        status_counts_.erase(status);
+    }
+
+    if (book.rating.has_value()) {
+        rating_sum_ += static_cast<long long>(*book.rating) * delta;
+        rating_count_ += delta;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "repository/book_repository.h"
+
+// Хранилище в памяти процесса с той же семантикой, что и таблица books:
+// id по возрастанию (как SERIAL, но отклоненная вставка номер не тратит),
+// created_at/updated_at в формате TIMESTAMP, status по умолчанию 'planned',
+// CHECK на rating и длины строк в символах. Нужно для нагрузочных тестов без PostgreSQL
+// и как основа встроенного хранилища с журналом (LogBookRepository)
+class InMemoryBookRepository : public BookRepository {
+public:
+    std::vector<BookRow> getAllBooks() override;
+    error_handler::Result<BookRow> getBookById(int id) override;
+    error_handler::Result<int> createBook(const BookInput& input) override;
+    error_handler::Result<BookRow> updateBook(int id, const BookInput& input) override;
+    error_handler::Result<void> deleteBook(int id) override;
+    BookStats getStats() override;
+    error_handler::Result<SearchPage> searchBooks(const SearchQuery& query) override;
+
+protected:
+    // Сохранение изменения до его применения в памяти (под эксклюзивной блокировкой).
+    // Исключение отменяет операцию: состояние в памяти не меняется
+    virtual void persistPut(const BookRow&) {}
+    virtual void persistDelete(int) {}
+
+    // Начальное состояние (например, восстановленное из журнала)
+    void load(std::unordered_map<int, BookRow> books, int next_id);
+
+    // Обход живых книг; вызывающий держит mutex_
+    template <typename Fn>
+    void forEachBook(Fn&& fn) const {
+        for (const auto& [id, book] : books_) {
+            fn(book);
+        }
+    }
+
+    int nextId() const { return next_id_; }
+
+    mutable std::shared_mutex mutex_;
+
+private:
+    // Учет книги в индексе created_at и агрегатах getStats (delta = +1 или -1)
+    void account(const BookRow& book, int delta);
+
+    std::unordered_map<int, BookRow> books_;                  // первичный индекс по id
+    std::set<std::pair<std::string, int>> by_created_at_;     // (created_at, id)
+    int next_id_ = 1;
+
+    std::unordered_map<std::string, int> status_counts_;
+    long long rating_sum_ = 0;
+    int rating_count_ = 0;
+};
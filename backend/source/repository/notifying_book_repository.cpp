@@ -0,0 +1,45 @@
+#include "repository/notifying_book_repository.h"
+
+NotifyingBookRepository::NotifyingBookRepository(std::shared_ptr<BookRepository> inner,
+                                                 std::shared_ptr<feed::ChangeFeed> feed)
+    : inner_(std::move(inner)), feed_(std::move(feed)) {}
+
+std::vector<BookRow> NotifyingBookRepository::getAllBooks() {
+    return inner_->getAllBooks();
+}
+
+error_handler::Result<BookRow> NotifyingBookRepository::getBookById(int id) {
+    return inner_->getBookById(id);
+}
+
+error_handler::Result<int> NotifyingBookRepository::createBook(const BookInput& input) {
+    auto id = inner_->createBook(input);
+    if (id) {
+        feed_->publish(feed::ChangeOp::CREATE, id.value());
+    }
+    return id;
+}
+
+error_handler::Result<BookRow> NotifyingBookRepository::updateBook(int id, const BookInput& input) {
+    auto book = inner_->updateBook(id, input);
+    if (book) {
+        feed_->publish(feed::ChangeOp::UPDATE, id);
+    }
+    return book;
+}
+
+error_handler::Result<void> NotifyingBookRepository::deleteBook(int id) {
+    auto result = inner_->deleteBook(id);
+    if (result) {
+        feed_->publish(feed::ChangeOp::DELETE, id);
+    }
+    return result;
+}
+
+BookStats NotifyingBookRepository::getStats() {
+    return inner_->getStats();
+}
+
+error_handler::Result<SearchPage> NotifyingBookRepository::searchBooks(const SearchQuery& query) {
+    return inner_->searchBooks(query);
+}
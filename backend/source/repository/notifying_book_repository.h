@@ -0,0 +1,26 @@
+#pragma once
+
+#include <memory>
+
+#include "repository/book_repository.h"
+#include "feed/change_feed.h"
+
+// Публикует в ленту изменений успешные изменения другого хранилища.
+// Нужен хранилищам без своего источника уведомлений (память, журнал);
+// изменения PostgreSQL приходят в ленту через LISTEN (feed::PgListener)
+class NotifyingBookRepository : public BookRepository {
+public:
+    NotifyingBookRepository(std::shared_ptr<BookRepository> inner, std::shared_ptr<feed::ChangeFeed> feed);
+
+    std::vector<BookRow> getAllBooks() override;
+    error_handler::Result<BookRow> getBookById(int id) override;
+    error_handler::Result<int> createBook(const BookInput& input) override;
+    error_handler::Result<BookRow> updateBook(int id, const BookInput& input) override;
+    error_handler::Result<void> deleteBook(int id) override;
+    BookStats getStats() override;
+    error_handler::Result<SearchPage> searchBooks(const SearchQuery& query) override;
+
+private:
+    std::shared_ptr<BookRepository> inner_;
+    std::shared_ptr<feed::ChangeFeed> feed_;
+};
@@ -0,0 +1,431 @@
+#include "repository/postgres_book_repository.h"
+#include "error_handler.h"
+#include "metrics/metrics.h"
+#include "db/query_log.h"
+
+#include <pqxx/pqxx>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <algorithm>
+
+namespace {
+
+// Все запросы хранилища; готовятся на каждом соединении пула (prepareStatements)
+constexpr db::Statement kSelectAll{"books.select_all",
+    "SELECT id, title, author, year, status, rating, review, created_at, updated_at "
+    "FROM books ORDER BY created_at DESC"};
+
+// Столбцы перечислены явно: tsvector поиска клиенту не нужен
+constexpr db::Statement kSelectById{"books.select_by_id",
+    "SELECT id, title, author, year, status, rating, review, created_at, updated_at "
+    "FROM books WHERE id = $1"};
+
+// Один INSERT: отсутствующие поля передаются как NULL
+constexpr db::Statement kInsert{"books.insert",
+    "INSERT INTO books (title, author, year, status, rating, review) "
+    "VALUES ($1, $2, $3, $4, $5, $6) RETURNING id"};
+
+// Один UPDATE для всех полей: флаг $2k говорит, передано ли поле в запросе
+constexpr db::Statement kUpdate{"books.update",
+    "UPDATE books SET "
+    "title = CASE WHEN $2 THEN $3 ELSE title END, "
+    "author = CASE WHEN $4 THEN $5 ELSE author END, "
+    "year = CASE WHEN $6 THEN $7::integer ELSE year END, "
+    "status = CASE WHEN $8 THEN $9 ELSE status END, "
+    "rating = CASE WHEN $10 THEN $11::integer ELSE rating END, "
+    "review = CASE WHEN $12 THEN $13 ELSE review END, "
+    "updated_at = CURRENT_TIMESTAMP "
+    "WHERE id = $1 "
+    "RETURNING id, title, author, year, status, rating, review, created_at, updated_at"};
+
+constexpr db::Statement kDelete{"books.delete", "DELETE FROM books WHERE id = $1"};
+
+constexpr db::Statement kCountByStatus{"books.count_by_status",
+    "SELECT status, COUNT(*) as count FROM books GROUP BY status"};
+
+constexpr db::Statement kAvgRating{"books.avg_rating",
+    "SELECT AVG(rating) as avg_rating FROM books WHERE rating IS NOT NULL"};
+
+constexpr db::Statement kCount{"books.count", "SELECT COUNT(*) as total FROM books"};
+
+// Снимок кэша: база и таблица (пересоздание таблицы меняет oid) и время БД.
+// updated_at - TIMESTAMP без зоны, поэтому и время берется как LOCALTIMESTAMP
+constexpr db::Statement kGeneration{"books.generation",
+    "SELECT current_database() || ':' || d.oid || ':' || 'books'::regclass::oid AS generation, "
+    "LOCALTIMESTAMP::text AS db_time "
+    "FROM pg_database d WHERE d.datname = current_database()"};
+
+constexpr db::Statement kChangedSince{"books.changed_since",
+    "SELECT id FROM books WHERE updated_at > $1::timestamp - $2::integer * interval '1 second'"};
+
+constexpr db::Statement kExistingIds{"books.existing_ids",
+    "SELECT id FROM books WHERE id = ANY($1::integer[])"};
+
+// Поиск по индексу GIN на books.search. Ранг и подсветка считаются только для
+// совпавших строк, ts_headline (самая дорогая часть) - только для строк страницы.
+// Keyset-пагинация: строки после ($3 ранг, $4 id) в порядке ранг DESC, id DESC.
+// ts_headline не экранирует текст вокруг совпадений, поэтому совпадения
+// отмечаются символами U+E000/U+E001 (из самого текста они удаляются), а HTML
+// собирается в highlightHtml
+constexpr db::Statement kSearch{"books.search",
+    "WITH q AS (SELECT websearch_to_tsquery($1::regconfig, $2) AS query), "
+    "page AS ("
+    "SELECT b.id, b.title, b.author, b.year, b.status, b.rating, b.review, b.created_at, b.updated_at, "
+    "ts_rank(b.search, q.query) AS rank "
+    "FROM books b, q "
+    "WHERE b.search @@ q.query "
+    "AND ($3::real IS NULL OR (ts_rank(b.search, q.query), b.id) < ($3::real, $4::integer)) "
+    "ORDER BY rank DESC, b.id DESC "
+    "LIMIT $5) "
+    "SELECT page.*, page.rank::text AS rank_text, "
+    "ts_headline($1::regconfig, translate(page.title, '" "\xEE\x80\x80" "\xEE\x80\x81" "', ''), q.query, "
+    "'HighlightAll=true, StartSel=" "\xEE\x80\x80" ", StopSel=" "\xEE\x80\x81" "') AS title_highlight, "
+    "ts_headline($1::regconfig, translate(coalesce(page.review, ''), '" "\xEE\x80\x80" "\xEE\x80\x81" "', ''), "
+    "q.query, 'MaxFragments=2, MaxWords=20, MinWords=5, "
+    "StartSel=" "\xEE\x80\x80" ", StopSel=" "\xEE\x80\x81" "') AS snippet "
+    "FROM page, q "
+    "ORDER BY page.rank DESC, page.id DESC"};
+
+// Метки начала и конца совпадения в выводе ts_headline (UTF-8 U+E000, U+E001)
+constexpr std::string_view kMatchStart = "\xEE\x80\x80";
+constexpr std::string_view kMatchStop = "\xEE\x80\x81";
+
+// Текст с метками совпадений -> HTML: текст экранируется, метки становятся <mark>
+std::string highlightHtml(std::string_view text) {
+    std::string html;
+    html.reserve(text.size() + 32);
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text.compare(i, kMatchStart.size(), kMatchStart) == 0) {
+            html += "<mark>";
+            i += kMatchStart.size() - 1;
+            continue;
+        }
+        if (text.compare(i, kMatchStop.size(), kMatchStop) == 0) {
+            html += "</mark>";
+            i += kMatchStop.size() - 1;
+            continue;
+        }
+        switch (text[i]) {
+            case '&': html += "&amp;"; break;
+            case '<': html += "&lt;"; break;
+            case '>': html += "&gt;"; break;
+            case '"': html += "&quot;"; break;
+            case '\'': html += "&#39;"; break;
+            default: html += text[i];
+        }
+    }
+    return html;
+}
+
+constexpr const db::Statement* kStatements[] = {
+    &kSelectAll, &kSelectById, &kInsert, &kUpdate, &kDelete, &kCountByStatus, &kAvgRating, &kCount,
+    &kGeneration, &kChangedSince, &kExistingIds
+};
+
+// Строки BookInput живут в арене запроса; в pqxx передаем их как const char*,
+// nullptr уходит в запрос как NULL
+const char* nullableText(const std::optional<std::pmr::string>& value) {
+    return value.has_value() ? value->c_str() : nullptr;
+}
+
+error_handler::ErrorDetails bookNotFound(int id) {
+    return error_handler::notFoundError(
+        "Book not found",
+        "Book with id " + std::to_string(id) + " does not exist"
+    );
+}
+
+// Нарушение ограничений таблицы - ошибка в данных клиента, а не сбой БД
+error_handler::ErrorDetails constraintError(const pqxx::integrity_constraint_violation& e) {
+    if (dynamic_cast<const pqxx::unique_violation*>(&e) != nullptr) {
+        return error_handler::conflictError("Book already exists", e.what());
+    }
+    return error_handler::validationError("Constraint violation", e.what());
+}
+
+} // namespace
+
+PostgresBookRepository::PostgresBookRepository(std::shared_ptr<db::ConnectionPool> pool, std::string search_config)
+    : pool_(std::move(pool)), search_config_(std::move(search_config)) {}
+
+void PostgresBookRepository::prepareStatements(pqxx::connection& connection) {
+    for (const db::Statement* statement : kStatements) {
+        db::prepareStatement(connection, *statement);
+    }
+    // Столбец search появляется после --init-db: до этого поиск падает, а остальные
+    // запросы работают, поэтому на сервере он готовится при первом выполнении
+    connection.prepare(kSearch.name, kSearch.sql);
+}
+
+std::vector<BookRow> PostgresBookRepository::getAllBooks() {
+    try {
+        auto connection = checkout();
+        pqxx::work txn(*connection);
+        pqxx::result result = db::timedExec(txn, kSelectAll);
+        db::timedCommit(txn);
+
+        metrics::PhaseTimer map_timer(metrics::Phase::MAPPING);
+        std::vector<BookRow> books;
+        books.reserve(result.size());
+        for (const auto& row : result) {
+            books.push_back(rowToBook(row));
+        }
+        return books;
+
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error in GetAllBooks: " + std::string(e.what()));
+    }
+}
+
+error_handler::Result<BookRow> PostgresBookRepository::getBookById(int id) {
+    try {
+        auto connection = checkout();
+        pqxx::work txn(*connection);
+        pqxx::result result = db::timedExec(txn, kSelectById, id);
+        
+        if (result.empty()) {
+            return bookNotFound(id);
+        }
+        
+        metrics::PhaseTimer map_timer(metrics::Phase::MAPPING);
+        return rowToBook(result[0]);
+        
+    } catch (const pqxx::sql_error& e) {
+        throw error_handler::DatabaseException(
+            "Database query failed",
+            e.what()
+        );
+    }
+}
+
+error_handler::Result<int> PostgresBookRepository::createBook(const BookInput& input) {
+    try {
+        auto connection = checkout();
+        pqxx::work txn(*connection);
+        
+        // status по умолчанию 'planned'
+        pqxx::result result = db::timedExec(txn, kInsert,
+            input.title.c_str(),
+            input.author.c_str(),
+            input.year,
+            input.has(BookInput::STATUS) ? input.status.c_str() : "planned",
+            input.rating,
+            nullableText(input.review)
+        );
+        db::timedCommit(txn);
+
+        return result[0]["id"].as<int>();
+
+    } catch (const pqxx::integrity_constraint_violation& e) {
+        return constraintError(e);
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error in CreateBook: " + std::string(e.what()));
+    }
+}
+
+error_handler::Result<void> PostgresBookRepository::deleteBook(int id) {
+    try {
+        auto connection = checkout();
+        pqxx::work txn(*connection);
+        pqxx::result result = db::timedExec(txn, kDelete, id);
+        db::timedCommit(txn);
+
+        if (result.affected_rows() == 0) {
+            return bookNotFound(id);
+        }
+        return {};
+
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error in DeleteBook: " + std::string(e.what()));
+    }
+}
+
+PostgresBookRepository::Generation PostgresBookRepository::generation() {
+    auto connection = checkout();
+    pqxx::work txn(*connection);
+    pqxx::result result = db::timedExec(txn, kGeneration);
+    db::timedCommit(txn);
+    return {result[0]["generation"].as<std::string>(), result[0]["db_time"].as<std::string>()};
+}
+
+std::vector<int> PostgresBookRepository::changedSince(const std::string& db_time, unsigned window_s) {
+    auto connection = checkout();
+    pqxx::work txn(*connection);
+    pqxx::result result = db::timedExec(txn, kChangedSince, db_time, static_cast<int>(window_s));
+    db::timedCommit(txn);
+
+    std::vector<int> ids;
+    ids.reserve(result.size());
+    for (const auto& row : result) {
+        ids.push_back(row["id"].as<int>());
+    }
+    return ids;
+}
+
+std::vector<int> PostgresBookRepository::existingIds(const std::vector<int>& ids) {
+    std::string array = "{";
+    for (int id : ids) {
+        if (array.size() > 1) {
+            array += ',';
+        }
+        array += std::to_string(id);
+    }
+    array += '}';
+
+    auto connection = checkout();
+    pqxx::work txn(*connection);
+    pqxx::result result = db::timedExec(txn, kExistingIds, array);
+    db::timedCommit(txn);
+
+    std::vector<int> existing;
+    existing.reserve(result.size());
+    for (const auto& row : result) {
+        existing.push_back(row["id"].as<int>());
+    }
+    return existing;
+}
+
+db::ConnectionPool::Lease PostgresBookRepository::checkout() {
+    metrics::PhaseTimer checkout_timer(metrics::Phase::CHECKOUT);
+    return pool_->acquire();
+}
+
+BookRow PostgresBookRepository::rowToBook(const pqxx::row& row) {
+    BookRow book;
+    book.id = row["id"].as<int>();
+    book.title = row["title"].as<std::string>();
+    book.author = row["author"].as<std::string>();
+    
+    // Правильная обработка NULL значений
+    if (!row["year"].is_null()) {
+        book.year = row["year"].as<int>();
+    }
+    
+    book.status = row["status"].as<std::string>();
+    
+    if (!row["rating"].is_null()) {
+        book.rating = row["rating"].as<int>();
+    }
+    
+    if (!row["review"].is_null()) {
+        book.review = row["review"].as<std::string>();
+    }
+    
+    book.created_at = row["created_at"].as<std::string>();
+    book.updated_at = row["updated_at"].as<std::string>();
+
+    return book;
+}
+
+error_handler::Result<BookRow> PostgresBookRepository::updateBook(int id, const BookInput& input) {
+    if (input.present == 0) {
+        return getBookById(id);
+    }
+
+    try {
+        auto connection = checkout();
+        pqxx::work txn(*connection);
+        
+        pqxx::result result = db::timedExec(txn, kUpdate,
+            id,
+            input.has(BookInput::TITLE), input.title.c_str(),
+            input.has(BookInput::AUTHOR), input.author.c_str(),
+            input.has(BookInput::YEAR), input.year,
+            input.has(BookInput::STATUS), input.status.c_str(),
+            input.has(BookInput::RATING), input.rating,
+            input.has(BookInput::REVIEW), nullableText(input.review)
+        );
+        db::timedCommit(txn);
+
+        if (result.empty()) {
+            return bookNotFound(id);
+        }
+
+        metrics::PhaseTimer map_timer(metrics::Phase::MAPPING);
+        return rowToBook(result[0]);
+
+    } catch (const pqxx::integrity_constraint_violation& e) {
+        return constraintError(e);
+    } catch (const pqxx::sql_error& e) {
+        throw error_handler::DatabaseException(
+            "Database query failed",
+            e.what()
+        );
+    }
+}
+
+BookStats PostgresBookRepository::getStats() {
+    try {
+        auto connection = checkout();
+        pqxx::work txn(*connection);
+        
+        pqxx::result status_result = db::timedExec(txn, kCountByStatus);
+        
+        pqxx::result rating_result = db::timedExec(txn, kAvgRating);
+        
+        pqxx::result total_result = db::timedExec(txn, kCount);
+        
+        db::timedCommit(txn);
+
+        metrics::PhaseTimer map_timer(metrics::Phase::MAPPING);
+        BookStats stats;
+        stats.by_status.reserve(status_result.size());
+        
+        for (const auto& row : status_result) {
+            stats.by_status.emplace_back(row["status"].as<std::string>(), row["count"].as<int>());
+        }
+        
+        if (!rating_result[0]["avg_rating"].is_null()) {
+            stats.average_rating = rating_result[0]["avg_rating"].as<double>();
+        }
+            
+        stats.total_books = total_result[0]["total"].as<int>();
+
+        return stats;
+
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Database error in GetStats: " + std::string(e.what()));
+    }
+}
+
+error_handler::Result<SearchPage> PostgresBookRepository::searchBooks(const SearchQuery& query) {
+    try {
+        auto connection = checkout();
+        pqxx::work txn(*connection);
+        // Строкой больше страницы: по ней видно, есть ли следующая
+        pqxx::result result = db::timedExec(txn, kSearch,
+            search_config_,
+            query.text,
+            query.after ? query.after->rank.c_str() : nullptr,
+            query.after ? query.after->id : 0,
+            static_cast<int>(query.limit + 1));
+
+        metrics::PhaseTimer map_timer(metrics::Phase::MAPPING);
+        SearchPage page;
+        const std::size_t count = std::min(result.size(), query.limit);
+        page.hits.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto& row = result[static_cast<pqxx::result::size_type>(i)];
+            SearchHit hit;
+            hit.book = rowToBook(row);
+            hit.rank = row["rank_text"].as<std::string>();
+            hit.title_highlight = highlightHtml(row["title_highlight"].c_str());
+            if (!row["review"].is_null()) {
+                hit.snippet = highlightHtml(row["snippet"].c_str());
+            }
+            page.hits.push_back(std::move(hit));
+        }
+        if (result.size() > query.limit && !page.hits.empty()) {
+            page.next = SearchCursor{page.hits.back().rank, page.hits.back().book.id};
+        }
+        return page;
+
+    } catch (const pqxx::sql_error& e) {
+        throw error_handler::DatabaseException(
+            "Database query failed",
+            e.what()
+        );
+    }
+}
\ No newline at end of file
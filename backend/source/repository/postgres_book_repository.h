@@ -0,0 +1,49 @@
+#pragma once
+
+#include <pqxx/pqxx>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "repository/book_repository.h"
+#include "db/connection_pool.h"
+
+// Хранилище в PostgreSQL (таблица books), соединения берутся из пула.
+// Запросы выполняются как подготовленные операторы: пул должен готовить их
+// на каждом новом соединении (prepareStatements)
+class PostgresBookRepository : public BookRepository {
+public:
+    // search_config - конфигурация текстового поиска PostgreSQL, та же, что в столбце
+    // books.search (см. initializeDatabase)
+    explicit PostgresBookRepository(std::shared_ptr<db::ConnectionPool> pool,
+                                    std::string search_config = "simple");
+
+    static void prepareStatements(pqxx::connection& connection);
+
+    // Для снимка кэша: отметка поколения базы и текущее время БД
+    struct Generation {
+        std::string marker;
+        std::string db_time;
+    };
+    Generation generation();
+
+    // id книг, измененных позже db_time минус window_s секунд
+    std::vector<int> changedSince(const std::string& db_time, unsigned window_s);
+    // Какие из ids есть в таблице
+    std::vector<int> existingIds(const std::vector<int>& ids);
+
+    std::vector<BookRow> getAllBooks() override;
+    error_handler::Result<BookRow> getBookById(int id) override;
+    error_handler::Result<int> createBook(const BookInput& input) override;
+    error_handler::Result<BookRow> updateBook(int id, const BookInput& input) override;
+    error_handler::Result<void> deleteBook(int id) override;
+    BookStats getStats() override;
+    error_handler::Result<SearchPage> searchBooks(const SearchQuery& query) override;
+
+private:
+    db::ConnectionPool::Lease checkout();
+    BookRow rowToBook(const pqxx::row& row);
+
+    std::shared_ptr<db::ConnectionPool> pool_;
+    std::string search_config_;
+};
@@ -0,0 +1,312 @@
+#include "serializer/book_input_parser.h"
+
+#include <limits>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace serializer {
+
+namespace {
+
+// Ограничения схемы таблицы books
+constexpr std::size_t kMaxTitleLength = 255;
+constexpr std::size_t kMaxAuthorLength = 255;
+constexpr std::size_t kMaxStatusLength = 50;
+constexpr int kMinRating = 1;
+constexpr int kMaxRating = 5;
+
+// Обработчик SAX-событий nlohmann::json.
+// Строки копируются в память BookInput (арену запроса), а буфер лексера
+// nlohmann переиспользуется для следующего токена
+class BookInputSax {
+public:
+    using number_integer_t = json::number_integer_t;
+    using number_unsigned_t = json::number_unsigned_t;
+    using number_float_t = json::number_float_t;
+    using string_t = json::string_t;
+    using binary_t = json::binary_t;
+
+    explicit BookInputSax(BookInput& out) : out_(out) {}
+
+    const std::optional<InputError>& error() const { return error_; }
+
+    bool null() {
+        if (!acceptScalar()) {
+            return !error_;
+        }
+        switch (target_) {
+            case Target::TITLE:
+                return fail("Title is required", "Book title must be provided and cannot be null");
+            case Target::AUTHOR:
+                return fail("Author is required", "Book author must be provided and cannot be null");
+            case Target::STATUS:
+                return fail("Invalid status", "Field 'status' cannot be null");
+            case Target::YEAR:
+                out_.year.reset();
+                return mark(BookInput::YEAR);
+            case Target::RATING:
+                out_.rating.reset();
+                return mark(BookInput::RATING);
+            case Target::REVIEW:
+                out_.review.reset();
+                return mark(BookInput::REVIEW);
+            case Target::NONE:
+            default:
+                return true;
+        }
+    }
+
+    bool boolean(bool) {
+        if (!acceptScalar()) {
+            return !error_;
+        }
+        return target_ == Target::NONE ? true : typeMismatch();
+    }
+
+    bool number_integer(number_integer_t value) {
+        if (!acceptScalar()) {
+            return !error_;
+        }
+        return integer(value, false);
+    }
+
+    bool number_unsigned(number_unsigned_t value) {
+        if (!acceptScalar()) {
+            return !error_;
+        }
+        const bool overflow = value > static_cast<number_unsigned_t>(std::numeric_limits<int>::max());
+        return integer(overflow ? 0 : static_cast<number_integer_t>(value), overflow);
+    }
+
+    bool number_float(number_float_t, const string_t&) {
+        if (!acceptScalar()) {
+            return !error_;
+        }
+        return target_ == Target::NONE ? true : typeMismatch();
+    }
+
+    bool string(string_t& value) {
+        if (!acceptScalar()) {
+            return !error_;
+        }
+        switch (target_) {
+            case Target::TITLE:
+                if (utf8Length(value) > kMaxTitleLength) {
+                    return fail("Invalid title", "Field 'title' must not exceed 255 characters");
+                }
+                out_.title.assign(value);
+                return mark(BookInput::TITLE);
+            case Target::AUTHOR:
+                if (utf8Length(value) > kMaxAuthorLength) {
+                    return fail("Invalid author", "Field 'author' must not exceed 255 characters");
+                }
+                out_.author.assign(value);
+                return mark(BookInput::AUTHOR);
+            case Target::STATUS:
+                if (utf8Length(value) > kMaxStatusLength) {
+                    return fail("Invalid status", "Field 'status' must not exceed 50 characters");
+                }
+                out_.status.assign(value);
+                return mark(BookInput::STATUS);
+            case Target::REVIEW:
+                out_.review.emplace(value, out_.title.get_allocator());
+                return mark(BookInput::REVIEW);
+            case Target::NONE:
+                return true;
+            default:
+                return typeMismatch();
+        }
+    }
+
+    bool binary(binary_t&) {
+        return invalidJson("Binary values are not supported");
+    }
+
+    bool start_object(std::size_t) {
+        return startContainer();
+    }
+
+    bool end_object() {
+        return endContainer();
+    }
+
+    bool start_array(std::size_t) {
+        if (depth_ == 0) {
+            return notAnObject();
+        }
+        return startContainer();
+    }
+
+    bool end_array() {
+        return endContainer();
+    }
+
+    bool key(string_t& name) {
+        if (depth_ == 1) {
+            target_ = lookup(name);
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) {
+        error_ = InputError{InputError::Kind::INVALID_JSON, "Invalid JSON format", e.what()};
+        return false;
+    }
+
+private:
+    enum class Target { NONE, TITLE, AUTHOR, YEAR, STATUS, RATING, REVIEW };
+
+    static Target lookup(const string_t& name) {
+        switch (name.size()) {
+            case 4:
+                return name == "year" ? Target::YEAR : Target::NONE;
+            case 5:
+                return name == "title" ? Target::TITLE : Target::NONE;
+            case 6:
+                if (name == "author") return Target::AUTHOR;
+                if (name == "status") return Target::STATUS;
+                if (name == "rating") return Target::RATING;
+                if (name == "review") return Target::REVIEW;
+                return Target::NONE;
+            default:
+                return Target::NONE;
+        }
+    }
+
+    static const char* fieldName(Target target) {
+        switch (target) {
+            case Target::TITLE: return "title";
+            case Target::AUTHOR: return "author";
+            case Target::YEAR: return "year";
+            case Target::STATUS: return "status";
+            case Target::RATING: return "rating";
+            case Target::REVIEW: return "review";
+            default: return "";
+        }
+    }
+
+    static const char* expectedType(Target target) {
+        switch (target) {
+            case Target::YEAR:
+            case Target::RATING:
+                return "an integer or null";
+            case Target::REVIEW:
+                return "a string or null";
+            default:
+                return "a string";
+        }
+    }
+
+    // Скаляр на верхнем уровне объекта обрабатываем, внутри неизвестных полей - пропускаем
+    bool acceptScalar() {
+        if (depth_ == 0) {
+            notAnObject();
+            return false;
+        }
+        return depth_ == 1;
+    }
+
+    bool startContainer() {
+        if (depth_ == 1 && target_ != Target::NONE) {
+            return typeMismatch();
+        }
+        ++depth_;
+        return true;
+    }
+
+    bool endContainer() {
+        --depth_;
+        if (depth_ == 1) {
+            target_ = Target::NONE;
+        }
+        return true;
+    }
+
+    bool integer(number_integer_t value, bool overflow) {
+        switch (target_) {
+            case Target::YEAR:
+                if (overflow || value < std::numeric_limits<int>::min() ||
+                    value > std::numeric_limits<int>::max()) {
+                    return fail("Invalid year", "Field 'year' is out of range");
+                }
+                out_.year = static_cast<int>(value);
+                return mark(BookInput::YEAR);
+            case Target::RATING:
+                if (overflow || value < kMinRating || value > kMaxRating) {
+                    return fail("Invalid rating", "Field 'rating' must be between 1 and 5");
+                }
+                out_.rating = static_cast<int>(value);
+                return mark(BookInput::RATING);
+            case Target::NONE:
+                return true;
+            default:
+                return typeMismatch();
+        }
+    }
+
+    bool mark(BookInput::Field field) {
+        out_.present |= field;
+        target_ = Target::NONE;
+        return true;
+    }
+
+    bool typeMismatch() {
+        return fail(std::string("Invalid ") + fieldName(target_),
+                    std::string("Field '") + fieldName(target_) + "' must be " + expectedType(target_));
+    }
+
+    bool notAnObject() {
+        return invalidJson("Request body must be a JSON object");
+    }
+
+    bool invalidJson(std::string details) {
+        error_ = InputError{InputError::Kind::INVALID_JSON, "Invalid JSON format", std::move(details)};
+        return false;
+    }
+
+    bool fail(std::string message, std::string details) {
+        error_ = InputError{InputError::Kind::VALIDATION, std::move(message), std::move(details)};
+        return false;
+    }
+
+    BookInput& out_;
+    std::optional<InputError> error_;
+    Target target_ = Target::NONE;
+    int depth_ = 0;
+};
+
+} // namespace
+
+std::size_t utf8Length(std::string_view value) {
+    std::size_t length = 0;
+    for (unsigned char c : value) {
+        length += (c & 0xC0) != 0x80;
+    }
+    return length;
+}
+
+std::optional<InputError> BookInputParser::parse(const std::string& body, Mode mode, BookInput& out) {
+    BookInputSax handler(out);
+    if (!json::sax_parse(body, &handler)) {
+        if (handler.error()) {
+            return handler.error();
+        }
+        return InputError{InputError::Kind::INVALID_JSON, "Invalid JSON format", "Unexpected end of input"};
+    }
+
+    if (mode == Mode::CREATE) {
+        if (!out.has(BookInput::TITLE)) {
+            return InputError{InputError::Kind::VALIDATION,
+                              "Title is required", "Book title must be provided and cannot be null"};
+        }
+        if (!out.has(BookInput::AUTHOR)) {
+            return InputError{InputError::Kind::VALIDATION,
+                              "Author is required", "Book author must be provided and cannot be null"};
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace serializer
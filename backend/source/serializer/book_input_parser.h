@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "model/book.h"
+
+namespace serializer {
+
+// Длина UTF-8 строки в символах (VARCHAR(n) в PostgreSQL считает символы)
+std::size_t utf8Length(std::string_view value);
+
+// Ошибка разбора тела запроса
+struct InputError {
+    enum class Kind {
+        INVALID_JSON,   // синтаксическая ошибка JSON -> 400 bad_request
+        VALIDATION      // неверный тип или значение поля -> 400 validation_error
+    };
+
+    Kind kind;
+    std::string message;
+    std::string details;
+};
+
+// Потоковый (SAX) разбор тела POST/PUT прямо в BookInput:
+// без построения DOM, с проверкой типов и значений за один проход
+class BookInputParser {
+public:
+    enum class Mode {
+        CREATE,   // title и author обязательны
+        UPDATE    // все поля необязательны
+    };
+
+    static std::optional<InputError> parse(const std::string& body, Mode mode, BookInput& out);
+};
+
+} // namespace serializer
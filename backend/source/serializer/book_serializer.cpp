@@ -0,0 +1,413 @@
+#include "serializer/book_serializer.h"
+#include "serializer/json_writer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace serializer {
+
+namespace {
+
+// Общая часть бинарных форматов: запись big-endian чисел
+class BinaryWriterBase {
+protected:
+    explicit BinaryWriterBase(std::string& out) : out_(out) {}
+
+    void byte(std::uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+    void bigEndian(std::uint64_t value, int bytes) {
+        for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+            byte(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    void float64(double value) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bigEndian(bits, 8);
+    }
+
+    std::string& out_;
+};
+
+// MessagePack (https://github.com/msgpack/msgpack/blob/master/spec.md)
+class MsgPackWriter : private BinaryWriterBase {
+public:
+    explicit MsgPackWriter(std::string& out) : BinaryWriterBase(out) {}
+
+    void beginObject(std::size_t size) { container(size, 0x80, 0xde, 0xdf); }
+    void endObject() {}
+    void beginArray(std::size_t size) { container(size, 0x90, 0xdc, 0xdd); }
+    void endArray() {}
+
+    void key(std::string_view name) { string(name); }
+
+    void string(std::string_view value) {
+        const std::size_t size = value.size();
+        if (size < 32) {
+            byte(static_cast<std::uint8_t>(0xa0 | size));
+        } else if (size <= 0xff) {
+            byte(0xd9);
+            bigEndian(size, 1);
+        } else if (size <= 0xffff) {
+            byte(0xda);
+            bigEndian(size, 2);
+        } else {
+            byte(0xdb);
+            bigEndian(size, 4);
+        }
+        out_.append(value.data(), size);
+    }
+
+    void integer(std::int64_t value) {
+        if (value >= 0) {
+            const auto u = static_cast<std::uint64_t>(value);
+            if (u < 128) {
+                byte(static_cast<std::uint8_t>(u));
+            } else if (u <= 0xff) {
+                byte(0xcc);
+                bigEndian(u, 1);
+            } else if (u <= 0xffff) {
+                byte(0xcd);
+                bigEndian(u, 2);
+            } else if (u <= 0xffffffffULL) {
+                byte(0xce);
+                bigEndian(u, 4);
+            } else {
+                byte(0xcf);
+                bigEndian(u, 8);
+            }
+        } else if (value >= -32) {
+            byte(static_cast<std::uint8_t>(value));
+        } else if (value >= INT8_MIN) {
+            byte(0xd0);
+            bigEndian(static_cast<std::uint64_t>(value), 1);
+        } else if (value >= INT16_MIN) {
+            byte(0xd1);
+            bigEndian(static_cast<std::uint64_t>(value), 2);
+        } else if (value >= INT32_MIN) {
+            byte(0xd2);
+            bigEndian(static_cast<std::uint64_t>(value), 4);
+        } else {
+            byte(0xd3);
+            bigEndian(static_cast<std::uint64_t>(value), 8);
+        }
+    }
+
+    void real(double value) { byte(0xcb); float64(value); }
+    void null() { byte(0xc0); }
+
+private:
+    void container(std::size_t size, std::uint8_t fix, std::uint8_t code16, std::uint8_t code32) {
+        if (size < 16) {
+            byte(static_cast<std::uint8_t>(fix | size));
+        } else if (size <= 0xffff) {
+            byte(code16);
+            bigEndian(size, 2);
+        } else {
+            byte(code32);
+            bigEndian(size, 4);
+        }
+    }
+};
+
+// CBOR (RFC 8949)
+class CborWriter : private BinaryWriterBase {
+public:
+    explicit CborWriter(std::string& out) : BinaryWriterBase(out) {}
+
+    void beginObject(std::size_t size) { head(5, size); }
+    void endObject() {}
+    void beginArray(std::size_t size) { head(4, size); }
+    void endArray() {}
+
+    void key(std::string_view name) { string(name); }
+
+    void string(std::string_view value) {
+        head(3, value.size());
+        out_.append(value.data(), value.size());
+    }
+
+    void integer(std::int64_t value) {
+        if (value >= 0) {
+            head(0, static_cast<std::uint64_t>(value));
+        } else {
+            head(1, static_cast<std::uint64_t>(-1 - value));
+        }
+    }
+
+    void real(double value) { byte(0xfb); float64(value); }
+    void null() { byte(0xf6); }
+
+private:
+    void head(std::uint8_t major, std::uint64_t value) {
+        const auto type = static_cast<std::uint8_t>(major << 5);
+        if (value < 24) {
+            byte(static_cast<std::uint8_t>(type | value));
+        } else if (value <= 0xff) {
+            byte(type | 24);
+            bigEndian(value, 1);
+        } else if (value <= 0xffff) {
+            byte(type | 25);
+            bigEndian(value, 2);
+        } else if (value <= 0xffffffffULL) {
+            byte(type | 26);
+            bigEndian(value, 4);
+        } else {
+            byte(type | 27);
+            bigEndian(value, 8);
+        }
+    }
+};
+
+template <typename Writer>
+void writeOptionalInt(Writer& writer, const std::optional<int>& value) {
+    if (value.has_value()) {
+        writer.integer(*value);
+    } else {
+        writer.null();
+    }
+}
+
+template <typename Writer>
+void writeBook(Writer& writer, const BookRow& book) {
+    writer.beginObject(9);
+    writer.key("id");
+    writer.integer(book.id);
+    writer.key("title");
+    writer.string(book.title);
+    writer.key("author");
+    writer.string(book.author);
+    writer.key("year");
+    writeOptionalInt(writer, book.year);
+    writer.key("status");
+    writer.string(book.status);
+    writer.key("rating");
+    writeOptionalInt(writer, book.rating);
+    writer.key("review");
+    writer.string(book.review);
+    writer.key("created_at");
+    writer.string(book.created_at);
+    writer.key("updated_at");
+    writer.string(book.updated_at);
+    writer.endObject();
+}
+
+template <typename Writer>
+void writeBooks(Writer& writer, const std::vector<BookRow>& books) {
+    writer.beginArray(books.size());
+    for (const auto& book : books) {
+        writeBook(writer, book);
+    }
+    writer.endArray();
+}
+
+template <typename Writer>
+void writeStats(Writer& writer, const BookStats& stats) {
+    writer.beginObject(3);
+    writer.key("by_status");
+    writer.beginObject(stats.by_status.size());
+    for (const auto& [status, count] : stats.by_status) {
+        writer.key(status);
+        writer.integer(count);
+    }
+    writer.endObject();
+    writer.key("average_rating");
+    if (stats.average_rating.has_value()) {
+        writer.real(*stats.average_rating);
+    } else {
+        writer.null();
+    }
+    writer.key("total_books");
+    writer.integer(stats.total_books);
+    writer.endObject();
+}
+
+// {"results":[{"book":{...},"rank":0.6,"title_highlight":"...","snippet":"..."}],"next_cursor":...}
+template <typename Writer>
+void writeSearchPage(Writer& writer, const SearchPage& page, const std::string& next_cursor) {
+    writer.beginObject(2);
+    writer.key("results");
+    writer.beginArray(page.hits.size());
+    for (const auto& hit : page.hits) {
+        writer.beginObject(4);
+        writer.key("book");
+        writeBook(writer, hit.book);
+        writer.key("rank");
+        writer.real(std::strtod(hit.rank.c_str(), nullptr));
+        writer.key("title_highlight");
+        writer.string(hit.title_highlight);
+        writer.key("snippet");
+        writer.string(hit.snippet);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.key("next_cursor");
+    if (page.next.has_value()) {
+        writer.string(next_cursor);
+    } else {
+        writer.null();
+    }
+    writer.endObject();
+}
+
+// Запуск кодировщика нужного формата
+template <typename Encode>
+std::string encode(ResponseFormat format, std::size_t size_hint, Encode&& encode_fn) {
+    std::string out;
+    out.reserve(size_hint);
+    switch (format) {
+        case ResponseFormat::MSGPACK: {
+            MsgPackWriter writer(out);
+            encode_fn(writer);
+            break;
+        }
+        case ResponseFormat::CBOR: {
+            CborWriter writer(out);
+            encode_fn(writer);
+            break;
+        }
+        case ResponseFormat::JSON:
+        default: {
+            JsonWriter writer(out);
+            encode_fn(writer);
+            break;
+        }
+    }
+    return out;
+}
+
+// Примерный размер одной книги, чтобы избежать лишних перевыделений
+constexpr std::size_t kBookSizeHint = 256;
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+} // namespace
+
+ResponseFormat BookSerializer::negotiateFormat(const std::string& accept_header) {
+    ResponseFormat best = ResponseFormat::JSON;
+    double best_q = 0.0;
+
+    std::string_view rest(accept_header);
+    while (!rest.empty()) {
+        const auto comma = rest.find(',');
+        std::string_view range = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+
+        // media-range [; q=0.x]
+        const auto semicolon = range.find(';');
+        const std::string_view media = trim(range.substr(0, semicolon));
+        double q = 1.0;
+        if (semicolon != std::string_view::npos) {
+            std::string_view params = range.substr(semicolon + 1);
+            const auto q_pos = params.find("q=");
+            if (q_pos != std::string_view::npos) {
+                const std::string_view q_value = trim(params.substr(q_pos + 2));
+                std::from_chars(q_value.data(), q_value.data() + q_value.size(), q);
+            }
+        }
+
+        ResponseFormat candidate;
+        if (equalsIgnoreCase(media, "application/msgpack") ||
+            equalsIgnoreCase(media, "application/x-msgpack")) {
+            candidate = ResponseFormat::MSGPACK;
+        } else if (equalsIgnoreCase(media, "application/cbor")) {
+            candidate = ResponseFormat::CBOR;
+        } else if (equalsIgnoreCase(media, "application/json") ||
+                   equalsIgnoreCase(media, "application/*") || media == "*/*") {
+            candidate = ResponseFormat::JSON;
+        } else {
+            continue;
+        }
+
+        // При равном q побеждает тип, указанный раньше
+        if (q > best_q) {
+            best_q = q;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+const char* BookSerializer::contentType(ResponseFormat format) {
+    switch (format) {
+        case ResponseFormat::MSGPACK: return "application/msgpack";
+        case ResponseFormat::CBOR: return "application/cbor";
+        case ResponseFormat::JSON:
+        default: return "application/json";
+    }
+}
+
+std::string BookSerializer::serializeBook(const BookRow& book, ResponseFormat format) {
+    return encode(format, kBookSizeHint, [&](auto& writer) { writeBook(writer, book); });
+}
+
+std::string BookSerializer::serializeBooks(const std::vector<BookRow>& books, ResponseFormat format) {
+    return encode(format, 2 + books.size() * kBookSizeHint,
+                  [&](auto& writer) { writeBooks(writer, books); });
+}
+
+std::string BookSerializer::serializeStats(const BookStats& stats, ResponseFormat format) {
+    return encode(format, 128, [&](auto& writer) { writeStats(writer, stats); });
+}
+
+std::string BookSerializer::serializeSearchPage(const SearchPage& page, ResponseFormat format) {
+    const std::string next_cursor = page.next.has_value() ? formatSearchCursor(*page.next) : std::string{};
+    return encode(format, 32 + page.hits.size() * 2 * kBookSizeHint,
+                  [&](auto& writer) { writeSearchPage(writer, page, next_cursor); });
+}
+
+std::string BookSerializer::formatSearchCursor(const SearchCursor& cursor) {
+    return cursor.rank + "_" + std::to_string(cursor.id);
+}
+
+std::optional<SearchCursor> BookSerializer::parseSearchCursor(std::string_view value) {
+    const auto separator = value.rfind('_');
+    if (separator == std::string_view::npos || separator == 0) {
+        return std::nullopt;
+    }
+
+    // rank передается в SQL как есть: допускаем только число целиком
+    SearchCursor cursor;
+    cursor.rank = std::string(value.substr(0, separator));
+    if (cursor.rank.find_first_not_of("0123456789.eE+-") != std::string::npos) {
+        return std::nullopt;
+    }
+    char* end = nullptr;
+    const double rank = std::strtod(cursor.rank.c_str(), &end);
+    if (end != cursor.rank.c_str() + cursor.rank.size() || !std::isfinite(rank)) {
+        return std::nullopt;
+    }
+
+    const std::string_view id = value.substr(separator + 1);
+    const auto [ptr, ec] = std::from_chars(id.data(), id.data() + id.size(), cursor.id);
+    if (ec != std::errc{} || ptr != id.data() + id.size() || cursor.id <= 0) {
+        return std::nullopt;
+    }
+    return cursor;
+}
+
+} // namespace serializer
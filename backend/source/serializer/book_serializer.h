@@ -0,0 +1,37 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model/book.h"
+
+namespace serializer {
+
+// Поддерживаемые форматы ответа
+enum class ResponseFormat {
+    JSON,
+    MSGPACK,
+    CBOR
+};
+
+// Сериализация типизированных данных напрямую в JSON/MessagePack/CBOR,
+// без построения промежуточного nlohmann::json DOM
+class BookSerializer {
+public:
+    // Выбор формата по заголовку Accept (с учетом q-значений), по умолчанию JSON
+    static ResponseFormat negotiateFormat(const std::string& accept_header);
+    static const char* contentType(ResponseFormat format);
+
+    static std::string serializeBook(const BookRow& book, ResponseFormat format);
+    static std::string serializeBooks(const std::vector<BookRow>& books, ResponseFormat format);
+    static std::string serializeStats(const BookStats& stats, ResponseFormat format);
+    static std::string serializeSearchPage(const SearchPage& page, ResponseFormat format);
+
+    // Курсор поиска "<rank>_<id>"; nullopt - курсор поврежден
+    static std::string formatSearchCursor(const SearchCursor& cursor);
+    static std::optional<SearchCursor> parseSearchCursor(std::string_view value);
+};
+
+} // namespace serializer
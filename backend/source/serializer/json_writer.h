@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace serializer {
+
+// Потоковая запись JSON сразу в выходную строку, без построения DOM
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    void beginObject(std::size_t) { separate(); out_.push_back('{'); push(); }
+    void endObject() { pop(); out_.push_back('}'); }
+    void beginArray(std::size_t) { separate(); out_.push_back('['); push(); }
+    void endArray() { pop(); out_.push_back(']'); }
+
+    void key(std::string_view name) {
+        separate();
+        writeString(name);
+        out_.push_back(':');
+        after_key_ = true;
+    }
+
+    void string(std::string_view value) { separate(); writeString(value); }
+
+    void integer(std::int64_t value) {
+        separate();
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        out_.append(buf, res.ptr);
+    }
+
+    void real(double value) {
+        separate();
+        if (!std::isfinite(value)) {
+            out_ += "null";
+            return;
+        }
+        char buf[32];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        out_.append(buf, res.ptr);
+        // Как nlohmann::json: целое значение double выводим с ".0"
+        if (std::find_if(buf, res.ptr, [](char c) { return c == '.' || c == 'e'; }) == res.ptr) {
+            out_ += ".0";
+        }
+    }
+
+    void boolean(bool value) { separate(); out_ += value ? "true" : "false"; }
+    void null() { separate(); out_ += "null"; }
+
+private:
+    void push() { ++depth_; has_items_ &= ~(std::uint64_t{1} << depth_); }
+    void pop() { --depth_; }
+
+    void separate() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (depth_ == 0) {
+            return;
+        }
+        const std::uint64_t bit = std::uint64_t{1} << depth_;
+        if (has_items_ & bit) {
+            out_.push_back(',');
+        } else {
+            has_items_ |= bit;
+        }
+    }
+
+    void writeString(std::string_view value) {
+        static const char hex[] = "0123456789abcdef";
+        out_.push_back('"');
+        std::size_t plain_from = 0;
+        for (std::size_t i = 0; i < value.size(); ++i) {
+            const auto c = static_cast<unsigned char>(value[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            out_.append(value.data() + plain_from, i - plain_from);
+            plain_from = i + 1;
+            switch (c) {
+                case '"': out_ += "\\\""; break;
+                case '\\': out_ += "\\\\"; break;
+                case '\n': out_ += "\\n"; break;
+                case '\r': out_ += "\\r"; break;
+                case '\t': out_ += "\\t"; break;
+                case '\b': out_ += "\\b"; break;
+                case '\f': out_ += "\\f"; break;
+                default:
+                    out_ += "\\u00";
+                    out_.push_back(hex[c >> 4]);
+                    out_.push_back(hex[c & 0x0f]);
+            }
+        }
+        out_.append(value.data() + plain_from, value.size() - plain_from);
+        out_.push_back('"');
+    }
+
+    std::string& out_;
+    int depth_ = 0;
+    std::uint64_t has_items_ = 0; // бит на уровень вложенности: были ли уже элементы
+    bool after_key_ = false;
+};
+
+} // namespace serializer
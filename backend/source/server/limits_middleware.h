@@ -0,0 +1,30 @@
+#pragma once
+
+#include <crow.h>
+
+#include "server/server_tuning.h"
+#include "error_handler.h"
+
+namespace server {
+
+// Middleware Crow: привязывает поток-обработчик к ядру при первом запросе
+// и отклоняет запросы с телом больше max_body_bytes (413) до разбора тела.
+// Тело к этому моменту уже прочитано Crow, ограничение экономит разбор и запись
+struct LimitsMiddleware {
+    struct context {};
+
+    void before_handle(crow::request& req, crow::response& res, context& /*ctx*/) {
+        auto& tuning = ServerTuning::instance();
+        tuning.pinCurrentThread();
+
+        const std::size_t limit = tuning.maxBodyBytes();
+        if (limit > 0 && req.body.size() > limit) {
+            res = error_handler::ErrorHandler::payloadTooLarge(req.body.size(), limit);
+            res.end();
+        }
+    }
+
+    void after_handle(crow::request& /*req*/, crow::response& /*res*/, context& /*ctx*/) {}
+};
+
+} // namespace server
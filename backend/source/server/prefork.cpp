@@ -0,0 +1,182 @@
+#include "server/prefork.h"
+#include "server/server_tuning.h"
+#include "server/worker_group.h"
+#include "logger/logger.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace server {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Обработчик, проживший меньше этого, считается упавшим при старте
+constexpr auto kStableUptime = std::chrono::seconds(5);
+constexpr auto kMaxRestartDelay = std::chrono::seconds(10);
+constexpr auto kStopTimeout = std::chrono::seconds(10);
+
+struct WorkerProcess {
+    pid_t pid = 0;
+    unsigned restarts = 0;
+    Clock::time_point started;
+    Clock::time_point restart_at;
+    Clock::duration restart_delay{};
+};
+
+void logExit(unsigned index, pid_t pid, int status) {
+    if (WIFSIGNALED(status)) {
+        LOG_ERROR("Worker killed by signal", {{"worker", index}, {"pid", pid}, {"signal", WTERMSIG(status)}});
+    } else {
+        LOG_WARN("Worker exited", {{"worker", index}, {"pid", pid}, {"code", WEXITSTATUS(status)}});
+    }
+}
+
+} // namespace
+
+int runPrefork(unsigned workers, const std::function<int()>& worker_main) {
+    auto& group = WorkerGroup::instance();
+    group.create(workers);
+
+    // Сигналы принимает только цикл супервизора
+    sigset_t signals;
+    sigset_t previous;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGCHLD);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, &previous);
+
+    const pid_t supervisor = getpid();
+    LOG_INFO("Starting prefork supervisor", {{"workers", workers}, {"pid", supervisor}});
+
+    // Фоновый поток логгера не переживает fork: супервизор пишет синхронно,
+    // обработчики запускают свой поток заново
+    logger::Logger::instance().shutdown();
+
+    std::vector<WorkerProcess> processes(workers);
+
+    auto spawn = [&](unsigned index) {
+        WorkerProcess& process = processes[index];
+        const pid_t pid = fork();
+        if (pid < 0) {
+            LOG_ERROR("Failed to fork worker", {{"worker", index}, {"error", std::strerror(errno)}});
+            process.restart_at = Clock::now() + std::chrono::seconds(1);
+            return;
+        }
+        if (pid == 0) {
+            sigprocmask(SIG_SETMASK, &previous, nullptr);
+            // Обработчик не переживает супервизор
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if (getppid() != supervisor) {
+                std::_Exit(1);
+            }
+            logger::Logger::instance().restart();
+            group.attach(index);
+            ServerTuning::instance().setProcess(index, workers);
+            std::exit(worker_main());
+        }
+
+        process.pid = pid;
+        process.started = Clock::now();
+        group.markStarted(index, pid, process.restarts);
+        LOG_INFO("Worker started", {{"worker", index}, {"pid", pid}, {"restarts", process.restarts}});
+    };
+
+    for (unsigned i = 0; i < workers; ++i) {
+        spawn(i);
+    }
+
+    for (;;) {
+        const timespec timeout{0, 200 * 1000 * 1000};
+        const int signal = sigtimedwait(&signals, nullptr, &timeout);
+        if (signal == SIGINT || signal == SIGTERM) {
+            LOG_INFO("Stopping prefork supervisor", {{"signal", signal}});
+            break;
+        }
+
+        int status = 0;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            for (unsigned i = 0; i < workers; ++i) {
+                WorkerProcess& process = processes[i];
+                if (process.pid != pid) {
+                    continue;
+                }
+                process.pid = 0;
+                group.markExited(i);
+                logExit(i, pid, status);
+
+                // Быстро падающий обработчик перезапускаем с нарастающей задержкой
+                const auto now = Clock::now();
+                if (now - process.started < kStableUptime) {
+                    process.restart_delay = std::min<Clock::duration>(
+                        std::max<Clock::duration>(process.restart_delay * 2, std::chrono::milliseconds(100)),
+                        kMaxRestartDelay);
+                } else {
+                    process.restart_delay = Clock::duration::zero();
+                }
+                process.restart_at = now + process.restart_delay;
+                break;
+            }
+        }
+
+        const auto now = Clock::now();
+        for (unsigned i = 0; i < workers; ++i) {
+            if (processes[i].pid == 0 && now >= processes[i].restart_at) {
+                ++processes[i].restarts;
+                spawn(i);
+            }
+        }
+    }
+
+    // Crow завершает run() по SIGTERM; не успевшие за kStopTimeout получают SIGKILL
+    for (const auto& process : processes) {
+        if (process.pid > 0) {
+            kill(process.pid, SIGTERM);
+        }
+    }
+    const auto deadline = Clock::now() + kStopTimeout;
+    bool killed = false;
+    for (;;) {
+        int status = 0;
+        const pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid > 0) {
+            for (unsigned i = 0; i < workers; ++i) {
+                if (processes[i].pid == pid) {
+                    processes[i].pid = 0;
+                    group.markExited(i);
+                }
+            }
+            continue;
+        }
+        if (pid < 0) {
+            break;      // ECHILD: все обработчики завершились
+        }
+        if (!killed && Clock::now() >= deadline) {
+            LOG_WARN("Workers did not stop in time, killing");
+            for (const auto& process : processes) {
+                if (process.pid > 0) {
+                    kill(process.pid, SIGKILL);
+                }
+            }
+            killed = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    LOG_INFO("Prefork supervisor stopped");
+    return 0;
+}
+
+} // namespace server
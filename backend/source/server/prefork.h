@@ -0,0 +1,14 @@
+#pragma once
+
+#include <functional>
+
+namespace server {
+
+// Prefork-режим: супервизор запускает workers процессов-обработчиков,
+// каждый со своим сервером Crow на общем порту (SO_REUSEPORT - соединения
+// распределяет ядро, см. server/reuse_port.h), своим пулом соединений с БД
+// и кэшами. Упавший обработчик перезапускается; SIGINT/SIGTERM останавливают
+// всю группу. Вызывать до создания потоков: worker_main выполняется в дочернем процессе
+int runPrefork(unsigned workers, const std::function<int()>& worker_main);
+
+} // namespace server
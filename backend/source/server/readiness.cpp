@@ -0,0 +1,118 @@
+#include "server/readiness.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+
+namespace server {
+
+namespace {
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+Readiness& Readiness::instance() {
+    static Readiness readiness;
+    return readiness;
+}
+
+Readiness::~Readiness() {
+    stop();
+}
+
+void Readiness::addStep(std::string name, Step step) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    steps_.push_back({std::move(name), std::move(step)});
+}
+
+void Readiness::startWarmUp() {
+    worker_ = std::thread([this] { warmUp(); });
+}
+
+bool Readiness::warmUp() {
+    const auto start = std::chrono::steady_clock::now();
+    for (;;) {
+        NamedStep step;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return false;
+            }
+            if (current_ >= steps_.size()) {
+                break;
+            }
+            step = steps_[current_];
+        }
+        if (!runStep(step)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++current_;
+    }
+
+    {
+        // Шаги держат ссылки на пул и хранилище - после прогрева они не нужны
+        std::lock_guard<std::mutex> lock(mutex_);
+        steps_.clear();
+        current_ = 0;
+    }
+    warm_up_ns_.store(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+    ready_.store(true, std::memory_order_release);
+    LOG_INFO("Server is ready", {{"warm_up_ms", msSince(start)}});
+    return true;
+}
+
+bool Readiness::runStep(const NamedStep& step) {
+    auto delay = kInitialRetryDelay;
+    for (unsigned attempt = 1;; ++attempt) {
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            step.step();
+            LOG_INFO("Warm-up step done", {{"step", step.name}, {"duration_ms", msSince(start)}});
+            return true;
+        } catch (const std::exception& e) {
+            LOG_WARN("Warm-up step failed, retrying", {
+                {"step", step.name},
+                {"attempt", attempt},
+                {"retry_in_ms", static_cast<long long>(delay.count())},
+                {"error", e.what()}
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stop_requested_.wait_for(lock, delay, [this] { return stopping_; })) {
+            return false;
+        }
+        delay = std::min(delay * 2, kMaxRetryDelay);
+    }
+}
+
+void Readiness::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_requested_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    ready_.store(false, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    steps_.clear();
+    current_ = 0;
+}
+
+std::string Readiness::pendingStep() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_ < steps_.size() ? steps_[current_].name : std::string();
+}
+
+double Readiness::warmUpSeconds() const {
+    return static_cast<double>(warm_up_ns_.load(std::memory_order_relaxed)) / 1e9;
+}
+
+} // namespace server
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace server {
+
+// Готовность процесса к трафику для /ready; /health остается проверкой liveness.
+// Шаги прогрева (пул соединений, кэш) выполняются по порядку; шаг, бросивший
+// исключение, повторяется с растущей паузой. Процесс готов после всех шагов
+class Readiness {
+public:
+    using Step = std::function<void()>;
+
+    static Readiness& instance();
+
+    ~Readiness();
+
+    // До запуска прогрева
+    void addStep(std::string name, Step step);
+
+    // Прогрев в фоновом потоке: сервер уже слушает и отвечает на /health
+    void startWarmUp();
+    // Прогрев в текущем потоке; false, если прерван stop()
+    bool warmUp();
+    void stop();
+
+    bool ready() const { return ready_.load(std::memory_order_acquire); }
+    // Шаг, выполняющийся сейчас; пусто, если шагов не осталось
+    std::string pendingStep() const;
+    double warmUpSeconds() const;
+
+    Readiness(const Readiness&) = delete;
+    Readiness& operator=(const Readiness&) = delete;
+
+private:
+    Readiness() = default;
+
+    struct NamedStep {
+        std::string name;
+        Step step;
+    };
+
+    static constexpr std::chrono::milliseconds kInitialRetryDelay{200};
+    static constexpr std::chrono::milliseconds kMaxRetryDelay{5000};
+
+    // false, если остановлен во время ожидания повтора
+    bool runStep(const NamedStep& step);
+
+    mutable std::mutex mutex_;
+    std::condition_variable stop_requested_;
+    std::vector<NamedStep> steps_;
+    std::size_t current_ = 0;
+    bool stopping_ = false;
+    std::thread worker_;
+
+    std::atomic<bool> ready_{false};
+    std::atomic<std::uint64_t> warm_up_ns_{0};
+};
+
+} // namespace server
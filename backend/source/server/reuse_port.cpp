@@ -0,0 +1,53 @@
+#include "server/reuse_port.h"
+
+#include <atomic>
+
+#include <dlfcn.h>
+#include <sys/socket.h>
+
+namespace server {
+
+namespace {
+
+std::atomic<bool> g_reuse_port{false};
+
+using SetsockoptFn = int (*)(int, int, int, const void*, socklen_t);
+
+SetsockoptFn realSetsockopt() {
+    static const auto fn = reinterpret_cast<SetsockoptFn>(dlsym(RTLD_NEXT, "setsockopt"));
+    return fn;
+}
+
+// Потоковый сокет IPv4/IPv6: Unix-сокеты и UDP не трогаем
+bool isTcpSocket(int fd) {
+    int domain = 0;
+    int type = 0;
+    socklen_t length = sizeof(domain);
+    if (getsockopt(fd, SOL_SOCKET, SO_DOMAIN, &domain, &length) != 0 ||
+        (domain != AF_INET && domain != AF_INET6)) {
+        return false;
+    }
+    length = sizeof(type);
+    return getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &length) == 0 && type == SOCK_STREAM;
+}
+
+} // namespace
+
+void enableReusePort() {
+    g_reuse_port.store(true, std::memory_order_relaxed);
+}
+
+} // namespace server
+
+// Crow не дает настроить свой acceptor, а общий порт в нескольких процессах
+// возможен, только если SO_REUSEPORT выставлен до bind. asio выставляет
+// SO_REUSEADDR на слушающем сокете перед bind - вместе с ним включаем SO_REUSEPORT
+extern "C" int setsockopt(int fd, int level, int name, const void* value, socklen_t length) noexcept {
+    const int result = server::realSetsockopt()(fd, level, name, value, length);
+    if (result == 0 && level == SOL_SOCKET && name == SO_REUSEADDR &&
+        server::g_reuse_port.load(std::memory_order_relaxed) && server::isTcpSocket(fd)) {
+        const int one = 1;
+        server::realSetsockopt()(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    }
+    return result;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace server {
+
+// SO_REUSEPORT для слушающих TCP-сокетов, которые создаст этот процесс и его
+// потомки. Перехват setsockopt собирается только в bookshelf_api
+// (server/reuse_port.cpp), библиотека и тесты его не получают
+void enableReusePort();
+
+} // namespace server
@@ -0,0 +1,290 @@
+#include "server/server_tuning.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include <dirent.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace server {
+
+namespace {
+
+// Слушающий сокет Crow не доступен снаружи: ищем его среди открытых дескрипторов
+template <typename Match>
+int findListenSocket(Match&& match) {
+    DIR* dir = opendir("/proc/self/fd");
+    if (dir == nullptr) {
+        return -1;
+    }
+    int found = -1;
+    while (dirent* entry = readdir(dir)) {
+        const int fd = std::atoi(entry->d_name);
+        if (fd <= 2 || fd == dirfd(dir)) {
+            continue;
+        }
+        int accepting = 0;
+        socklen_t length = sizeof(accepting);
+        if (getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &accepting, &length) != 0 || accepting == 0) {
+            continue;
+        }
+        sockaddr_storage address{};
+        socklen_t address_length = sizeof(address);
+        if (getsockname(fd, reinterpret_cast<sockaddr*>(&address), &address_length) != 0) {
+            continue;
+        }
+        if (match(address)) {
+            found = fd;
+            break;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+bool boundToPort(const sockaddr_storage& address, std::uint16_t port) {
+    if (address.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<const sockaddr_in&>(address).sin_port) == port;
+    }
+    if (address.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<const sockaddr_in6&>(address).sin6_port) == port;
+    }
+    return false;
+}
+
+bool boundToPath(const sockaddr_storage& address, const std::string& path) {
+    return address.ss_family == AF_UNIX &&
+           path == reinterpret_cast<const sockaddr_un&>(address).sun_path;
+}
+
+sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Unix socket path is too long: " + path);
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+// Очередь listen() ограничена сверху net.core.somaxconn
+int systemMaxBacklog() {
+    std::ifstream file("/proc/sys/net/core/somaxconn");
+    int value = SOMAXCONN;
+    file >> value;
+    return value;
+}
+
+std::string joinCpus(const std::vector<int>& cpus) {
+    std::string out;
+    for (int cpu : cpus) {
+        if (!out.empty()) {
+            out += ',';
+        }
+        out += std::to_string(cpu);
+    }
+    return out.empty() ? "none" : out;
+}
+
+thread_local bool t_pinned = false;
+
+} // namespace
+
+unsigned availableCpus() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        return static_cast<unsigned>(std::max(CPU_COUNT(&set), 1));
+    }
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+ServerTuning& ServerTuning::instance() {
+    static ServerTuning tuning;
+    return tuning;
+}
+
+void ServerTuning::configure(Settings settings) {
+    const int cpu_limit = CPU_SETSIZE;
+    settings.pin_cpus.erase(
+        std::remove_if(settings.pin_cpus.begin(), settings.pin_cpus.end(), [cpu_limit](int cpu) {
+            if (cpu < 0 || cpu >= cpu_limit) {
+                LOG_WARN("Ignoring invalid CPU in server.pin_cpus", {{"cpu", cpu}});
+                return true;
+            }
+            return false;
+        }),
+        settings.pin_cpus.end());
+    settings_ = std::move(settings);
+    next_cpu_.store(0, std::memory_order_relaxed);
+}
+
+unsigned ServerTuning::workerCount() const {
+    if (settings_.workers > 0) {
+        return settings_.workers;
+    }
+    // По потоку на каждое выделенное ядро либо на каждое доступное
+    const unsigned cpus = settings_.pin_cpus.empty() ? availableCpus()
+                                                     : static_cast<unsigned>(settings_.pin_cpus.size());
+    return std::max(cpus / process_count_, 1u);
+}
+
+void ServerTuning::setProcess(unsigned index, unsigned count) {
+    process_index_ = index;
+    process_count_ = std::max(count, 1u);
+}
+
+std::string ServerTuning::processPath(const std::string& path) const {
+    if (path.empty() || process_count_ <= 1) {
+        return path;
+    }
+    return path + "." + std::to_string(process_index_);
+}
+
+std::uint8_t ServerTuning::keepaliveTimeout() const {
+    return static_cast<std::uint8_t>(std::clamp(settings_.keepalive_timeout_s, 1u, 255u));
+}
+
+bool ServerTuning::tuneListenSocket(std::uint16_t port) const {
+    const int fd = findListenSocket([port](const sockaddr_storage& address) { return boundToPort(address, port); });
+    if (fd < 0) {
+        LOG_WARN("Listen socket not found, socket tuning skipped", {{"port", port}});
+        return false;
+    }
+
+    if (settings_.tcp_nodelay) {
+        const int one = 1;
+        if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) != 0) {
+            LOG_WARN("Failed to set TCP_NODELAY on listen socket");
+        }
+    }
+    // Повторный listen() на Linux меняет длину очереди уже слушающего сокета
+    if (settings_.backlog > 0 && ::listen(fd, settings_.backlog) != 0) {
+        LOG_WARN("Failed to change listen backlog", {{"backlog", settings_.backlog}});
+    }
+    return true;
+}
+
+std::string ServerTuning::unixSocketPath() const {
+    // Unix-сокеты не делят путь между процессами, как SO_REUSEPORT делит порт
+    return processPath(settings_.unix_socket_path);
+}
+
+void ServerTuning::prepareUnixSocket() const {
+    const std::string path = unixSocketPath();
+    const sockaddr_un address = unixAddress(path);
+
+    struct stat st{};
+    if (lstat(path.c_str(), &st) != 0) {
+        if (errno == ENOENT) {
+            return;
+        }
+        throw std::runtime_error("Cannot access unix socket path " + path + ": " + std::strerror(errno));
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        throw std::runtime_error("Unix socket path exists and is not a socket: " + path);
+    }
+
+    // Сокет принимает соединения - его слушает другой процесс
+    const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const bool alive = probe >= 0 &&
+                       ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    if (probe >= 0) {
+        ::close(probe);
+    }
+    if (alive) {
+        throw std::runtime_error("Another server is listening on unix socket " + path);
+    }
+    if (!settings_.unix_socket_remove_stale) {
+        throw std::runtime_error("Stale unix socket " + path + ": remove it or enable server.unix_socket.remove_stale");
+    }
+    if (::unlink(path.c_str()) != 0) {
+        throw std::runtime_error("Failed to remove stale unix socket " + path + ": " + std::strerror(errno));
+    }
+    LOG_INFO("Removed stale unix socket", {{"path", path}});
+}
+
+bool ServerTuning::tuneUnixSocket() const {
+    const std::string path = unixSocketPath();
+    if (::chmod(path.c_str(), static_cast<mode_t>(settings_.unix_socket_mode)) != 0) {
+        LOG_WARN("Failed to set unix socket permissions", {{"path", path}, {"error", std::strerror(errno)}});
+    }
+
+    const int fd = findListenSocket([&path](const sockaddr_storage& address) { return boundToPath(address, path); });
+    if (fd < 0) {
+        LOG_WARN("Unix listen socket not found, backlog unchanged", {{"path", path}});
+        return false;
+    }
+    const int backlog = settings_.unix_socket_backlog > 0 ? settings_.unix_socket_backlog : settings_.backlog;
+    if (backlog > 0 && ::listen(fd, backlog) != 0) {
+        LOG_WARN("Failed to change unix socket backlog", {{"backlog", backlog}});
+    }
+    return true;
+}
+
+void ServerTuning::removeUnixSocket() const {
+    if (!settings_.unix_socket_path.empty()) {
+        ::unlink(unixSocketPath().c_str());
+    }
+}
+
+void ServerTuning::pinCurrentThread() {
+    if (t_pinned || settings_.pin_cpus.empty()) {
+        return;
+    }
+    t_pinned = true;
+
+    const unsigned index = next_cpu_.fetch_add(1, std::memory_order_relaxed);
+    const unsigned slot = process_index_ * workerCount() + index;
+    const int cpu = settings_.pin_cpus[slot % settings_.pin_cpus.size()];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        LOG_WARN("Failed to pin server thread", {{"cpu", cpu}});
+        return;
+    }
+    LOG_DEBUG("Server thread pinned", {{"thread_index", index}, {"cpu", cpu}});
+}
+
+void ServerTuning::logTopology(std::uint16_t port) const {
+    const int somaxconn = systemMaxBacklog();
+    LOG_INFO("Server topology", {
+        {"port", port},
+        {"process", process_index_},
+        {"processes", process_count_},
+        {"workers", workerCount()},
+        {"available_cpus", availableCpus()},
+        {"hardware_threads", std::thread::hardware_concurrency()},
+        {"pin_cpus", joinCpus(settings_.pin_cpus)},
+        {"listen_tcp", settings_.listen_tcp},
+        {"unix_socket", settings_.unix_socket_path.empty() ? std::string("none") : unixSocketPath()},
+        {"tcp_nodelay", settings_.tcp_nodelay},
+        {"backlog", settings_.backlog > 0 ? std::min(settings_.backlog, somaxconn) : somaxconn},
+        {"keepalive_timeout_s", static_cast<unsigned>(keepaliveTimeout())},
+        {"max_body_bytes", settings_.max_body_bytes}
+    });
+    if (settings_.backlog > somaxconn) {
+        LOG_WARN("Listen backlog is capped by net.core.somaxconn",
+                 {{"backlog", settings_.backlog}, {"somaxconn", somaxconn}});
+    }
+    if (workerCount() * process_count_ > availableCpus()) {
+        LOG_WARN("More server workers than available CPUs",
+                 {{"workers", workerCount() * process_count_}, {"available_cpus", availableCpus()}});
+    }
+}
+
+} // namespace server
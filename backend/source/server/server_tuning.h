@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace server {
+
+// Параметры HTTP-сервера: число потоков Crow, привязка потоков-обработчиков
+// к ядрам и настройки слушающего сокета. Настраивается один раз до запуска
+class ServerTuning {
+public:
+    struct Settings {
+        unsigned workers = 0;                       // на процесс; 0 - по числу доступных ядер
+        std::vector<int> pin_cpus;                  // пусто - без привязки
+        bool tcp_nodelay = true;
+        int backlog = 0;                            // 0 - значение Crow (SOMAXCONN)
+        unsigned keepalive_timeout_s = 5;
+        std::size_t max_body_bytes = 1024 * 1024;   // 0 - без ограничения
+
+        // Unix domain socket для локального обратного прокси: отдельно или вместе с TCP
+        bool listen_tcp = true;
+        std::string unix_socket_path;               // пусто - не слушать
+        unsigned unix_socket_mode = 0660;
+        bool unix_socket_remove_stale = true;       // удалять файл, который никто не слушает
+        int unix_socket_backlog = 0;                // 0 - как backlog
+    };
+
+    static ServerTuning& instance();
+
+    void configure(Settings settings);
+    const Settings& settings() const { return settings_; }
+
+    // Потоки-обработчики; Crow добавляет к ним поток, принимающий соединения
+    unsigned workerCount() const;
+
+    template <typename App>
+    void applyTo(App& app) const {
+        app.concurrency(workerCount() + 1);
+        app.timeout(keepaliveTimeout());
+    }
+
+    // После запуска сервера: TCP_NODELAY (наследуется принятыми соединениями)
+    // и длина очереди на слушающем сокете. false - сокет не найден
+    bool tuneListenSocket(std::uint16_t port) const;
+
+    // Путь сокета процесса; в prefork-режиме с номером процесса: path.N
+    std::string unixSocketPath() const;
+
+    // До запуска: удаляет оставшийся от прошлого запуска файл сокета.
+    // Исключение, если путь занят живым сервером или не сокетом
+    void prepareUnixSocket() const;
+
+    // После запуска: права доступа к файлу сокета и длина очереди
+    bool tuneUnixSocket() const;
+
+    void removeUnixSocket() const;
+
+    // Привязка текущего потока к очередному ядру из pin_cpus; выполняется один раз на поток
+    void pinCurrentThread();
+
+    // Prefork: номер процесса и их число. Ядра машины делятся между процессами,
+    // pin_cpus раздаются процессам по очереди
+    void setProcess(unsigned index, unsigned count);
+
+    // Путь к файлу процесса: при нескольких процессах к нему добавляется ".<номер>",
+    // чтобы обработчики не писали в один файл
+    std::string processPath(const std::string& path) const;
+
+    std::size_t maxBodyBytes() const { return settings_.max_body_bytes; }
+
+    void logTopology(std::uint16_t port) const;
+
+    ServerTuning(const ServerTuning&) = delete;
+    ServerTuning& operator=(const ServerTuning&) = delete;
+
+private:
+    ServerTuning() = default;
+
+    std::uint8_t keepaliveTimeout() const;
+
+    Settings settings_;
+    unsigned process_index_ = 0;
+    unsigned process_count_ = 1;
+    std::atomic<unsigned> next_cpu_{0};
+};
+
+// Число ядер, доступных процессу (маска привязки: taskset, cpuset)
+unsigned availableCpus();
+
+} // namespace server
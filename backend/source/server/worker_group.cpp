@@ -0,0 +1,316 @@
+#include "server/worker_group.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/mman.h>
+
+namespace server {
+
+struct WorkerGroup::Slot {
+    pthread_mutex_t mutex;
+    std::int32_t pid;
+    std::uint32_t restarts;
+    std::int64_t published_ns;      // steady_clock, общий для процессов хоста
+    std::uint32_t length;
+    char text[kSnapshotBytes];
+};
+
+namespace {
+
+// Мьютекс между процессами; robust - обработчик может умереть, держа его
+class SlotLock {
+public:
+    SlotLock(pthread_mutex_t& mutex, std::uint32_t& length) : mutex_(mutex) {
+        if (pthread_mutex_lock(&mutex_) == EOWNERDEAD) {
+            // Снимок мог остаться недописанным
+            length = 0;
+            pthread_mutex_consistent(&mutex_);
+        }
+    }
+    ~SlotLock() { pthread_mutex_unlock(&mutex_); }
+
+    SlotLock(const SlotLock&) = delete;
+    SlotLock& operator=(const SlotLock&) = delete;
+
+private:
+    pthread_mutex_t& mutex_;
+};
+
+std::int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void appendValue(std::string& out, double value) {
+    char buf[32];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+// Сумма нескольких текстов Prometheus: серии с одинаковыми именем и метками
+// складываются. Квантили не складываются - берется максимум (верхняя оценка)
+class ExpositionSum {
+public:
+    void add(std::string_view text) {
+        Family* current = nullptr;
+        while (!text.empty()) {
+            const auto end = text.find('\n');
+            const std::string_view line = text.substr(0, end);
+            text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+
+            if (line.rfind("# HELP ", 0) == 0 || line.rfind("# TYPE ", 0) == 0) {
+                const std::string_view rest = line.substr(7);
+                current = &family(rest.substr(0, rest.find(' ')));
+                std::string& header = line[2] == 'H' ? current->help : current->type;
+                if (header.empty()) {
+                    header = line;
+                }
+                continue;
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            const auto space = line.rfind(' ');
+            if (space == std::string_view::npos) {
+                continue;
+            }
+            if (current == nullptr) {
+                current = &family({});
+            }
+            addSample(*current, line.substr(0, space), std::strtod(std::string(line.substr(space + 1)).c_str(), nullptr));
+        }
+    }
+
+    void render(std::string& out) const {
+        for (const auto& family : families_) {
+            if (!family.help.empty()) {
+                out += family.help;
+                out += '\n';
+            }
+            if (!family.type.empty()) {
+                out += family.type;
+                out += '\n';
+            }
+            for (const auto& [series, value] : family.samples) {
+                out += series;
+                out += ' ';
+                appendValue(out, value);
+                out += '\n';
+            }
+        }
+    }
+
+private:
+    struct Family {
+        std::string help;
+        std::string type;
+        std::vector<std::pair<std::string, double>> samples;
+        std::unordered_map<std::string, std::size_t> index;
+    };
+
+    Family& family(std::string_view name) {
+        const auto [it, inserted] = family_index_.emplace(std::string(name), families_.size());
+        if (inserted) {
+            families_.emplace_back();
+        }
+        return families_[it->second];
+    }
+
+    static void addSample(Family& family, std::string_view series, double value) {
+        const auto [it, inserted] = family.index.emplace(std::string(series), family.samples.size());
+        if (inserted) {
+            family.samples.emplace_back(std::string(series), value);
+            return;
+        }
+        double& total = family.samples[it->second].second;
+        total = series.find("quantile=\"") != std::string_view::npos ? std::max(total, value) : total + value;
+    }
+
+    std::vector<Family> families_;
+    std::unordered_map<std::string, std::size_t> family_index_;
+};
+
+} // namespace
+
+WorkerGroup& WorkerGroup::instance() {
+    static WorkerGroup group;
+    return group;
+}
+
+WorkerGroup::~WorkerGroup() {
+    stopPublishing();
+    if (memory_ != nullptr) {
+        munmap(memory_, memory_bytes_);
+    }
+}
+
+void WorkerGroup::create(unsigned workers) {
+    if (memory_ != nullptr || workers == 0) {
+        return;
+    }
+    memory_bytes_ = sizeof(Slot) * workers;
+    void* memory = mmap(nullptr, memory_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error(std::string("Failed to map shared worker memory: ") + std::strerror(errno));
+    }
+    memory_ = memory;
+    workers_ = workers;
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    for (unsigned i = 0; i < workers_; ++i) {
+        Slot* s = new (static_cast<Slot*>(memory_) + i) Slot;
+        pthread_mutex_init(&s->mutex, &attr);
+        s->pid = 0;
+        s->restarts = 0;
+        s->published_ns = 0;
+        s->length = 0;
+    }
+    pthread_mutexattr_destroy(&attr);
+}
+
+WorkerGroup::Slot* WorkerGroup::slot(unsigned index) const {
+    return static_cast<Slot*>(memory_) + index;
+}
+
+void WorkerGroup::attach(unsigned index) {
+    if (index < workers_) {
+        index_ = static_cast<int>(index);
+    }
+}
+
+void WorkerGroup::markStarted(unsigned index, int pid, unsigned restarts) {
+    Slot* s = slot(index);
+    SlotLock lock(s->mutex, s->length);
+    s->pid = pid;
+    s->restarts = restarts;
+    s->published_ns = 0;
+    s->length = 0;
+}
+
+void WorkerGroup::markExited(unsigned index) {
+    // Счетчики умершего процесса выбывают из суммы: для Prometheus это сброс счетчика
+    Slot* s = slot(index);
+    SlotLock lock(s->mutex, s->length);
+    s->pid = 0;
+    s->length = 0;
+}
+
+void WorkerGroup::startPublishing(std::function<std::string()> render, std::chrono::milliseconds interval) {
+    if (!attached()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(publisher_mutex_);
+    if (publishing_) {
+        return;
+    }
+    publishing_ = true;
+    publisher_ = std::thread([this, render = std::move(render), interval] {
+        std::unique_lock<std::mutex> lock(publisher_mutex_);
+        while (publishing_) {
+            lock.unlock();
+            publish(render());
+            lock.lock();
+            publisher_wake_.wait_for(lock, interval, [this] { return !publishing_; });
+        }
+    });
+}
+
+void WorkerGroup::stopPublishing() {
+    {
+        std::lock_guard<std::mutex> lock(publisher_mutex_);
+        if (!publishing_) {
+            return;
+        }
+        publishing_ = false;
+    }
+    publisher_wake_.notify_one();
+    if (publisher_.joinable()) {
+        publisher_.join();
+    }
+}
+
+void WorkerGroup::publish(const std::string& text) {
+    if (!attached()) {
+        return;
+    }
+    // Снимок не помещается в слот - обрезаем по границе строки
+    std::size_t length = text.size();
+    if (length > kSnapshotBytes) {
+        length = text.rfind('\n', kSnapshotBytes - 1) + 1;
+        LOG_WARN("Metrics snapshot truncated", {{"bytes", text.size()}, {"limit", kSnapshotBytes}});
+    }
+
+    Slot* s = slot(static_cast<unsigned>(index_));
+    SlotLock lock(s->mutex, s->length);
+    std::memcpy(s->text, text.data(), length);
+    s->length = static_cast<std::uint32_t>(length);
+    s->published_ns = steadyNowNs();
+}
+
+std::string WorkerGroup::aggregate(const std::string& own) {
+    if (!attached()) {
+        return own;
+    }
+    publish(own);
+
+    struct WorkerInfo {
+        std::int32_t pid;
+        std::uint32_t restarts;
+        std::int64_t published_ns;
+    };
+    std::vector<WorkerInfo> infos(workers_);
+    ExpositionSum sum;
+    std::string snapshot;
+    for (unsigned i = 0; i < workers_; ++i) {
+        Slot* s = slot(i);
+        {
+            SlotLock lock(s->mutex, s->length);
+            infos[i] = {s->pid, s->restarts, s->published_ns};
+            snapshot.assign(s->text, s->length);
+        }
+        sum.add(snapshot);
+    }
+
+    std::string out;
+    out.reserve(own.size() + 1024);
+    sum.render(out);
+
+    const std::int64_t now_ns = steadyNowNs();
+    out += "# HELP bookshelf_worker_up Worker process is running.\n# TYPE bookshelf_worker_up gauge\n";
+    for (unsigned i = 0; i < workers_; ++i) {
+        out += "bookshelf_worker_up{worker=\"" + std::to_string(i) + "\",pid=\"" +
+               std::to_string(infos[i].pid) + "\"} " + (infos[i].pid > 0 ? "1\n" : "0\n");
+    }
+    out += "# HELP bookshelf_worker_restarts_total Times the supervisor restarted the worker.\n"
+           "# TYPE bookshelf_worker_restarts_total counter\n";
+    for (unsigned i = 0; i < workers_; ++i) {
+        out += "bookshelf_worker_restarts_total{worker=\"" + std::to_string(i) + "\"} " +
+               std::to_string(infos[i].restarts) + '\n';
+    }
+    out += "# HELP bookshelf_worker_snapshot_age_seconds Age of the worker metrics snapshot.\n"
+           "# TYPE bookshelf_worker_snapshot_age_seconds gauge\n";
+    for (unsigned i = 0; i < workers_; ++i) {
+        if (infos[i].published_ns == 0) {
+            continue;
+        }
+        out += "bookshelf_worker_snapshot_age_seconds{worker=\"" + std::to_string(i) + "\"} ";
+        appendValue(out, static_cast<double>(now_ns - infos[i].published_ns) / 1e9);
+        out += '\n';
+    }
+    return out;
+}
+
+} // namespace server
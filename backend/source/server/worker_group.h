@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace server {
+
+// Общая память процессов prefork-режима: у каждого обработчика свой слот
+// со снимком метрик в формате Prometheus. /metrics любого процесса отдает
+// сумму по всем обработчикам, поэтому не важно, куда ядро направит запрос
+class WorkerGroup {
+public:
+    static WorkerGroup& instance();
+
+    ~WorkerGroup();
+
+    // Супервизор, до fork: слоты на workers процессов
+    void create(unsigned workers);
+
+    // Обработчик после fork: свой номер слота
+    void attach(unsigned index);
+    bool attached() const { return index_ >= 0; }
+    int index() const { return index_; }
+    unsigned size() const { return workers_; }
+
+    // Супервизор: запуск и завершение процесса в слоте
+    void markStarted(unsigned index, int pid, unsigned restarts);
+    void markExited(unsigned index);
+
+    // Обработчик: периодическая запись своего снимка, чтобы соседи видели свежие данные
+    void startPublishing(std::function<std::string()> render, std::chrono::milliseconds interval);
+    void stopPublishing();
+
+    void publish(const std::string& text);
+
+    // Записывает свой снимок и возвращает сумму по всем процессам
+    // плюс служебные метрики обработчиков (pid, перезапуски, возраст снимка)
+    std::string aggregate(const std::string& own);
+
+    WorkerGroup(const WorkerGroup&) = delete;
+    WorkerGroup& operator=(const WorkerGroup&) = delete;
+
+private:
+    WorkerGroup() = default;
+
+    struct Slot;
+    Slot* slot(unsigned index) const;
+
+    static constexpr std::size_t kSnapshotBytes = 1024 * 1024;
+
+    void* memory_ = nullptr;
+    std::size_t memory_bytes_ = 0;
+    unsigned workers_ = 0;
+    int index_ = -1;
+
+    std::mutex publisher_mutex_;
+    std::condition_variable publisher_wake_;
+    bool publishing_ = false;
+    std::thread publisher_;
+};
+
+} // namespace server
@@ -1,33 +1,27 @@
 #pragma once
 
-#include <pqxx/pqxx>
 #include <memory>
 #include <string>
-#include <nlohmann/json.hpp>
+#include <vector>
 
-using json = nlohmann::json;
-
-// class AppConfig;
-#include "application_builder.h"
+#include "model/book.h"
+#include "error_handler/result.h"
+#include "repository/book_repository.h"
 
 class BookService {
 public:
-    explicit BookService(const AppConfig& config);
-
-    using ConnectionFactory = std::function<std::unique_ptr<pqxx::connection>()>;
-    explicit BookService(ConnectionFactory connection_factory);
+    explicit BookService(std::shared_ptr<BookRepository> repository);
     
-    json getAllBooks();
-    json getBookById(int id);
-    int createBook(const json& book_data);
-    json updateBook(int id, const json& book_data);
-    bool deleteBook(int id);
-    json getStats();
+    // Ожидаемые исходы (не найдено, нарушение ограничений) возвращаются в Result,
+    // исключения остаются только для сбоев хранилища
+    std::vector<BookRow> getAllBooks();
+    error_handler::Result<BookRow> getBookById(int id);
+    error_handler::Result<int> createBook(const BookInput& input);
+    error_handler::Result<BookRow> updateBook(int id, const BookInput& input);
+    error_handler::Result<void> deleteBook(int id);
+    BookStats getStats();
+    error_handler::Result<SearchPage> searchBooks(const SearchQuery& query);
     
 private:
-    json rowToJson(const pqxx::row& row);
-    
-    std::shared_ptr<pqxx::connection> connection_;
-    ConnectionFactory connection_factory_;
-    AppConfig config_;
-};
\ No newline at end of file
+    std::shared_ptr<BookRepository> repository_;
+};
@@ -0,0 +1,66 @@
+#include "storage/book_codec.h"
+
+#include <array>
+
+namespace storage {
+
+namespace {
+
+enum YearRatingFlags : std::uint8_t {
+    HAS_YEAR = 1u << 0,
+    HAS_RATING = 1u << 1
+};
+
+} // namespace
+
+// Табличный вариант
+std::uint32_t crc32(const char* data, std::size_t size) {
+    static const auto table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void encodeBook(std::string& out, const BookRow& book) {
+    put(out, static_cast<std::int32_t>(book.id));
+    put(out, static_cast<std::uint8_t>((book.year ? HAS_YEAR : 0) | (book.rating ? HAS_RATING : 0)));
+    put(out, static_cast<std::int32_t>(book.year.value_or(0)));
+    put(out, static_cast<std::int32_t>(book.rating.value_or(0)));
+    putString(out, book.title);
+    putString(out, book.author);
+    putString(out, book.status);
+    putString(out, book.review);
+    putString(out, book.created_at);
+    putString(out, book.updated_at);
+}
+
+bool decodeBook(Reader& reader, BookRow& book) {
+    book.id = reader.get<std::int32_t>();
+    const auto flags = reader.get<std::uint8_t>();
+    const auto year = reader.get<std::int32_t>();
+    const auto rating = reader.get<std::int32_t>();
+    if (flags & HAS_YEAR) book.year = year;
+    if (flags & HAS_RATING) book.rating = rating;
+    book.title = reader.getString();
+    book.author = reader.getString();
+    book.status = reader.getString();
+    book.review = reader.getString();
+    book.created_at = reader.getString();
+    book.updated_at = reader.getString();
+    return reader.ok();
+}
+
+} // namespace storage
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "model/book.h"
+
+namespace storage {
+
+// Двоичное представление книги: общее для журнала (BookLog) и разделяемого кэша.
+// Числа в порядке байт платформы, строки - [длина u32][байты]
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void putString(std::string& out, const std::string& value) {
+    put(out, static_cast<std::uint32_t>(value.size()));
+    out.append(value);
+}
+
+// Последовательное чтение полей записи; ok() == false при выходе за границу
+class Reader {
+public:
+    Reader(const char* data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    T get() {
+        T value{};
+        if (pos_ + sizeof(T) > size_) {
+            ok_ = false;
+            return value;
+        }
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::string getString() {
+        const auto size = get<std::uint32_t>();
+        if (!ok_ || pos_ + size > size_) {
+            ok_ = false;
+            return {};
+        }
+        std::string value(data_ + pos_, size);
+        pos_ += size;
+        return value;
+    }
+
+    bool ok() const { return ok_ && pos_ == size_; }
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+// CRC-32 (IEEE 802.3) для проверки записей журнала и снимка кэша
+std::uint32_t crc32(const char* data, std::size_t size);
+
+void encodeBook(std::string& out, const BookRow& book);
+
+// false - данные обрезаны или содержат лишние байты
+bool decodeBook(Reader& reader, BookRow& book);
+
+} // namespace storage
@@ -0,0 +1,305 @@
+#include "storage/book_log.h"
+#include "storage/book_codec.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace storage {
+
+namespace {
+
+constexpr char kMagic[8] = {'B', 'K', 'S', 'H', 'L', 'O', 'G', '1'};
+constexpr std::size_t kRecordHeader = sizeof(std::uint32_t) * 2;   // длина + crc32
+// Защита от мусора в поле длины: книга заведомо меньше
+constexpr std::uint32_t kMaxRecordSize = 16 * 1024 * 1024;
+
+std::runtime_error systemError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+void writeAll(int fd, const char* data, std::size_t size, const std::string& path) {
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("Failed to write", path);
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+// fsync каталога: без него rename может не пережить сбой ОС
+void syncDirectory(const std::string& path) {
+    const auto slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : path.substr(0, std::max<std::size_t>(slash, 1));
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+} // namespace
+
+FsyncPolicy fsyncPolicyFromString(const std::string& name, FsyncPolicy fallback) {
+    if (name == "always") return FsyncPolicy::ALWAYS;
+    if (name == "interval") return FsyncPolicy::INTERVAL;
+    if (name == "never") return FsyncPolicy::NEVER;
+    return fallback;
+}
+
+BookLog::BookLog(std::string path, FsyncPolicy policy)
+    : path_(std::move(path)), policy_(policy) {
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw systemError("Failed to open storage log", path_);
+    }
+}
+
+BookLog::~BookLog() {
+    if (fd_ >= 0) {
+        if (policy_ != FsyncPolicy::NEVER) {
+            ::fdatasync(fd_);
+        }
+        ::close(fd_);
+    }
+}
+
+BookLog::State BookLog::replay() {
+    State state;
+
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+        throw systemError("Failed to stat storage log", path_);
+    }
+    std::string data(static_cast<std::size_t>(st.st_size), '\0');
+    std::size_t read_total = 0;
+    while (read_total < data.size()) {
+        const ssize_t n = ::pread(fd_, data.data() + read_total, data.size() - read_total,
+                                  static_cast<off_t>(read_total));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw systemError("Failed to read storage log", path_);
+        }
+        read_total += static_cast<std::size_t>(n);
+    }
+
+    // Новый файл (или оборванный на заголовке): пишем заголовок заново
+    if (data.size() < sizeof(kMagic)) {
+        if (::ftruncate(fd_, 0) != 0) {
+            throw systemError("Failed to truncate storage log", path_);
+        }
+        writeAll(fd_, kMagic, sizeof(kMagic), path_);
+        ::fdatasync(fd_);
+        file_bytes_ = live_bytes_ = sizeof(kMagic);
+        return state;
+    }
+    if (std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a bookshelf storage log: " + path_);
+    }
+
+    file_bytes_ = live_bytes_ = sizeof(kMagic);
+    std::size_t pos = sizeof(kMagic);
+    std::uint64_t records = 0;
+    while (pos < data.size()) {
+        if (data.size() - pos < kRecordHeader + 1) {
+            break;
+        }
+        std::uint32_t length;
+        std::uint32_t crc;
+        std::memcpy(&length, data.data() + pos, sizeof(length));
+        std::memcpy(&crc, data.data() + pos + sizeof(length), sizeof(crc));
+        if (length == 0 || length > kMaxRecordSize || data.size() - pos - kRecordHeader < length) {
+            break;
+        }
+        const char* body = data.data() + pos + kRecordHeader;
+        if (crc32(body, length) != crc) {
+            break;
+        }
+
+        const auto type = static_cast<RecordType>(body[0]);
+        Reader reader(body + 1, length - 1);
+        int id = 0;
+        if (type == PUT) {
+            BookRow book;
+            if (!decodeBook(reader, book)) {
+                break;
+            }
+            id = book.id;
+            state.next_id = std::max(state.next_id, id + 1);
+            state.books[id] = std::move(book);
+        } else if (type == DELETE) {
+            id = reader.get<std::int32_t>();
+            if (!reader.ok()) {
+                break;
+            }
+            state.books.erase(id);
+        } else if (type == NEXT_ID) {
+            const auto next_id = reader.get<std::int32_t>();
+            if (!reader.ok()) {
+                break;
+            }
+            state.next_id = std::max(state.next_id, static_cast<int>(next_id));
+        } else {
+            break;
+        }
+
+        const auto record_bytes = static_cast<std::uint32_t>(kRecordHeader + length);
+        file_bytes_ += record_bytes;
+        track(type, id, record_bytes);
+        pos += record_bytes;
+        ++records;
+    }
+
+    if (pos < data.size()) {
+        LOG_WARN("Storage log: truncating damaged tail", {
+            {"path", path_},
+            {"offset", static_cast<unsigned long long>(pos)},
+            {"dropped_bytes", static_cast<unsigned long long>(data.size() - pos)}
+        });
+        if (::ftruncate(fd_, static_cast<off_t>(pos)) != 0) {
+            throw systemError("Failed to truncate storage log", path_);
+        }
+        ::fdatasync(fd_);
+    }
+    if (::lseek(fd_, static_cast<off_t>(pos), SEEK_SET) < 0) {
+        throw systemError("Failed to seek storage log", path_);
+    }
+
+    LOG_INFO("Storage log replayed", {
+        {"path", path_},
+        {"records", static_cast<unsigned long long>(records)},
+        {"books", static_cast<unsigned long long>(state.books.size())},
+        {"bytes", static_cast<unsigned long long>(file_bytes_)}
+    });
+    return state;
+}
+
+void BookLog::appendPut(const BookRow& book) {
+    buffer_.clear();
+    encodeBook(buffer_, book);
+    append(PUT, buffer_, book.id);
+}
+
+void BookLog::appendDelete(int id) {
+    buffer_.clear();
+    put(buffer_, static_cast<std::int32_t>(id));
+    append(DELETE, buffer_, id);
+}
+
+void BookLog::append(RecordType type, const std::string& payload, int id) {
+    writeRecord(type, payload, id);
+    if (policy_ == FsyncPolicy::ALWAYS) {
+        if (::fdatasync(fd_) != 0) {
+            throw systemError("Failed to sync storage log", path_);
+        }
+    } else {
+        dirty_.store(true, std::memory_order_release);
+    }
+}
+
+void BookLog::writeRecord(RecordType type, const std::string& payload, int id) {
+    // Запись собирается целиком и уходит одним write: при сбое в файле
+    // остается либо она вся, либо оборванный хвост, который отрежет replay
+    std::string record;
+    const auto length = static_cast<std::uint32_t>(payload.size() + 1);
+    record.reserve(kRecordHeader + length);
+    put(record, length);
+    put(record, std::uint32_t{0});
+    record.push_back(static_cast<char>(type));
+    record.append(payload);
+    const std::uint32_t crc = crc32(record.data() + kRecordHeader, length);
+    std::memcpy(record.data() + sizeof(length), &crc, sizeof(crc));
+
+    writeAll(fd_, record.data(), record.size(), path_);
+    file_bytes_ += record.size();
+    track(type, id, static_cast<std::uint32_t>(record.size()));
+}
+
+void BookLog::track(RecordType type, int id, std::uint32_t record_bytes) {
+    if (type != PUT && type != DELETE) {
+        return;
+    }
+    const auto it = live_records_.find(id);
+    if (it != live_records_.end()) {
+        live_bytes_ -= it->second;
+        live_records_.erase(it);
+    }
+    if (type == PUT) {
+        live_records_.emplace(id, record_bytes);
+        live_bytes_ += record_bytes;
+    }
+}
+
+void BookLog::sync() {
+    if (dirty_.exchange(false, std::memory_order_acq_rel)) {
+        ::fdatasync(fd_);
+    }
+}
+
+void BookLog::compact(const std::vector<const BookRow*>& books, int next_id) {
+    const std::string tmp_path = path_ + ".compact";
+    const int fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw systemError("Failed to create", tmp_path);
+    }
+
+    const std::uint64_t old_bytes = file_bytes_;
+    const int old_fd = fd_;
+    auto old_records = std::move(live_records_);
+    live_records_.clear();
+    try {
+        fd_ = fd;
+        writeAll(fd_, kMagic, sizeof(kMagic), tmp_path);
+        file_bytes_ = live_bytes_ = sizeof(kMagic);
+
+        // next_id сохраняется отдельно: книга с наибольшим id может быть удалена
+        buffer_.clear();
+        put(buffer_, static_cast<std::int32_t>(next_id));
+        writeRecord(NEXT_ID, buffer_, 0);
+        for (const BookRow* book : books) {
+            buffer_.clear();
+            encodeBook(buffer_, *book);
+            writeRecord(PUT, buffer_, book->id);
+        }
+        if (::fdatasync(fd_) != 0 || ::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+            throw systemError("Failed to install compacted log", path_);
+        }
+    } catch (...) {
+        // Старый журнал не тронут: продолжаем писать в него
+        ::close(fd);
+        ::unlink(tmp_path.c_str());
+        fd_ = old_fd;
+        file_bytes_ = old_bytes;
+        live_records_ = std::move(old_records);
+        live_bytes_ = sizeof(kMagic);
+        for (const auto& [id, bytes] : live_records_) {
+            live_bytes_ += bytes;
+        }
+        throw;
+    }
+
+    syncDirectory(path_);
+    ::close(old_fd);
+    dirty_.store(false, std::memory_order_release);
+
+    LOG_INFO("Storage log compacted", {
+        {"path", path_},
+        {"books", static_cast<unsigned long long>(books.size())},
+        {"bytes_before", static_cast<unsigned long long>(old_bytes)},
+        {"bytes_after", static_cast<unsigned long long>(file_bytes_)}
+    });
+}
+
+} // namespace storage
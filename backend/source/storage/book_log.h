@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "model/book.h"
+
+namespace storage {
+
+// Когда данные журнала сбрасываются на диск
+enum class FsyncPolicy {
+    ALWAYS,     // fdatasync после каждой записи: подтвержденная запись переживает сбой ОС
+    INTERVAL,   // фоновый fdatasync раз в интервал: при сбое ОС теряется не больше интервала
+    NEVER       // сброс на усмотрение ОС: переживает только падение процесса
+};
+
+FsyncPolicy fsyncPolicyFromString(const std::string& name, FsyncPolicy fallback = FsyncPolicy::INTERVAL);
+
+// Журнал книг только на дозапись. Файл: заголовок "BKSHLOG1", затем записи
+// [длина u32][crc32 u32][тип u8][данные], числа в порядке байт платформы.
+// Запись PUT хранит книгу целиком, DELETE - только id; последняя запись по id побеждает.
+// Не потокобезопасен: вызывающий сериализует append* и compact
+class BookLog {
+public:
+    // Состояние после воспроизведения журнала
+    struct State {
+        std::unordered_map<int, BookRow> books;
+        int next_id = 1;
+    };
+
+    BookLog(std::string path, FsyncPolicy policy);
+    ~BookLog();
+
+    // Читает журнал и восстанавливает состояние. Оборванная или поврежденная
+    // запись в хвосте (сбой посреди записи) отрезается вместе со всем после нее
+    State replay();
+
+    void appendPut(const BookRow& book);
+    void appendDelete(int id);
+
+    // Сброс дозаписанного на диск, если с прошлого раза были записи
+    void sync();
+
+    // Переписывает журнал, оставляя только живые книги: новый файл пишется
+    // рядом и атомарно подменяет старый через rename
+    void compact(const std::vector<const BookRow*>& books, int next_id);
+
+    FsyncPolicy policy() const { return policy_; }
+    std::uint64_t fileBytes() const { return file_bytes_; }
+    // Байты записей, которые уже перекрыты более поздними (мусор для уплотнения)
+    std::uint64_t garbageBytes() const { return file_bytes_ - live_bytes_; }
+
+    BookLog(const BookLog&) = delete;
+    BookLog& operator=(const BookLog&) = delete;
+
+private:
+    enum RecordType : std::uint8_t {
+        PUT = 1,
+        DELETE = 2,
+        NEXT_ID = 3
+    };
+
+    void append(RecordType type, const std::string& payload, int id);
+    void writeRecord(RecordType type, const std::string& payload, int id);
+    void track(RecordType type, int id, std::uint32_t record_bytes);
+
+    std::string path_;
+    FsyncPolicy policy_;
+    int fd_ = -1;
+
+    std::uint64_t file_bytes_ = 0;
+    std::uint64_t live_bytes_ = 0;
+    std::unordered_map<int, std::uint32_t> live_records_;   // id -> размер последней записи PUT
+    std::atomic<bool> dirty_{false};
+    std::string buffer_;
+};
+
+} // namespace storage
@@ -0,0 +1,132 @@
+// Усечение записей логгера, не помещающихся в слот кольцевого буфера.
+// Запуск: ctest или ./bookshelf_logger_test; код выхода 0 - все проверки прошли
+
+#include "logger/logger.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(condition)                                                                     \
+    do {                                                                                     \
+        if (!(condition)) {                                                                  \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++g_failures;                                                                    \
+        }                                                                                    \
+    } while (0)
+
+// Размер слота Logger вместе с переводом строки
+constexpr std::size_t kSlotSize = 1024 - sizeof(std::size_t) - sizeof(std::uint32_t);
+
+std::string repeat(const std::string& part, std::size_t count) {
+    std::string result;
+    for (std::size_t i = 0; i < count; ++i) {
+        result += part;
+    }
+    return result;
+}
+
+const std::string kSmallMessage = "small\"\x01";
+
+// Сообщения, которые после экранирования в разы длиннее исходного текста
+std::vector<std::string> oversizeMessages() {
+    return {
+        repeat("\"", 2000),
+        repeat("\x01", 2000),
+        repeat("\"\\\n\x1f", 500),
+        repeat("я", 1000),
+        "a" + repeat("я", 300) + repeat("\x02", 500),
+        repeat("\x03", 505) + repeat("€", 400),
+    };
+}
+
+void logAll(const std::vector<std::string>& messages) {
+    auto& logger = logger::Logger::instance();
+    for (const auto& message : messages) {
+        logger.log(logger::Level::WARN, message);
+    }
+    // Мелкое сообщение с крупным полем: сообщение сохраняется целиком
+    logger.log(logger::Level::WARN, kSmallMessage, {{"payload", repeat("\x04", 1000)}});
+}
+
+void checkRecords(const std::string& path, const std::vector<std::string>& messages) {
+    std::ifstream in(path);
+    std::string line;
+    std::size_t index = 0;
+    while (std::getline(in, line)) {
+        CHECK(line.size() + 1 <= kSlotSize);
+
+        nlohmann::json record;
+        try {
+            record = nlohmann::json::parse(line);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "record %zu is not valid JSON: %s\n", index, e.what());
+            ++g_failures;
+            ++index;
+            continue;
+        }
+
+        CHECK(record.value("truncated", false));
+        CHECK(!record.contains("payload"));
+        const std::string msg = record.value("msg", std::string());
+        if (index < messages.size()) {
+            CHECK(!msg.empty());
+            CHECK(messages[index].compare(0, msg.size(), msg) == 0);
+            CHECK(messages[index] != kSmallMessage || msg == kSmallMessage);
+        }
+        ++index;
+    }
+    CHECK(index == messages.size());
+}
+
+} // namespace
+
+int main() {
+    char path[] = "/tmp/bookshelf-logger-XXXXXX";
+    const int fd = ::mkstemp(path);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        return 2;
+    }
+    const int saved_stderr = ::dup(STDERR_FILENO);
+    ::dup2(fd, STDERR_FILENO);
+
+    const auto messages = oversizeMessages();
+    auto& logger = logger::Logger::instance();
+
+    // Через кольцевой буфер и фоновый поток
+    logAll(messages);
+    logger.shutdown();
+    // После остановки фонового потока запись идет синхронно
+    logAll(messages);
+
+    ::dup2(saved_stderr, STDERR_FILENO);
+    ::close(saved_stderr);
+    ::close(fd);
+
+    CHECK(logger.droppedCount() == 0);
+
+    std::vector<std::string> expected = messages;
+    expected.push_back(kSmallMessage);
+    expected.insert(expected.end(), messages.begin(), messages.end());
+    expected.push_back(kSmallMessage);
+    checkRecords(path, expected);
+    ::unlink(path);
+
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("all logger checks passed\n");
+    return 0;
+}
@@ -0,0 +1,367 @@
+// Восстановление встроенного хранилища (BookLog, LogBookRepository) после сбоев.
+// Запуск: ctest или ./bookshelf_storage_test; код выхода 0 - все проверки прошли
+
+#include "repository/log_book_repository.h"
+#include "storage/book_log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(condition)                                                                     \
+    do {                                                                                     \
+        if (!(condition)) {                                                                  \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++g_failures;                                                                    \
+        }                                                                                    \
+    } while (0)
+
+// Отдельный каталог на каждый тест, удаляется по завершении
+class TempDir {
+public:
+    TempDir() {
+        std::string pattern = (fs::temp_directory_path() / "bookshelf-storage-XXXXXX").string();
+        if (::mkdtemp(pattern.data()) == nullptr) {
+            std::perror("mkdtemp");
+            std::exit(2);
+        }
+        path_ = pattern;
+    }
+    ~TempDir() {
+        std::error_code ignored;
+        fs::remove_all(path_, ignored);
+    }
+
+    std::string file(const char* name) const { return (path_ / name).string(); }
+
+private:
+    fs::path path_;
+};
+
+BookRow makeBook(int id, const std::string& title) {
+    BookRow book;
+    book.id = id;
+    book.title = title;
+    book.author = "Author " + std::to_string(id);
+    book.status = "planned";
+    book.review = "review of " + title;
+    book.created_at = "2024-01-01 00:00:00";
+    book.updated_at = book.created_at;
+    return book;
+}
+
+BookInput makeInput(const std::string& title) {
+    BookInput input;
+    input.title = title;
+    input.author = "Author";
+    input.present = BookInput::TITLE | BookInput::AUTHOR;
+    return input;
+}
+
+std::uint64_t fileSize(const std::string& path) {
+    return static_cast<std::uint64_t>(fs::file_size(path));
+}
+
+void flipByte(const std::string& path, std::uint64_t offset) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(offset));
+    char byte = 0;
+    file.get(byte);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.put(static_cast<char>(byte ^ 0x5A));
+}
+
+LogBookRepository::Settings repositorySettings(const std::string& path, storage::FsyncPolicy policy) {
+    LogBookRepository::Settings settings;
+    settings.path = path;
+    settings.fsync = policy;
+    settings.fsync_interval = std::chrono::milliseconds(10);
+    return settings;
+}
+
+// Сбой посреди записи: последняя запись оборвана и отрезается, остальные целы
+void testTornTail() {
+    TempDir dir;
+    const std::string path = dir.file("books.log");
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        log.replay();
+        log.appendPut(makeBook(1, "one"));
+        log.appendPut(makeBook(2, "two"));
+        log.appendPut(makeBook(3, "three"));
+    }
+    const std::uint64_t full_size = fileSize(path);
+    fs::resize_file(path, full_size - 5);
+
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        const auto state = log.replay();
+        CHECK(state.books.size() == 2);
+        CHECK(state.books.count(1) == 1 && state.books.count(2) == 1);
+        CHECK(state.books.count(3) == 0);
+        CHECK(state.books.at(2).review == "review of two");
+        CHECK(state.next_id == 3);
+        // Хвост отрезан в файле, новые записи идут за последней целой
+        CHECK(fileSize(path) == log.fileBytes());
+        log.appendPut(makeBook(4, "four"));
+    }
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        const auto state = log.replay();
+        CHECK(state.books.size() == 3);
+        CHECK(state.books.count(4) == 1);
+        CHECK(state.next_id == 5);
+    }
+
+    // Оборван даже заголовок: журнал начинается заново
+    fs::resize_file(path, 3);
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        const auto state = log.replay();
+        CHECK(state.books.empty());
+        CHECK(state.next_id == 1);
+        log.appendPut(makeBook(1, "again"));
+    }
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        CHECK(log.replay().books.size() == 1);
+    }
+}
+
+// Поврежденная запись в середине: она и все после нее отбрасываются
+void testCrcCorruptionMidFile() {
+    TempDir dir;
+    const std::string path = dir.file("books.log");
+    std::uint64_t second_record = 0;
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        log.replay();
+        log.appendPut(makeBook(1, "one"));
+        second_record = log.fileBytes();
+        log.appendPut(makeBook(2, "two"));
+        log.appendPut(makeBook(3, "three"));
+    }
+    // Байт данных записи (после длины и crc32), а не ее заголовка
+    flipByte(path, second_record + 8 + 4);
+
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        const auto state = log.replay();
+        CHECK(state.books.size() == 1);
+        CHECK(state.books.count(1) == 1);
+        CHECK(state.next_id == 2);
+        CHECK(fileSize(path) == second_record);
+    }
+    {
+        // Повторный старт видит то же состояние
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        const auto state = log.replay();
+        CHECK(state.books.size() == 1);
+        CHECK(fileSize(path) == second_record);
+    }
+}
+
+// Удаленный id не выдается снова после перезапуска
+void testDeletedIdNotReused() {
+    TempDir dir;
+    const std::string path = dir.file("books.log");
+    {
+        LogBookRepository repository(repositorySettings(path, storage::FsyncPolicy::ALWAYS));
+        CHECK(repository.createBook(makeInput("one")).value() == 1);
+        CHECK(repository.createBook(makeInput("two")).value() == 2);
+        CHECK(repository.createBook(makeInput("three")).value() == 3);
+        CHECK(static_cast<bool>(repository.deleteBook(3)));
+        CHECK(static_cast<bool>(repository.deleteBook(2)));
+    }
+    {
+        LogBookRepository repository(repositorySettings(path, storage::FsyncPolicy::ALWAYS));
+        CHECK(repository.getAllBooks().size() == 1);
+        CHECK(!repository.getBookById(3));
+        CHECK(repository.createBook(makeInput("four")).value() == 4);
+    }
+}
+
+// После уплотнения состояние и next_id те же, даже если книги с наибольшим id нет
+void testRestartAfterCompaction() {
+    TempDir dir;
+    const std::string path = dir.file("books.log");
+    const BookRow one = makeBook(1, "one");
+    const BookRow two = makeBook(2, "two");
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        log.replay();
+        log.appendPut(one);
+        log.appendPut(two);
+        log.appendPut(makeBook(3, "three"));
+        log.appendPut(makeBook(2, "two"));
+        log.appendDelete(3);
+        const std::uint64_t before = log.fileBytes();
+        log.compact({&one, &two}, 4);
+        CHECK(log.fileBytes() < before);
+        // Сразу после уплотнения оно не должно требоваться снова
+        CHECK(log.garbageBytes() * 2 < log.fileBytes());
+        CHECK(fileSize(path) == log.fileBytes());
+        CHECK(!fs::exists(path + ".compact"));
+        // Дозапись после уплотнения идет в новый файл
+        log.appendPut(makeBook(4, "four"));
+    }
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        const auto state = log.replay();
+        CHECK(state.books.size() == 3);
+        CHECK(state.books.count(3) == 0);
+        CHECK(state.books.count(4) == 1);
+        CHECK(state.next_id == 5);
+    }
+
+    // Уплотнение без единой живой книги
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        log.replay();
+        log.compact({}, 7);
+    }
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        const auto state = log.replay();
+        CHECK(state.books.empty());
+        CHECK(state.next_id == 7);
+    }
+}
+
+// Уплотнение в фоне LogBookRepository и перезапуск после него
+void testRepositoryCompaction() {
+    TempDir dir;
+    const std::string path = dir.file("books.log");
+    auto settings = repositorySettings(path, storage::FsyncPolicy::INTERVAL);
+    settings.compact_interval = std::chrono::seconds(1);
+    settings.compact_min_bytes = 0;
+    {
+        LogBookRepository repository(settings);
+        for (int i = 0; i < 20; ++i) {
+            repository.createBook(makeInput("book " + std::to_string(i)));
+        }
+        for (int id = 1; id <= 19; ++id) {
+            repository.deleteBook(id);
+        }
+        const std::uint64_t before = fileSize(path);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (fileSize(path) >= before && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        CHECK(fileSize(path) < before);
+    }
+    {
+        LogBookRepository repository(settings);
+        const auto books = repository.getAllBooks();
+        CHECK(books.size() == 1);
+        CHECK(!books.empty() && books.front().id == 20 && books.front().title == "book 19");
+        CHECK(repository.createBook(makeInput("next")).value() == 21);
+    }
+}
+
+// Сбой между записью временного файла и rename: действует старый журнал,
+// а оставшийся временный файл не мешает следующему уплотнению
+void testCrashBeforeRename() {
+    TempDir dir;
+    const std::string path = dir.file("books.log");
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        log.replay();
+        log.appendPut(makeBook(1, "one"));
+        log.appendPut(makeBook(2, "two"));
+    }
+    // Полностью записанный, но не подставленный уплотненный журнал
+    {
+        storage::BookLog partial(path + ".compact", storage::FsyncPolicy::NEVER);
+        partial.replay();
+        partial.appendPut(makeBook(99, "stale"));
+    }
+
+    const BookRow one = makeBook(1, "one");
+    const BookRow two = makeBook(2, "two");
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        const auto state = log.replay();
+        CHECK(state.books.size() == 2);
+        CHECK(state.books.count(99) == 0);
+        CHECK(state.next_id == 3);
+        log.compact({&one, &two}, 3);
+        CHECK(!fs::exists(path + ".compact"));
+    }
+    {
+        storage::BookLog log(path, storage::FsyncPolicy::NEVER);
+        const auto state = log.replay();
+        CHECK(state.books.size() == 2);
+        CHECK(state.books.count(99) == 0);
+    }
+}
+
+// Падение процесса без деструкторов при каждой политике fsync: подтвержденные
+// записи уже в файле (переживание сбоя ОС здесь не проверить)
+void testFsyncPolicies() {
+    CHECK(storage::fsyncPolicyFromString("always") == storage::FsyncPolicy::ALWAYS);
+    CHECK(storage::fsyncPolicyFromString("interval") == storage::FsyncPolicy::INTERVAL);
+    CHECK(storage::fsyncPolicyFromString("never") == storage::FsyncPolicy::NEVER);
+    CHECK(storage::fsyncPolicyFromString("bogus", storage::FsyncPolicy::NEVER) == storage::FsyncPolicy::NEVER);
+
+    for (const auto policy : {storage::FsyncPolicy::ALWAYS, storage::FsyncPolicy::INTERVAL,
+                              storage::FsyncPolicy::NEVER}) {
+        TempDir dir;
+        const std::string path = dir.file("books.log");
+
+        const pid_t child = ::fork();
+        if (child == 0) {
+            LogBookRepository repository(repositorySettings(path, policy));
+            repository.createBook(makeInput("one"));
+            repository.createBook(makeInput("two"));
+            BookInput update;
+            update.status = "reading";
+            update.present = BookInput::STATUS;
+            repository.updateBook(1, update);
+            repository.deleteBook(2);
+            ::_exit(0);
+        }
+        int status = 0;
+        CHECK(child > 0 && ::waitpid(child, &status, 0) == child);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+        LogBookRepository repository(repositorySettings(path, policy));
+        const auto books = repository.getAllBooks();
+        CHECK(books.size() == 1);
+        CHECK(!books.empty() && books.front().id == 1 && books.front().status == "reading");
+        CHECK(repository.createBook(makeInput("three")).value() == 3);
+    }
+}
+
+} // namespace
+
+int main() {
+    testTornTail();
+    testCrcCorruptionMidFile();
+    testDeletedIdNotReused();
+    testRestartAfterCompaction();
+    testRepositoryCompaction();
+    testCrashBeforeRename();
+    testFsyncPolicies();
+
+    if (g_failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("All storage recovery checks passed\n");
+    return 0;
+}
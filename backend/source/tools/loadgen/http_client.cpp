@@ -0,0 +1,233 @@
+#include "tools/loadgen/http_client.h"
+#include "capture/capture_format.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace loadgen {
+
+namespace {
+
+bool startsWithIgnoreCase(std::string_view line, std::string_view prefix) {
+    return line.size() >= prefix.size() &&
+           std::equal(prefix.begin(), prefix.end(), line.begin(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+           });
+}
+
+// Server-Timing: ...total;dur=12.345
+double serverTotalMs(std::string_view value) {
+    const auto total = value.find("total;dur=");
+    if (total == std::string_view::npos) {
+        return -1.0;
+    }
+    return std::strtod(std::string(value.substr(total + 10)).c_str(), nullptr);
+}
+
+} // namespace
+
+HttpClient::HttpClient(std::string host, std::uint16_t port, bool keep_alive,
+                       std::chrono::milliseconds timeout)
+    : host_(std::move(host)), port_(port), keep_alive_(keep_alive), timeout_(timeout) {
+    request_buf_.reserve(1024);
+    read_buf_.reserve(64 * 1024);
+}
+
+HttpClient::~HttpClient() {
+    disconnect();
+}
+
+bool HttpClient::connect() {
+    if (!unix_path_.empty()) {
+        sockaddr_un address{};
+        if (unix_path_.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, unix_path_.c_str(), unix_path_.size() + 1);
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0) {
+            return false;
+        }
+        if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        prepareSocket();
+        return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    const std::string port = std::to_string(port_);
+    if (getaddrinfo(host_.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        return false;
+    }
+
+    for (addrinfo* addr = addresses; addr != nullptr; addr = addr->ai_next) {
+        fd_ = ::socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (fd_ < 0) {
+            continue;
+        }
+        if (::connect(fd_, addr->ai_addr, addr->ai_addrlen) == 0) {
+            break;
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    const int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    prepareSocket();
+    return true;
+}
+
+void HttpClient::prepareSocket() {
+    timeval tv{};
+    tv.tv_sec = static_cast<time_t>(timeout_.count() / 1000);
+    tv.tv_usec = static_cast<suseconds_t>((timeout_.count() % 1000) * 1000);
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    read_buf_.clear();
+}
+
+void HttpClient::disconnect() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool HttpClient::sendAll(const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+HttpResult HttpClient::request(std::string_view method, std::string_view path, std::string_view body,
+                               std::string_view extra_headers) {
+    request_buf_.clear();
+    request_buf_.append(method).append(" ").append(path).append(" HTTP/1.1\r\nHost: ");
+    request_buf_.append(host_).append("\r\n");
+    request_buf_.append(keep_alive_ ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    request_buf_.append(extra_headers);
+    if (!body.empty()) {
+        request_buf_.append("Content-Type: application/json\r\nContent-Length: ");
+        request_buf_.append(std::to_string(body.size())).append("\r\n");
+    }
+    request_buf_.append("\r\n").append(body);
+
+    // Сервер мог закрыть простаивающее keep-alive соединение - одна повторная попытка
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        const bool fresh = fd_ < 0;
+        if (fresh && !connect()) {
+            return {};
+        }
+        if (!sendAll(request_buf_)) {
+            disconnect();
+            if (fresh) {
+                return {};
+            }
+            continue;
+        }
+        HttpResult result = readResponse();
+        if (result.status == 0 && !fresh) {
+            continue;
+        }
+        if (!keep_alive_) {
+            disconnect();
+        }
+        return result;
+    }
+    return {};
+}
+
+HttpResult HttpClient::readResponse() {
+    char chunk[16 * 1024];
+    std::size_t header_end = std::string::npos;
+
+    while ((header_end = read_buf_.find("\r\n\r\n")) == std::string::npos) {
+        const ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            disconnect();
+            return {};
+        }
+        read_buf_.append(chunk, static_cast<std::size_t>(n));
+    }
+
+    HttpResult result;
+    std::size_t content_length = 0;
+    bool close_after = false;
+
+    std::string_view headers(read_buf_.data(), header_end);
+    std::size_t line_start = 0;
+    bool first = true;
+    while (line_start <= headers.size()) {
+        std::size_t line_end = headers.find("\r\n", line_start);
+        if (line_end == std::string_view::npos) {
+            line_end = headers.size();
+        }
+        const std::string_view line = headers.substr(line_start, line_end - line_start);
+        if (first) {
+            // HTTP/1.1 200 OK
+            const auto space = line.find(' ');
+            if (space != std::string_view::npos) {
+                result.status = std::atoi(std::string(line.substr(space + 1, 3)).c_str());
+            }
+            first = false;
+        } else if (startsWithIgnoreCase(line, "content-length:")) {
+            content_length = static_cast<std::size_t>(std::strtoull(std::string(line.substr(15)).c_str(), nullptr, 10));
+        } else if (startsWithIgnoreCase(line, "connection:") &&
+                   line.find("close") != std::string_view::npos) {
+            close_after = true;
+        } else if (startsWithIgnoreCase(line, "server-timing:")) {
+            result.server_ms = serverTotalMs(line.substr(14));
+        }
+        line_start = line_end + 2;
+    }
+
+    const std::size_t total = header_end + 4 + content_length;
+    while (read_buf_.size() < total) {
+        const ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            disconnect();
+            return {};
+        }
+        read_buf_.append(chunk, static_cast<std::size_t>(n));
+    }
+
+    result.body_bytes = content_length;
+    if (hash_bodies_) {
+        result.body_hash = capture::bodyHash(std::string_view(read_buf_).substr(header_end + 4, content_length));
+    }
+    read_buf_.erase(0, total);
+    if (close_after) {
+        disconnect();
+    }
+    return result;
+}
+
+} // namespace loadgen
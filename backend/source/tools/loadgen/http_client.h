@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace loadgen {
+
+struct HttpResult {
+    int status = 0;             // 0 - ошибка соединения или таймаут
+    std::size_t body_bytes = 0;
+    std::uint64_t body_hash = 0;    // только при setHashBodies(true)
+    double server_ms = -1.0;        // total из Server-Timing, -1 если заголовка нет
+};
+
+// Минимальный HTTP/1.1 клиент на одном сокете с keep-alive.
+// Разбирает только то, что отдает Crow: статус, Content-Length, Connection
+class HttpClient {
+public:
+    HttpClient(std::string host, std::uint16_t port, bool keep_alive,
+               std::chrono::milliseconds timeout);
+    ~HttpClient();
+
+    // extra_headers - готовые строки заголовков, каждая с \r\n в конце
+    HttpResult request(std::string_view method, std::string_view path, std::string_view body = {},
+                       std::string_view extra_headers = {});
+
+    // Считать хэш тела ответа (capture::bodyHash) для сравнения ответов
+    void setHashBodies(bool enabled) { hash_bodies_ = enabled; }
+
+    // Соединяться через Unix domain socket вместо host:port (host остается в заголовке Host)
+    void setUnixSocket(std::string path) { unix_path_ = std::move(path); }
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+private:
+    bool connect();
+    void prepareSocket();
+    void disconnect();
+    bool sendAll(const std::string& data);
+    HttpResult readResponse();
+
+    std::string host_;
+    std::uint16_t port_;
+    std::string unix_path_;
+    bool keep_alive_;
+    bool hash_bodies_ = false;
+    std::chrono::milliseconds timeout_;
+    int fd_ = -1;
+    std::string request_buf_;
+    std::string read_buf_;
+};
+
+} // namespace loadgen
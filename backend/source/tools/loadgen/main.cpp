@@ -0,0 +1,377 @@
+// bookshelf_loadgen - генератор нагрузки для REST API.
+//
+//   bookshelf_loadgen --port 8080 --connections 32 --duration 30 --mode open --rate 5000
+//                     --mix get=80,list=10,create=5,update=5 --json result.json
+//
+// Сравнение транспортов: тот же прогон с --unix /run/bookshelf.sock вместо --port
+// (поле transport в JSON), разница видна в задержках и пропускной способности.
+//
+// open   - постоянная интенсивность: запросы уходят по расписанию, задержка
+//          считается от запланированного времени отправки (без coordinated omission).
+// closed - каждое соединение шлет следующий запрос сразу после ответа; задержки
+//          дополнительно корректируются как HdrHistogram::copyCorrectedForCoordinatedOmission
+//          с ожидаемым интервалом --expected-interval-us (по умолчанию среднее время ответа).
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics/histogram.h"
+#include "serializer/json_writer.h"
+#include "tools/loadgen/http_client.h"
+#include "tools/loadgen/workload.h"
+
+using namespace loadgen;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 8080;
+    std::string unix_path;              // непусто - Unix domain socket вместо TCP
+    unsigned connections = 16;
+    double duration_s = 10.0;
+    double warmup_s = 2.0;
+    bool open_loop = false;
+    double rate = 1000.0;               // запросов в секунду на все соединения (open)
+    std::uint64_t expected_interval_us = 0;
+    bool keep_alive = true;
+    std::string mix = "get=80,list=10,create=5,update=5,stats=0";
+    int id_min = 1;
+    int id_max = 1000;
+    std::uint64_t seed = 42;
+    unsigned timeout_ms = 5000;
+    std::string json_path;
+};
+
+// Результаты одного соединения; объединяются после завершения
+struct WorkerStats {
+    std::array<metrics::Histogram, kOperationCount> response;   // от запланированного времени
+    std::array<metrics::Histogram, kOperationCount> service;    // от фактической отправки
+    std::array<std::uint64_t, 6> status_classes{};              // 0 - ошибки, 1xx..5xx
+    std::uint64_t bytes = 0;
+};
+
+void printUsage(const char* name) {
+    std::cout << "Usage: " << name << " [options]\n"
+              << "  --host H                 server host (127.0.0.1)\n"
+              << "  --port P                 server port (8080)\n"
+              << "  --unix PATH              connect over a Unix domain socket instead of TCP\n"
+              << "  --connections N          concurrent connections (16)\n"
+              << "  --duration S             measured seconds (10)\n"
+              << "  --warmup S               unmeasured warm-up seconds (2)\n"
+              << "  --mode open|closed       arrival model (closed)\n"
+              << "  --rate R                 total requests/s in open mode (1000)\n"
+              << "  --expected-interval-us U CO correction interval in closed mode (mean latency)\n"
+              << "  --no-keepalive           new connection per request\n"
+              << "  --mix SPEC               e.g. get=80,list=10,create=5,update=5,stats=0\n"
+              << "  --ids MIN:MAX            id range for get/update (1:1000)\n"
+              << "  --seed N                 RNG seed (42)\n"
+              << "  --timeout-ms N           socket timeout (5000)\n"
+              << "  --json PATH              write JSON report ('-' for stdout)\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--host") opts.host = value();
+        else if (arg == "--port") opts.port = static_cast<std::uint16_t>(std::stoul(value()));
+        else if (arg == "--unix") opts.unix_path = value();
+        else if (arg == "--connections") opts.connections = static_cast<unsigned>(std::stoul(value()));
+        else if (arg == "--duration") opts.duration_s = std::stod(value());
+        else if (arg == "--warmup") opts.warmup_s = std::stod(value());
+        else if (arg == "--mode") opts.open_loop = value() == "open";
+        else if (arg == "--rate") opts.rate = std::stod(value());
+        else if (arg == "--expected-interval-us") opts.expected_interval_us = std::stoull(value());
+        else if (arg == "--no-keepalive") opts.keep_alive = false;
+        else if (arg == "--mix") opts.mix = value();
+        else if (arg == "--ids") {
+            const std::string range = value();
+            const auto colon = range.find(':');
+            opts.id_min = std::stoi(range.substr(0, colon));
+            opts.id_max = colon == std::string::npos ? opts.id_min : std::stoi(range.substr(colon + 1));
+        }
+        else if (arg == "--seed") opts.seed = std::stoull(value());
+        else if (arg == "--timeout-ms") opts.timeout_ms = static_cast<unsigned>(std::stoul(value()));
+        else if (arg == "--json") opts.json_path = value();
+        else if (arg == "--help" || arg == "-h") { printUsage(argv[0]); return false; }
+        else throw std::invalid_argument("Unknown option: " + arg);
+    }
+    if (opts.connections == 0) {
+        throw std::invalid_argument("--connections must be positive");
+    }
+    return true;
+}
+
+std::uint64_t toNs(Clock::duration d) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+void runWorker(const Options& opts, const WorkloadMix& mix, unsigned index,
+               Clock::time_point measure_start, Clock::time_point end, WorkerStats& stats) {
+    HttpClient client(opts.host, opts.port, opts.keep_alive, std::chrono::milliseconds(opts.timeout_ms));
+    if (!opts.unix_path.empty()) {
+        client.setUnixSocket(opts.unix_path);
+    }
+    RequestFactory factory(opts.id_min, opts.id_max, index);
+    std::mt19937_64 rng(opts.seed * 1000003 + index);
+
+    // open: у каждого соединения свое расписание, сдвинутое на долю интервала
+    const auto interval = std::chrono::nanoseconds(
+        static_cast<std::int64_t>(1e9 * opts.connections / std::max(opts.rate, 1e-3)));
+    Clock::time_point next = Clock::now() + interval * index / opts.connections;
+
+    for (;;) {
+        Clock::time_point intended = Clock::now();
+        if (opts.open_loop) {
+            intended = next;
+            next += interval;
+            std::this_thread::sleep_until(intended);
+        }
+        // Отставшее от расписания соединение не продлевает прогон
+        if (intended >= end || Clock::now() >= end) {
+            break;
+        }
+
+        const Operation op = mix.pick(rng);
+        const RequestSpec spec = factory.make(op, rng);
+
+        const auto sent = Clock::now();
+        const HttpResult result = client.request(spec.method, spec.path, spec.body);
+        const auto done = Clock::now();
+
+        if (intended < measure_start) {
+            continue;
+        }
+        const auto o = static_cast<std::size_t>(op);
+        stats.response[o].record(toNs(done - intended));
+        stats.service[o].record(toNs(done - sent));
+        stats.status_classes[static_cast<std::size_t>(result.status / 100) % 6]++;
+        stats.bytes += result.body_bytes;
+    }
+}
+
+// Досчитывает значения, которые были бы получены при отправке по расписанию
+// (аналог HdrHistogram::copyCorrectedForCoordinatedOmission)
+metrics::Histogram correctForCoordinatedOmission(const metrics::Histogram& hist, std::uint64_t expected_ns) {
+    metrics::Histogram corrected;
+    corrected.merge(hist);
+    if (expected_ns == 0) {
+        return corrected;
+    }
+    for (std::size_t i = 0; i < metrics::LogLinearScale::kBucketCount; ++i) {
+        const std::uint64_t count = hist.bucket(i);
+        if (count == 0) {
+            continue;
+        }
+        const std::uint64_t value = metrics::LogLinearScale::lowerBound(i);
+        for (std::uint64_t missing = value > expected_ns ? value - expected_ns : 0;
+             missing >= expected_ns; missing -= expected_ns) {
+            corrected.record(missing, count);
+        }
+    }
+    return corrected;
+}
+
+constexpr double kPercentiles[] = {50.0, 90.0, 99.0, 99.9, 99.99};
+
+double toMs(std::uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+void printHistogramLine(const char* label, const metrics::Histogram& hist) {
+    std::printf("  %-8s %9llu", label, static_cast<unsigned long long>(hist.count()));
+    const double mean = hist.count() > 0 ? static_cast<double>(hist.sum()) / static_cast<double>(hist.count()) : 0.0;
+    std::printf(" %9.3f", mean / 1e6);
+    for (double p : kPercentiles) {
+        std::printf(" %9.3f", toMs(hist.valueAtQuantile(p / 100.0)));
+    }
+    std::printf(" %9.3f\n", toMs(hist.valueAtQuantile(1.0)));
+}
+
+void writeHistogramJson(serializer::JsonWriter& writer, const metrics::Histogram& hist) {
+    writer.beginObject(0);
+    writer.key("count");
+    writer.integer(static_cast<std::int64_t>(hist.count()));
+    writer.key("mean_ms");
+    writer.real(hist.count() > 0 ? toMs(hist.sum()) / static_cast<double>(hist.count()) : 0.0);
+    for (double p : kPercentiles) {
+        char key[32];
+        std::snprintf(key, sizeof(key), "p%g_ms", p);
+        writer.key(key);
+        writer.real(toMs(hist.valueAtQuantile(p / 100.0)));
+    }
+    writer.key("max_ms");
+    writer.real(toMs(hist.valueAtQuantile(1.0)));
+    writer.endObject();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    WorkloadMix mix;
+    try {
+        if (!parseOptions(argc, argv, opts)) {
+            return 0;
+        }
+        mix = WorkloadMix::parse(opts.mix);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    const auto start = Clock::now();
+    const auto measure_start = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opts.warmup_s));
+    const auto end = measure_start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opts.duration_s));
+
+    std::vector<WorkerStats> stats(opts.connections);
+    std::vector<std::thread> workers;
+    workers.reserve(opts.connections);
+    for (unsigned i = 0; i < opts.connections; ++i) {
+        workers.emplace_back(runWorker, std::cref(opts), std::cref(mix), i, measure_start, end, std::ref(stats[i]));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double elapsed_s = std::chrono::duration<double>(Clock::now() - measure_start).count();
+
+    // Объединение по соединениям
+    WorkerStats total;
+    for (const auto& s : stats) {
+        for (std::size_t o = 0; o < kOperationCount; ++o) {
+            total.response[o].merge(s.response[o]);
+            total.service[o].merge(s.service[o]);
+        }
+        for (std::size_t c = 0; c < total.status_classes.size(); ++c) {
+            total.status_classes[c] += s.status_classes[c];
+        }
+        total.bytes += s.bytes;
+    }
+
+    metrics::Histogram all_service;
+    metrics::Histogram all_response;
+    for (std::size_t o = 0; o < kOperationCount; ++o) {
+        all_service.merge(total.service[o]);
+    }
+
+    std::uint64_t expected_ns = 0;
+    if (opts.open_loop) {
+        for (std::size_t o = 0; o < kOperationCount; ++o) {
+            all_response.merge(total.response[o]);
+        }
+    } else {
+        expected_ns = opts.expected_interval_us > 0
+            ? opts.expected_interval_us * 1000
+            : (all_service.count() > 0 ? all_service.sum() / all_service.count() : 0);
+        for (std::size_t o = 0; o < kOperationCount; ++o) {
+            total.response[o] = correctForCoordinatedOmission(total.service[o], expected_ns);
+            all_response.merge(total.response[o]);
+        }
+    }
+
+    const std::uint64_t completed = all_service.count();
+    const double throughput = elapsed_s > 0 ? static_cast<double>(completed) / elapsed_s : 0.0;
+
+    std::printf("Mode: %s, connections: %u, duration: %.1fs, keep-alive: %s\n",
+                opts.open_loop ? "open" : "closed", opts.connections, elapsed_s, opts.keep_alive ? "on" : "off");
+    if (opts.open_loop) {
+        std::printf("Target rate: %.1f req/s\n", opts.rate);
+    } else {
+        std::printf("CO correction interval: %.3f ms\n", toMs(expected_ns));
+    }
+    std::printf("Throughput: %.1f req/s (%llu requests, %.1f MB received)\n", throughput,
+                static_cast<unsigned long long>(completed), static_cast<double>(total.bytes) / 1e6);
+    std::printf("Status: 2xx=%llu 3xx=%llu 4xx=%llu 5xx=%llu errors=%llu\n",
+                static_cast<unsigned long long>(total.status_classes[2]),
+                static_cast<unsigned long long>(total.status_classes[3]),
+                static_cast<unsigned long long>(total.status_classes[4]),
+                static_cast<unsigned long long>(total.status_classes[5]),
+                static_cast<unsigned long long>(total.status_classes[0] + total.status_classes[1]));
+
+    std::printf("\nLatency, ms (corrected)  %9s %9s %9s %9s %9s %9s %9s %9s\n",
+                "count", "mean", "p50", "p90", "p99", "p99.9", "p99.99", "max");
+    for (std::size_t o = 0; o < kOperationCount; ++o) {
+        if (total.response[o].count() > 0) {
+            printHistogramLine(operationName(static_cast<Operation>(o)), total.response[o]);
+        }
+    }
+    printHistogramLine("all", all_response);
+    std::printf("\nService time, ms (uncorrected)\n");
+    printHistogramLine("all", all_service);
+
+    if (!opts.json_path.empty()) {
+        std::string out;
+        serializer::JsonWriter writer(out);
+        writer.beginObject(0);
+        writer.key("mode");
+        writer.string(opts.open_loop ? "open" : "closed");
+        writer.key("transport");
+        writer.string(opts.unix_path.empty() ? "tcp" : "unix");
+        writer.key("connections");
+        writer.integer(opts.connections);
+        writer.key("keep_alive");
+        writer.boolean(opts.keep_alive);
+        writer.key("mix");
+        writer.string(opts.mix);
+        writer.key("target_rate");
+        writer.real(opts.open_loop ? opts.rate : 0.0);
+        writer.key("co_interval_ms");
+        writer.real(toMs(expected_ns));
+        writer.key("duration_s");
+        writer.real(elapsed_s);
+        writer.key("requests");
+        writer.integer(static_cast<std::int64_t>(completed));
+        writer.key("throughput_rps");
+        writer.real(throughput);
+        writer.key("errors");
+        writer.integer(static_cast<std::int64_t>(total.status_classes[0] + total.status_classes[1]));
+        writer.key("status");
+        writer.beginObject(0);
+        for (std::size_t c = 2; c < total.status_classes.size(); ++c) {
+            writer.key(std::to_string(c) + "xx");
+            writer.integer(static_cast<std::int64_t>(total.status_classes[c]));
+        }
+        writer.endObject();
+        writer.key("latency");
+        writeHistogramJson(writer, all_response);
+        writer.key("service_time");
+        writeHistogramJson(writer, all_service);
+        writer.key("operations");
+        writer.beginObject(0);
+        for (std::size_t o = 0; o < kOperationCount; ++o) {
+            if (total.response[o].count() > 0) {
+                writer.key(operationName(static_cast<Operation>(o)));
+                writeHistogramJson(writer, total.response[o]);
+            }
+        }
+        writer.endObject();
+        writer.endObject();
+        out += '\n';
+
+        if (opts.json_path == "-") {
+            std::fputs(out.c_str(), stdout);
+        } else {
+            std::ofstream file(opts.json_path);
+            file << out;
+        }
+    }
+
+    return total.status_classes[0] > 0 ? 1 : 0;
+}
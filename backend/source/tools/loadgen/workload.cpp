@@ -0,0 +1,103 @@
+#include "tools/loadgen/workload.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace loadgen {
+
+const char* operationName(Operation op) {
+    switch (op) {
+        case Operation::GET_BOOK: return "get";
+        case Operation::LIST_BOOKS: return "list";
+        case Operation::CREATE_BOOK: return "create";
+        case Operation::UPDATE_BOOK: return "update";
+        case Operation::GET_STATS: return "stats";
+        default: return "unknown";
+    }
+}
+
+WorkloadMix WorkloadMix::parse(const std::string& spec) {
+    WorkloadMix mix;
+    std::size_t pos = 0;
+    while (pos < spec.size()) {
+        std::size_t end = spec.find(',', pos);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        const std::string item = spec.substr(pos, end - pos);
+        pos = end + 1;
+
+        const auto eq = item.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Mix item without '=': " + item);
+        }
+        const std::string name = item.substr(0, eq);
+        const unsigned weight = static_cast<unsigned>(std::stoul(item.substr(eq + 1)));
+
+        bool known = false;
+        for (std::size_t i = 0; i < kOperationCount; ++i) {
+            if (name == operationName(static_cast<Operation>(i))) {
+                mix.weights_[i] = weight;
+                known = true;
+            }
+        }
+        if (!known) {
+            throw std::invalid_argument("Unknown operation in mix: " + name);
+        }
+    }
+
+    for (unsigned w : mix.weights_) {
+        mix.total_ += w;
+    }
+    if (mix.total_ == 0) {
+        throw std::invalid_argument("Mix has zero total weight");
+    }
+    return mix;
+}
+
+Operation WorkloadMix::pick(std::mt19937_64& rng) const {
+    unsigned value = static_cast<unsigned>(rng() % total_);
+    for (std::size_t i = 0; i < kOperationCount; ++i) {
+        if (value < weights_[i]) {
+            return static_cast<Operation>(i);
+        }
+        value -= weights_[i];
+    }
+    return Operation::GET_BOOK;
+}
+
+RequestFactory::RequestFactory(int id_min, int id_max, unsigned worker)
+    : id_min_(id_min), id_max_(std::max(id_min, id_max)), worker_(worker) {}
+
+int RequestFactory::randomId(std::mt19937_64& rng) const {
+    return id_min_ + static_cast<int>(rng() % static_cast<std::uint64_t>(id_max_ - id_min_ + 1));
+}
+
+RequestSpec RequestFactory::make(Operation op, std::mt19937_64& rng) {
+    static const char* const kStatuses[] = {"planned", "reading", "completed"};
+
+    switch (op) {
+        case Operation::GET_BOOK:
+            return {"GET", "/api/books/" + std::to_string(randomId(rng)), {}};
+        case Operation::LIST_BOOKS:
+            return {"GET", "/api/books", {}};
+        case Operation::CREATE_BOOK: {
+            ++sequence_;
+            std::string body = R"({"title":"Loadgen book )" + std::to_string(worker_) + "-" +
+                               std::to_string(sequence_) + R"(","author":"loadgen","year":)" +
+                               std::to_string(1900 + static_cast<int>(rng() % 125)) +
+                               R"(,"status":"planned","rating":)" + std::to_string(1 + rng() % 5) + "}";
+            return {"POST", "/api/books", std::move(body)};
+        }
+        case Operation::UPDATE_BOOK: {
+            std::string body = R"({"rating":)" + std::to_string(1 + rng() % 5) +
+                               R"(,"status":")" + kStatuses[rng() % 3] + "\"}";
+            return {"PUT", "/api/books/" + std::to_string(randomId(rng)), std::move(body)};
+        }
+        case Operation::GET_STATS:
+        default:
+            return {"GET", "/api/stats", {}};
+    }
+}
+
+} // namespace loadgen
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace loadgen {
+
+enum class Operation : std::uint8_t {
+    GET_BOOK,
+    LIST_BOOKS,
+    CREATE_BOOK,
+    UPDATE_BOOK,
+    GET_STATS,
+    COUNT
+};
+
+constexpr std::size_t kOperationCount = static_cast<std::size_t>(Operation::COUNT);
+
+const char* operationName(Operation op);
+
+// Смесь операций в процентах (весах), например "get=80,list=10,create=5,update=5,stats=0"
+class WorkloadMix {
+public:
+    // Бросает std::invalid_argument при ошибке в описании
+    static WorkloadMix parse(const std::string& spec);
+
+    Operation pick(std::mt19937_64& rng) const;
+    unsigned weight(Operation op) const { return weights_[static_cast<std::size_t>(op)]; }
+
+private:
+    std::array<unsigned, kOperationCount> weights_{};
+    unsigned total_ = 0;
+};
+
+// Готовый HTTP-запрос для операции
+struct RequestSpec {
+    const char* method;
+    std::string path;
+    std::string body;
+};
+
+class RequestFactory {
+public:
+    RequestFactory(int id_min, int id_max, unsigned worker);
+
+    RequestSpec make(Operation op, std::mt19937_64& rng);
+
+private:
+    int randomId(std::mt19937_64& rng) const;
+
+    int id_min_;
+    int id_max_;
+    unsigned worker_;
+    std::uint64_t sequence_ = 0;
+};
+
+} // namespace loadgen
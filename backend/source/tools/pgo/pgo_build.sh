@@ -0,0 +1,153 @@
+#!/usr/bin/env bash
+# Двухэтапная PGO-сборка bookshelf_api и замер выигрыша относительно обычной Release-сборки.
+#
+#   tools/pgo/pgo_build.sh [--storage memory|postgres] [--duration S] [--port P] [--out DIR]
+#
+# 1. build-release: Release + LTO без PGO - точка отсчета
+# 2. build-pgo:     инструментированная сборка (BOOKSHELF_PGO=generate)
+# 3. обучение:      сервер из build-pgo под смесью запросов bookshelf_loadgen
+# 4. build-pgo:     пересборка в той же директории с профилем (BOOKSHELF_PGO=use)
+# 5. замер:         bookshelf_bench и bookshelf_loadgen для обеих сборок; JSON-результаты
+#                   и сравнение (bench/compare.py) остаются в --out
+#
+# По умолчанию сервер работает с хранилищем в памяти и не требует PostgreSQL.
+# Для --storage postgres база из config.json должна существовать (bookshelf_api --init-db).
+set -euo pipefail
+
+SRC_DIR="$(cd "$(dirname "$0")/../.." && pwd)"
+STORAGE=memory
+DURATION=30
+PORT=18080
+OUT=pgo-out
+JOBS="$(nproc)"
+
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --storage) STORAGE="$2"; shift 2 ;;
+        --duration) DURATION="$2"; shift 2 ;;
+        --port) PORT="$2"; shift 2 ;;
+        --out) OUT="$2"; shift 2 ;;
+        -h|--help) sed -n '2,15p' "$0"; exit 0 ;;
+        *) echo "Unknown option: $1" >&2; exit 2 ;;
+    esac
+done
+
+mkdir -p "$OUT"
+OUT="$(cd "$OUT" && pwd)"
+BUILD_RELEASE="$OUT/build-release"
+BUILD_PGO="$OUT/build-pgo"
+PROFILE_DIR="$BUILD_PGO/pgo-profile"
+RUN_DIR="$OUT/run/work"
+SERVER_PID=""
+
+log() { echo "==> $*"; }
+
+build() {
+    local dir="$1"; shift
+    cmake -S "$SRC_DIR" -B "$dir" -DCMAKE_BUILD_TYPE=Release "$@"
+    cmake --build "$dir" -j"$JOBS"
+}
+
+# Сервер ищет config.json в родительской директории рабочей
+write_config() {
+    mkdir -p "$RUN_DIR"
+    python3 - "$SRC_DIR/config.json" "$OUT/run/config.json" "$STORAGE" "$PORT" <<'PY'
+import json, sys
+src, dst, storage, port = sys.argv[1:]
+with open(src) as f:
+    config = json.load(f)
+config["server_port"] = int(port)
+config.setdefault("storage", {})["backend"] = storage
+config.setdefault("logging", {})["level"] = "warn"
+config.setdefault("capture", {})["enabled"] = False
+with open(dst, "w") as f:
+    json.dump(config, f, indent=4)
+PY
+}
+
+start_server() {
+    (cd "$RUN_DIR" && exec "$1") &
+    SERVER_PID=$!
+    for _ in $(seq 100); do
+        if (exec 3<>"/dev/tcp/127.0.0.1/$PORT") 2>/dev/null; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    echo "Server did not start on port $PORT" >&2
+    exit 1
+}
+
+# SIGINT: Crow завершает run(), main возвращается и профиль сбрасывается на диск
+stop_server() {
+    if [[ -n "$SERVER_PID" ]]; then
+        kill -INT "$SERVER_PID" 2>/dev/null || true
+        wait "$SERVER_PID" 2>/dev/null || true
+        SERVER_PID=""
+    fi
+}
+trap stop_server EXIT
+
+# Наполнение базы и основная смесь запросов; $1 - директория сборки, остальное - опции loadgen
+run_workload() {
+    local loadgen="$1/bin/bookshelf_loadgen"; shift
+    "$loadgen" --port "$PORT" --connections 8 --warmup 0 --duration 3 --mix create=100 >/dev/null
+    "$loadgen" --port "$PORT" --connections 16 --warmup 2 --duration "$DURATION" \
+        --mix get=60,list=5,create=10,update=20,stats=5 --ids 1:1000 "$@"
+}
+
+write_config
+
+log "Stage 1: baseline Release build"
+build "$BUILD_RELEASE" -DBOOKSHELF_PGO=
+
+log "Stage 2: instrumented build"
+rm -rf "$PROFILE_DIR"
+build "$BUILD_PGO" -DBOOKSHELF_PGO=generate -DBOOKSHELF_PGO_DIR="$PROFILE_DIR"
+
+log "Stage 3: training run (${DURATION}s, storage: $STORAGE)"
+start_server "$BUILD_PGO/bin/bookshelf_api"
+run_workload "$BUILD_RELEASE" >/dev/null
+stop_server
+
+# Clang пишет .profraw, их нужно объединить; GCC читает .gcda напрямую
+if compgen -G "$PROFILE_DIR/*.profraw" >/dev/null; then
+    llvm-profdata merge -output="$PROFILE_DIR/bookshelf.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+log "Stage 4: optimized build with profile"
+build "$BUILD_PGO" -DBOOKSHELF_PGO=use -DBOOKSHELF_PGO_DIR="$PROFILE_DIR"
+
+log "Stage 5: measurements"
+for variant in release pgo; do
+    dir="$BUILD_RELEASE"
+    [[ "$variant" == pgo ]] && dir="$BUILD_PGO"
+
+    if [[ -x "$dir/bin/bookshelf_bench" ]]; then
+        "$dir/bin/bookshelf_bench" --benchmark_repetitions=5 --benchmark_report_aggregates_only=true \
+            --benchmark_out="$OUT/bench-$variant.json" --benchmark_out_format=json >/dev/null
+    fi
+
+    start_server "$dir/bin/bookshelf_api"
+    run_workload "$BUILD_RELEASE" --json "$OUT/loadgen-$variant.json" >/dev/null
+    stop_server
+done
+
+if [[ -f "$OUT/bench-release.json" && -f "$OUT/bench-pgo.json" ]]; then
+    python3 "$SRC_DIR/bench/compare.py" "$OUT/bench-release.json" "$OUT/bench-pgo.json" --threshold 0 \
+        | tee "$OUT/bench-compare.txt" || true
+fi
+
+python3 - "$OUT/loadgen-release.json" "$OUT/loadgen-pgo.json" <<'PY' | tee "$OUT/throughput.txt"
+import json, sys
+release, pgo = (json.load(open(path)) for path in sys.argv[1:])
+def line(name, run):
+    latency = run["latency"]
+    return f"{name:<8} {run['throughput_rps']:>10.1f} req/s  p50 {latency['p50_ms']:.3f} ms  p99 {latency['p99_ms']:.3f} ms"
+print(line("release", release))
+print(line("pgo", pgo))
+delta = (pgo["throughput_rps"] - release["throughput_rps"]) / release["throughput_rps"] * 100
+print(f"throughput delta: {delta:+.1f}%")
+PY
+
+log "Results in $OUT"
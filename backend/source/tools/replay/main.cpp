@@ -0,0 +1,427 @@
+// bookshelf_replay - воспроизведение записанного трафика и сравнение прогонов.
+//
+//   bookshelf_replay run capture.bin --port 8080 --connections 8 --speed 2 --record replay.bin
+//   bookshelf_replay compare capture.bin replay.bin --json diff.json
+//
+// run     - запросы уходят по исходному расписанию, сжатому в --speed раз (0 - без пауз,
+//           с максимальной скоростью), ответы сравниваются с записанными. --record сохраняет
+//           прогон в том же формате, чтобы потом сравнить его с другой сборкой через compare.
+// compare - сравнение двух файлов запись-к-записи: распределения времени обработки на
+//           сервере (по группам "метод + путь без id"), расхождения статусов и хэшей тел.
+//
+// Время обработки в прогоне берется из Server-Timing (total), как и в записи - на сервере,
+// без сети. Запросы на запись (POST/PUT/DELETE) меняют данные: при повторе на непустой базе
+// их ответы (id, временные метки) ожидаемо расходятся.
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture/capture_format.h"
+#include "metrics/histogram.h"
+#include "serializer/json_writer.h"
+#include "tools/loadgen/http_client.h"
+
+using capture::CaptureRecord;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    std::string command;
+    std::string input;
+    std::string other;                  // второй файл для compare
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 8080;
+    std::string unix_path;
+    unsigned connections = 8;
+    double speed = 1.0;
+    unsigned timeout_ms = 5000;
+    std::string record_path;
+    std::string json_path;
+};
+
+void printUsage(const char* name) {
+    std::cout << "Usage: " << name << " run CAPTURE [options]\n"
+              << "       " << name << " compare BASELINE CONTENDER [--json PATH]\n"
+              << "  --host H           server host (127.0.0.1)\n"
+              << "  --port P           server port (8080)\n"
+              << "  --unix PATH        connect over a Unix domain socket instead of TCP\n"
+              << "  --connections N    concurrent connections (8)\n"
+              << "  --speed X          replay X times faster than captured, 0 - no pacing (1)\n"
+              << "  --timeout-ms N     socket timeout (5000)\n"
+              << "  --record PATH      save the replayed run for a later compare\n"
+              << "  --json PATH        write JSON comparison ('-' for stdout)\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& opts) {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--host") opts.host = value();
+        else if (arg == "--port") opts.port = static_cast<std::uint16_t>(std::stoul(value()));
+        else if (arg == "--unix") opts.unix_path = value();
+        else if (arg == "--connections") opts.connections = static_cast<unsigned>(std::stoul(value()));
+        else if (arg == "--speed") opts.speed = std::stod(value());
+        else if (arg == "--timeout-ms") opts.timeout_ms = static_cast<unsigned>(std::stoul(value()));
+        else if (arg == "--record") opts.record_path = value();
+        else if (arg == "--json") opts.json_path = value();
+        else if (arg == "--help" || arg == "-h") { printUsage(argv[0]); return false; }
+        else if (!arg.empty() && arg[0] == '-') throw std::invalid_argument("Unknown option: " + arg);
+        else positional.push_back(arg);
+    }
+
+    if (positional.empty()) {
+        throw std::invalid_argument("Missing command");
+    }
+    opts.command = positional[0];
+    if (opts.command == "run" && positional.size() == 2) {
+        opts.input = positional[1];
+    } else if (opts.command == "compare" && positional.size() == 3) {
+        opts.input = positional[1];
+        opts.other = positional[2];
+    } else {
+        throw std::invalid_argument("Unexpected arguments for '" + opts.command + "'");
+    }
+    if (opts.connections == 0 || opts.speed < 0) {
+        throw std::invalid_argument("--connections must be positive and --speed non-negative");
+    }
+    return true;
+}
+
+std::vector<CaptureRecord> loadRecords(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in || !capture::readHeader(in)) {
+        throw std::runtime_error("Not a capture file: " + path);
+    }
+    std::vector<CaptureRecord> records;
+    CaptureRecord record;
+    while (capture::readRecord(in, record)) {
+        records.push_back(std::move(record));
+    }
+    // Фоновый поток сервера пишет пачками: порядок в файле близок, но не равен порядку прихода
+    std::stable_sort(records.begin(), records.end(), [](const CaptureRecord& a, const CaptureRecord& b) {
+        return a.offset_us < b.offset_us;
+    });
+    return records;
+}
+
+void saveRecords(const std::string& path, const std::vector<CaptureRecord>& records) {
+    std::ofstream out(path, std::ios::binary);
+    capture::writeHeader(out);
+    std::string buffer;
+    for (const auto& record : records) {
+        buffer.clear();
+        capture::encodeRecord(buffer, record);
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+}
+
+// Группа для отчета: метод и путь без query, числовые сегменты заменены на {id}
+std::string groupKey(const CaptureRecord& record) {
+    std::string path = record.target.substr(0, record.target.find('?'));
+    std::string key = record.method + " ";
+    std::size_t pos = 0;
+    while (pos < path.size()) {
+        std::size_t next = path.find('/', pos + 1);
+        if (next == std::string::npos) {
+            next = path.size();
+        }
+        const std::string segment = path.substr(pos, next - pos);   // с ведущим '/'
+        const bool numeric = segment.size() > 1 &&
+            std::all_of(segment.begin() + 1, segment.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+        key += numeric ? "/{id}" : segment;
+        pos = next;
+    }
+    return key;
+}
+
+std::uint64_t toNs(Clock::duration d) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+double toMs(std::uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+constexpr double kPercentiles[] = {50.0, 90.0, 99.0, 99.9};
+
+struct Side {
+    metrics::Histogram duration;    // время обработки на сервере, нс
+    std::uint64_t bytes = 0;
+};
+
+struct GroupDiff {
+    Side baseline;
+    Side contender;
+    std::uint64_t status_mismatches = 0;
+    std::uint64_t body_mismatches = 0;
+};
+
+void printHistogramLine(const char* label, const metrics::Histogram& hist) {
+    std::printf("  %-10s %9llu", label, static_cast<unsigned long long>(hist.count()));
+    for (double p : kPercentiles) {
+        std::printf(" %9.3f", toMs(hist.valueAtQuantile(p / 100.0)));
+    }
+    std::printf(" %9.3f\n", toMs(hist.valueAtQuantile(1.0)));
+}
+
+void writeHistogramJson(serializer::JsonWriter& writer, const metrics::Histogram& hist) {
+    writer.beginObject(0);
+    writer.key("count");
+    writer.integer(static_cast<std::int64_t>(hist.count()));
+    for (double p : kPercentiles) {
+        char key[32];
+        std::snprintf(key, sizeof(key), "p%g_ms", p);
+        writer.key(key);
+        writer.real(toMs(hist.valueAtQuantile(p / 100.0)));
+    }
+    writer.key("max_ms");
+    writer.real(toMs(hist.valueAtQuantile(1.0)));
+    writer.endObject();
+}
+
+// Сравнение запись-к-записи; возвращает число расхождений статусов
+std::uint64_t compareRuns(const std::vector<CaptureRecord>& baseline, const std::vector<CaptureRecord>& contender,
+                          const std::string& json_path) {
+    if (baseline.size() != contender.size()) {
+        std::printf("Warning: %zu vs %zu records, comparing the first %zu\n",
+                    baseline.size(), contender.size(), std::min(baseline.size(), contender.size()));
+    }
+    const std::size_t count = std::min(baseline.size(), contender.size());
+
+    std::map<std::string, GroupDiff> groups;
+    GroupDiff total;
+    std::uint64_t request_mismatches = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& a = baseline[i];
+        const auto& b = contender[i];
+        if (a.method != b.method || a.target != b.target) {
+            ++request_mismatches;
+            continue;
+        }
+        for (GroupDiff* diff : {&groups[groupKey(a)], &total}) {
+            diff->baseline.duration.record(std::uint64_t{a.duration_us} * 1000);
+            diff->contender.duration.record(std::uint64_t{b.duration_us} * 1000);
+            diff->baseline.bytes += a.response_bytes;
+            diff->contender.bytes += b.response_bytes;
+            if (a.status != b.status) {
+                ++diff->status_mismatches;
+            } else if (a.response_hash != b.response_hash) {
+                ++diff->body_mismatches;
+            }
+        }
+    }
+
+    std::printf("\nServer time, ms       %9s %9s %9s %9s %9s %9s\n", "count", "p50", "p90", "p99", "p99.9", "max");
+    printHistogramLine("baseline", total.baseline.duration);
+    printHistogramLine("contender", total.contender.duration);
+
+    std::printf("\n%-32s %7s %9s %9s %8s %9s %9s %8s %7s %7s\n", "group", "count",
+                "base p50", "new p50", "delta", "base p99", "new p99", "delta", "status", "body");
+    for (const auto& [key, diff] : groups) {
+        auto delta = [](const metrics::Histogram& a, const metrics::Histogram& b, double q) {
+            const double base = static_cast<double>(a.valueAtQuantile(q));
+            return base > 0 ? (static_cast<double>(b.valueAtQuantile(q)) - base) / base * 100.0 : 0.0;
+        };
+        std::printf("%-32s %7llu %9.3f %9.3f %+7.1f%% %9.3f %9.3f %+7.1f%% %7llu %7llu\n",
+                    key.c_str(), static_cast<unsigned long long>(diff.baseline.duration.count()),
+                    toMs(diff.baseline.duration.valueAtQuantile(0.5)),
+                    toMs(diff.contender.duration.valueAtQuantile(0.5)),
+                    delta(diff.baseline.duration, diff.contender.duration, 0.5),
+                    toMs(diff.baseline.duration.valueAtQuantile(0.99)),
+                    toMs(diff.contender.duration.valueAtQuantile(0.99)),
+                    delta(diff.baseline.duration, diff.contender.duration, 0.99),
+                    static_cast<unsigned long long>(diff.status_mismatches),
+                    static_cast<unsigned long long>(diff.body_mismatches));
+    }
+    std::printf("\nMismatches: status=%llu body=%llu request=%llu (of %zu)\n",
+                static_cast<unsigned long long>(total.status_mismatches),
+                static_cast<unsigned long long>(total.body_mismatches),
+                static_cast<unsigned long long>(request_mismatches), count);
+
+    if (!json_path.empty()) {
+        std::string out;
+        serializer::JsonWriter writer(out);
+        auto writeDiff = [&](const GroupDiff& diff) {
+            writer.beginObject(0);
+            writer.key("baseline");
+            writeHistogramJson(writer, diff.baseline.duration);
+            writer.key("contender");
+            writeHistogramJson(writer, diff.contender.duration);
+            writer.key("baseline_bytes");
+            writer.integer(static_cast<std::int64_t>(diff.baseline.bytes));
+            writer.key("contender_bytes");
+            writer.integer(static_cast<std::int64_t>(diff.contender.bytes));
+            writer.key("status_mismatches");
+            writer.integer(static_cast<std::int64_t>(diff.status_mismatches));
+            writer.key("body_mismatches");
+            writer.integer(static_cast<std::int64_t>(diff.body_mismatches));
+            writer.endObject();
+        };
+
+        writer.beginObject(0);
+        writer.key("records");
+        writer.integer(static_cast<std::int64_t>(count));
+        writer.key("request_mismatches");
+        writer.integer(static_cast<std::int64_t>(request_mismatches));
+        writer.key("total");
+        writeDiff(total);
+        writer.key("groups");
+        writer.beginObject(0);
+        for (const auto& [key, diff] : groups) {
+            writer.key(key);
+            writeDiff(diff);
+        }
+        writer.endObject();
+        writer.endObject();
+        out += '\n';
+
+        if (json_path == "-") {
+            std::fputs(out.c_str(), stdout);
+        } else {
+            std::ofstream file(json_path);
+            file << out;
+        }
+    }
+    return total.status_mismatches;
+}
+
+std::vector<CaptureRecord> replay(const Options& opts, const std::vector<CaptureRecord>& records,
+                                  metrics::Histogram& latency, std::uint64_t& errors) {
+    std::vector<CaptureRecord> results(records.size());
+    std::vector<metrics::Histogram> worker_latency(opts.connections);
+    std::vector<std::uint64_t> worker_errors(opts.connections, 0);
+    std::atomic<std::size_t> next{0};
+    const auto start = Clock::now();
+
+    auto worker = [&](unsigned index) {
+        loadgen::HttpClient client(opts.host, opts.port, true, std::chrono::milliseconds(opts.timeout_ms));
+        if (!opts.unix_path.empty()) {
+            client.setUnixSocket(opts.unix_path);
+        }
+        client.setHashBodies(true);
+        std::string headers;
+        for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < records.size();) {
+            const auto& source = records[i];
+            Clock::time_point intended = Clock::now();
+            if (opts.speed > 0) {
+                intended = start + std::chrono::microseconds(
+                    static_cast<std::int64_t>(static_cast<double>(source.offset_us) / opts.speed));
+                std::this_thread::sleep_until(intended);
+            }
+
+            headers.clear();
+            if (!source.accept.empty()) {
+                headers.append("Accept: ").append(source.accept).append("\r\n");
+            }
+            const auto sent = Clock::now();
+            const auto result = client.request(source.method, source.target, source.body, headers);
+            const auto done = Clock::now();
+
+            auto& replayed = results[i];
+            replayed.offset_us = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(sent - start).count());
+            replayed.status = static_cast<std::uint16_t>(result.status);
+            replayed.duration_us = result.server_ms >= 0
+                ? static_cast<std::uint32_t>(result.server_ms * 1000.0)
+                : static_cast<std::uint32_t>(toNs(done - sent) / 1000);
+            replayed.response_bytes = result.body_bytes;
+            replayed.response_hash = result.body_hash;
+            replayed.method = source.method;
+            replayed.target = source.target;
+            replayed.accept = source.accept;
+            replayed.body = source.body;
+
+            // Задержка от запланированного времени: отставание от расписания тоже учитывается
+            worker_latency[index].record(toNs(done - intended));
+            if (result.status == 0) {
+                ++worker_errors[index];
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(opts.connections);
+    for (unsigned i = 0; i < opts.connections; ++i) {
+        workers.emplace_back(worker, i);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    for (unsigned i = 0; i < opts.connections; ++i) {
+        latency.merge(worker_latency[i]);
+        errors += worker_errors[i];
+    }
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    try {
+        if (!parseOptions(argc, argv, opts)) {
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    try {
+        const auto baseline = loadRecords(opts.input);
+        if (opts.command == "compare") {
+            const auto contender = loadRecords(opts.other);
+            std::printf("Baseline: %s (%zu records), contender: %s (%zu records)\n",
+                        opts.input.c_str(), baseline.size(), opts.other.c_str(), contender.size());
+            compareRuns(baseline, contender, opts.json_path);
+            return 0;
+        }
+
+        char speed[32] = "unpaced";
+        if (opts.speed > 0) {
+            std::snprintf(speed, sizeof(speed), "%gx", opts.speed);
+        }
+        std::printf("Replaying %zu requests from %s, connections: %u, speed: %s\n",
+                    baseline.size(), opts.input.c_str(), opts.connections, speed);
+        metrics::Histogram latency;
+        std::uint64_t errors = 0;
+        const auto started = Clock::now();
+        const auto results = replay(opts, baseline, latency, errors);
+        const double elapsed_s = std::chrono::duration<double>(Clock::now() - started).count();
+
+        std::printf("Completed in %.1fs (%.1f req/s), connection errors: %llu\n", elapsed_s,
+                    elapsed_s > 0 ? static_cast<double>(results.size()) / elapsed_s : 0.0,
+                    static_cast<unsigned long long>(errors));
+        std::printf("\nClient latency, ms    %9s %9s %9s %9s %9s %9s\n", "count", "p50", "p90", "p99", "p99.9", "max");
+        printHistogramLine("replay", latency);
+
+        if (!opts.record_path.empty()) {
+            saveRecords(opts.record_path, results);
+        }
+        compareRuns(baseline, results, opts.json_path);
+        return errors > 0 ? 1 : 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+}